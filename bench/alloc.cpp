@@ -0,0 +1,155 @@
+/**
+ * Heap allocations made for every request, by the request parser alone and
+ * with the response built.
+ *
+ * usage: ./alloc_bench [requests]
+ *
+ * Replaces the global operator new to count allocations, then parses the same
+ * browser-like GET request many times the way a connection does: one Request
+ * per request, fed with what a single recv returned, and the path taken as
+ * the handler does to find its location. The second run also builds the
+ * Response of a GET of html/index.html and sends it through a Connection to a
+ * socketpair, the third does the same with the open file and response caches
+ * of a worker. Run it from the repository root.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <new>
+#include <sys/time.h>
+#include <sys/socket.h>
+
+#include "Parser.hpp"
+#include "Request.hpp"
+#include "Response.hpp"
+#include "Connection.hpp"
+
+namespace {
+	size_t	g_allocations = 0;
+	size_t	g_allocated_bytes = 0;
+
+	const char* const REQUEST =
+		"GET /images/logo.png?version=42 HTTP/1.1\r\n"
+		"Host: localhost:8080\r\n"
+		"User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/115.0\r\n"
+		"Accept: image/avif,image/webp,*/*\r\n"
+		"Accept-Language: en-US,en;q=0.5\r\n"
+		"Accept-Encoding: gzip, deflate, br\r\n"
+		"Connection: keep-alive\r\n"
+		"Referer: http://localhost:8080/index.html\r\n"
+		"Cookie: timestamp=12:00:00\r\n"
+		"Sec-Fetch-Dest: image\r\n"
+		"Sec-Fetch-Mode: no-cors\r\n"
+		"Sec-Fetch-Site: same-origin\r\n"
+		"\r\n";
+
+	double now_seconds() {
+		struct timeval tv;
+		gettimeofday(&tv, NULL);
+		return tv.tv_sec + tv.tv_usec / 1000000.0;
+	}
+}
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+	++g_allocations;
+	g_allocated_bytes += size;
+	void* ptr = std::malloc(size == 0 ? 1 : size);
+	if (ptr == NULL) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void* ptr) throw() {
+	std::free(ptr);
+}
+
+/**
+ * Run requests of raw and print the allocations made per request
+ */
+static bool measure(const char* name, long requests, const std::string& raw, const webserv::HostIndex& hosts,
+	const webserv::Listen& listen, bool respond, webserv::internal::OpenFileCache* open_file_cache = NULL,
+	webserv::internal::ResponseCache* response_cache = NULL) {
+	struct sockaddr_in client_address;
+	size_t output_size = 0;
+	int sockets[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == -1) {
+		return false;
+	}
+	webserv::Connection connection(client_address, listen);
+	char buffer[65536];
+
+	size_t allocations = g_allocations;
+	size_t allocated_bytes = g_allocated_bytes;
+	double start = now_seconds();
+
+	for (long i = 0; i < requests; ++i) {
+		webserv::Request request(client_address, listen);
+		request.feed(raw.data(), raw.size(), hosts);
+		if (!request.is_complete() || request.get_status_code() != 0) {
+			std::cerr << "request failed with status " << request.get_status_code() << std::endl;
+			return false;
+		}
+		if (!respond) {
+			output_size += request.get_path().size();
+			continue;
+		}
+		webserv::Response response(request, open_file_cache, response_cache);
+		response.process();
+		response.queue_to(connection);
+		while (connection.has_pending_output()) {
+			if (!connection.flush_output(sockets[0])) {
+				return false;
+			}
+			ssize_t size = recv(sockets[1], buffer, sizeof(buffer), 0);
+			output_size += size > 0 ? size : 0;
+		}
+	}
+
+	double elapsed = now_seconds() - start;
+	allocations = g_allocations - allocations;
+	allocated_bytes = g_allocated_bytes - allocated_bytes;
+	close(sockets[0]);
+	close(sockets[1]);
+
+	std::cout << name << std::endl;
+	std::cout << "  allocations per request: " << static_cast<double>(allocations) / requests << std::endl;
+	std::cout << "  bytes per request:       " << static_cast<double>(allocated_bytes) / requests << std::endl;
+	std::cout << "  ns per request:          " << elapsed * 1e9 / requests << std::endl;
+	return output_size > 0;
+}
+
+int main(int argc, char** argv) {
+	long requests = argc > 1 ? std::atol(argv[1]) : 100000;
+	if (requests <= 0) {
+		std::cerr << "usage: " << argv[0] << " [requests]" << std::endl;
+		return 1;
+	}
+
+	webserv::Parser parser;
+	std::vector<webserv::ServerConfig> server_configs = parser.parse(
+		"server {\n\tlisten 127.0.0.1:8080;\n\tserver_name localhost;\n\troot ./html;\n\tlocation / {\n\t}\n}\n");
+	webserv::Listen listen = *server_configs.front().get_listens().begin();
+	webserv::VirtualHosts virtual_hosts;
+	virtual_hosts.build(server_configs);
+	const webserv::HostIndex& hosts = *virtual_hosts.find(listen);
+
+	std::string raw(REQUEST);
+	std::string index_raw = raw;
+	index_raw.replace(index_raw.find("/images/logo.png?version=42"), 27, "/index.html");
+
+	webserv::internal::OpenFileCache open_file_cache(256, 60000, true);
+	webserv::internal::ResponseCache response_cache(1024 * 1024, 64 * 1024);
+	open_file_cache.set_now(1);
+
+	std::cout << "requests: " << requests << std::endl;
+	if (!measure("parse", requests, raw, hosts, listen, false)
+		|| !measure("parse and respond", requests, index_raw, hosts, listen, true)
+		|| !measure("parse and respond from the caches", requests, index_raw, hosts, listen, true,
+			&open_file_cache, &response_cache)) {
+		return 1;
+	}
+	return 0;
+}
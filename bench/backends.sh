@@ -0,0 +1,43 @@
+#!/bin/sh
+# Requests/sec of the epoll and io_uring builds of webserv side by side.
+#
+# usage: bench/backends.sh [connections] [seconds] [worker_threads]
+
+CONNECTIONS=${1:-1024}
+SECONDS_PER_RUN=${2:-5}
+WORKERS=${3:-1}
+PORT=8089
+BUILD_DIR=$(mktemp -d /tmp/webserv_backends_XXXXXX)
+CONFIG="$BUILD_DIR/bench.conf"
+
+trap 'rm -rf "$BUILD_DIR"' EXIT
+
+make re > /dev/null && cp webserv "$BUILD_DIR/webserv_epoll" || exit 1
+make re IO_URING=1 > /dev/null && cp webserv "$BUILD_DIR/webserv_io_uring" || exit 1
+make re > /dev/null || exit 1
+
+cat > "$CONFIG" <<CONF
+worker_threads $WORKERS;
+
+server {
+	listen 127.0.0.1:$PORT;
+	root ./html;
+	keepalive_requests 1000000;
+
+	location / {
+		allow_methods GET;
+	}
+}
+CONF
+
+for backend in epoll io_uring; do
+	"$BUILD_DIR/webserv_$backend" "$CONFIG" > /dev/null 2>&1 &
+	SERVER_PID=$!
+	sleep 0.5
+
+	printf "%-8s " "$backend"
+	./loadgen 127.0.0.1 $PORT /index.html "$CONNECTIONS" "$SECONDS_PER_RUN" "$WORKERS"
+
+	kill -INT $SERVER_PID
+	wait $SERVER_PID 2> /dev/null
+done
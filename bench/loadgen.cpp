@@ -0,0 +1,248 @@
+/**
+ * Minimal keep-alive HTTP/1.1 load generator used by the benchmark scripts.
+ *
+ * usage: ./loadgen <host> <port> <path> [connections] [seconds] [threads]
+ *
+ * Every connection sends one GET at a time and waits for the full response
+ * (Content-Length framed) before sending the next one. The connection is
+ * reopened when the server answers with "Connection: close".
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+	struct Options {
+		std::string	host;
+		int			port;
+		std::string	path;
+		int			connections;
+		int			seconds;
+		int			threads;
+	};
+
+	struct Client {
+		int			fd;
+		std::string	in;
+		size_t		sent;
+		bool		reading;
+	};
+
+	struct ThreadResult {
+		const Options*	options;
+		int				connections;
+		unsigned long	requests;
+		unsigned long	errors;
+		unsigned long	bytes;
+	};
+
+	double now() {
+		struct timeval tv;
+		gettimeofday(&tv, NULL);
+		return tv.tv_sec + tv.tv_usec / 1000000.0;
+	}
+
+	int open_connection(const Options& options) {
+		int fd = socket(AF_INET, SOCK_STREAM, 0);
+		if (fd == -1) {
+			return -1;
+		}
+
+		int _ = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &_, sizeof(_));
+
+		sockaddr_in addr;
+		std::memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(options.port);
+		inet_pton(AF_INET, options.host.c_str(), &addr.sin_addr);
+
+		if (connect(fd, (sockaddr*)&addr, sizeof(addr)) == -1) {
+			close(fd);
+			return -1;
+		}
+		fcntl(fd, F_SETFL, O_NONBLOCK);
+		return fd;
+	}
+
+	/**
+	 * Return the size of the first complete response in buffer, 0 if incomplete
+	 */
+	size_t response_size(const std::string& in, bool& close_after) {
+		size_t header_end = in.find("\r\n\r\n");
+		if (header_end == std::string::npos) {
+			return 0;
+		}
+
+		std::string header = in.substr(0, header_end);
+		close_after = header.find("Connection: close") != std::string::npos;
+
+		size_t length = 0;
+		size_t pos = header.find("Content-Length: ");
+		if (pos != std::string::npos) {
+			length = std::strtoul(header.c_str() + pos + 16, NULL, 10);
+		}
+
+		if (in.size() < header_end + 4 + length) {
+			return 0;
+		}
+		return header_end + 4 + length;
+	}
+
+	void* run_thread(void* arg) {
+		ThreadResult* result = static_cast<ThreadResult*>(arg);
+		const Options& options = *result->options;
+		std::string request = "GET " + options.path + " HTTP/1.1\r\nHost: " + options.host + "\r\n\r\n";
+
+		std::vector<Client> clients(result->connections);
+		std::vector<struct pollfd> pollfds(result->connections);
+		for (size_t i = 0; i < clients.size(); ++i) {
+			clients[i].fd = open_connection(options);
+			clients[i].sent = 0;
+			clients[i].reading = false;
+		}
+
+		double deadline = now() + options.seconds;
+		char buffer[65536];
+
+		while (now() < deadline) {
+			for (size_t i = 0; i < clients.size(); ++i) {
+				if (clients[i].fd == -1) {
+					clients[i].fd = open_connection(options);
+					if (clients[i].fd == -1) {
+						++result->errors;
+					}
+				}
+				pollfds[i].fd = clients[i].fd;
+				pollfds[i].events = clients[i].reading ? POLLIN : POLLOUT;
+				pollfds[i].revents = 0;
+			}
+
+			if (poll(&pollfds[0], pollfds.size(), 100) <= 0) {
+				continue;
+			}
+
+			for (size_t i = 0; i < clients.size(); ++i) {
+				Client& client = clients[i];
+				if (pollfds[i].revents == 0 || client.fd == -1) {
+					continue;
+				}
+
+				if (!client.reading) {
+					ssize_t ret = send(client.fd, request.c_str() + client.sent, request.size() - client.sent, MSG_NOSIGNAL);
+					if (ret <= 0) {
+						close(client.fd);
+						client.fd = -1;
+						client.sent = 0;
+						++result->errors;
+						continue;
+					}
+					client.sent += ret;
+					if (client.sent == request.size()) {
+						client.reading = true;
+						client.sent = 0;
+					}
+					continue;
+				}
+
+				ssize_t ret = recv(client.fd, buffer, sizeof(buffer), 0);
+				if (ret <= 0) {
+					close(client.fd);
+					client.fd = -1;
+					client.reading = false;
+					client.in.clear();
+					++result->errors;
+					continue;
+				}
+				client.in.append(buffer, ret);
+
+				bool close_after = false;
+				size_t size = response_size(client.in, close_after);
+				if (size == 0) {
+					continue;
+				}
+
+				++result->requests;
+				result->bytes += size;
+				client.in.erase(0, size);
+				client.reading = false;
+				if (close_after) {
+					close(client.fd);
+					client.fd = -1;
+				}
+			}
+		}
+
+		for (size_t i = 0; i < clients.size(); ++i) {
+			if (clients[i].fd != -1) {
+				close(clients[i].fd);
+			}
+		}
+		return NULL;
+	}
+} /* namespace */
+
+int main(int argc, char** argv) {
+	if (argc < 4) {
+		std::cerr << "usage: " << argv[0] << " <host> <port> <path> [connections] [seconds] [threads]\n";
+		return EXIT_FAILURE;
+	}
+
+	Options options;
+	options.host = argv[1];
+	options.port = std::atoi(argv[2]);
+	options.path = argv[3];
+	options.connections = argc > 4 ? std::atoi(argv[4]) : 64;
+	options.seconds = argc > 5 ? std::atoi(argv[5]) : 5;
+	options.threads = argc > 6 ? std::atoi(argv[6]) : 1;
+	if (options.connections < options.threads) {
+		options.connections = options.threads;
+	}
+
+	std::vector<ThreadResult> results(options.threads);
+	std::vector<pthread_t> threads(options.threads);
+	double start = now();
+
+	for (int i = 0; i < options.threads; ++i) {
+		results[i].options = &options;
+		results[i].connections = options.connections / options.threads + (i < options.connections % options.threads ? 1 : 0);
+		results[i].requests = 0;
+		results[i].errors = 0;
+		results[i].bytes = 0;
+		pthread_create(&threads[i], NULL, run_thread, &results[i]);
+	}
+
+	unsigned long requests = 0;
+	unsigned long errors = 0;
+	unsigned long bytes = 0;
+	for (int i = 0; i < options.threads; ++i) {
+		pthread_join(threads[i], NULL);
+		requests += results[i].requests;
+		errors += results[i].errors;
+		bytes += results[i].bytes;
+	}
+
+	double elapsed = now() - start;
+	std::cout << "requests: " << requests << ", errors: " << errors
+		<< ", requests/sec: " << static_cast<unsigned long>(requests / elapsed)
+		<< ", MB/sec: " << bytes / elapsed / (1024 * 1024) << "\n";
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+/**
+ * Location routing with thousands of prefix locations.
+ *
+ * usage: ./route_bench [locations] [lookups]
+ *
+ * Builds a server with the given number of prefix locations, then finds the
+ * location of the same mix of request paths with the radix trie router of
+ * ServerConfig and with the scan find_location used to do: one map lookup of
+ * path.substr(0, length) for every length of the path. Both must agree.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdlib>
+#include <new>
+#include <sys/time.h>
+
+#include "Parser.hpp"
+
+namespace {
+	size_t	g_allocations = 0;
+
+	double now_seconds() {
+		struct timeval tv;
+		gettimeofday(&tv, NULL);
+		return tv.tv_sec + tv.tv_usec / 1000000.0;
+	}
+
+	const webserv::LocationConfig* scan_location(const std::map<std::string, webserv::LocationConfig>& locations, const std::string& path) {
+		std::string directory = path;
+		if (directory.empty() || directory[directory.size() - 1] != '/') {
+			directory += "/";
+		}
+
+		for (size_t length = directory.size(); length > 0; --length) {
+			std::map<std::string, webserv::LocationConfig>::const_iterator it = locations.find(directory.substr(0, length));
+			if (it != locations.end()) {
+				return &it->second;
+			}
+		}
+		return NULL;
+	}
+}
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+	++g_allocations;
+	void* ptr = std::malloc(size == 0 ? 1 : size);
+	if (ptr == NULL) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void* ptr) throw() {
+	std::free(ptr);
+}
+
+/**
+ * Route every path lookups times in total and print the cost per lookup
+ */
+static std::vector<const webserv::LocationConfig*> measure(const char* name, const webserv::ServerConfig& server_config,
+	const std::vector<std::string>& paths, long lookups, bool scan) {
+	std::vector<const webserv::LocationConfig*> found(paths.size());
+	size_t allocations = g_allocations;
+	double start = now_seconds();
+
+	for (long i = 0; i < lookups; ++i) {
+		size_t index = i % paths.size();
+		found[index] = scan ? scan_location(server_config.get_locations(), paths[index]) : server_config.find_location(paths[index]);
+	}
+
+	double elapsed = now_seconds() - start;
+	allocations = g_allocations - allocations;
+
+	std::cout << name << std::endl;
+	std::cout << "  allocations per lookup: " << static_cast<double>(allocations) / lookups << std::endl;
+	std::cout << "  ns per lookup:          " << elapsed * 1e9 / lookups << std::endl;
+	return found;
+}
+
+int main(int argc, char** argv) {
+	long location_count = argc > 1 ? std::atol(argv[1]) : 5000;
+	long lookups = argc > 2 ? std::atol(argv[2]) : 1000000;
+	if (location_count <= 0 || lookups <= 0) {
+		std::cerr << "usage: " << argv[0] << " [locations] [lookups]" << std::endl;
+		return 1;
+	}
+
+	// /site<n>/section<m>/ locations, as many sites as needed with 10 sections each
+	std::string config = "server {\n\tlisten 127.0.0.1:8080;\n\tlocation / {\n\t}\n";
+	for (long i = 1; i < location_count; ++i) {
+		config += "\tlocation /site" + webserv::to_string(i / 10) + "/section" + webserv::to_string(i % 10) + "/ {\n\t}\n";
+	}
+	config += "}\n";
+
+	webserv::Parser parser;
+	std::vector<webserv::ServerConfig> server_configs = parser.parse(config);
+	const webserv::ServerConfig& server_config = server_configs.front();
+
+	std::vector<std::string> paths;
+	std::srand(42);
+	for (int i = 0; i < 1024; ++i) {
+		long site = std::rand() % (location_count / 10 + 1);
+		switch (i % 4) {
+			case 0:
+				paths.push_back("/site" + webserv::to_string(site) + "/section" + webserv::to_string(std::rand() % 10)
+					+ "/assets/images/photo" + webserv::to_string(i) + ".jpg");
+				break;
+			case 1:
+				paths.push_back("/site" + webserv::to_string(site) + "/section" + webserv::to_string(std::rand() % 10));
+				break;
+			case 2:
+				paths.push_back("/site" + webserv::to_string(site) + "/about.html");
+				break;
+			default:
+				paths.push_back("/index.html");
+				break;
+		}
+	}
+
+	std::cout << "locations: " << server_config.get_locations().size() << ", lookups: " << lookups << std::endl;
+	std::vector<const webserv::LocationConfig*> routed = measure("radix trie", server_config, paths, lookups, false);
+	std::vector<const webserv::LocationConfig*> scanned = measure("substr scan", server_config, paths, lookups, true);
+	if (routed != scanned) {
+		std::cerr << "radix trie and substr scan disagree" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,42 @@
+#!/bin/sh
+# Requests/sec of webserv for 1..N workers.
+#
+# usage: bench/scaling.sh [max_workers] [connections] [seconds] [worker_threads|worker_processes]
+
+MAX_WORKERS=${1:-$(getconf _NPROCESSORS_ONLN)}
+CONNECTIONS=${2:-256}
+SECONDS_PER_RUN=${3:-5}
+WORKER_MODEL=${4:-worker_threads}
+PORT=8088
+CONFIG=$(mktemp /tmp/webserv_bench_XXXXXX.conf)
+
+trap 'rm -f "$CONFIG"' EXIT
+
+workers=1
+while [ "$workers" -le "$MAX_WORKERS" ]; do
+	cat > "$CONFIG" <<CONF
+$WORKER_MODEL $workers;
+
+server {
+	listen 127.0.0.1:$PORT;
+	root ./html;
+	keepalive_requests 1000000;
+
+	location / {
+		allow_methods GET;
+	}
+}
+CONF
+
+	./webserv "$CONFIG" > /dev/null 2>&1 &
+	SERVER_PID=$!
+	sleep 0.5
+
+	printf "%s %-3s " "$WORKER_MODEL" "$workers"
+	./loadgen 127.0.0.1 $PORT /index.html "$CONNECTIONS" "$SECONDS_PER_RUN" "$workers"
+
+	kill -INT $SERVER_PID
+	wait $SERVER_PID 2> /dev/null
+
+	workers=$((workers * 2))
+done
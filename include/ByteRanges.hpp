@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+#ifndef BYTE_RANGES_MAX
+#define BYTE_RANGES_MAX 16 /* ranges served from one Range field, more are ignored */
+#endif
+
+namespace webserv {
+	/**
+	 * @brief The [start, end) bytes of a representation
+	 */
+	struct ByteRange {
+		off_t	start;
+		off_t	end;
+	};
+
+	/**
+	 * @brief What a Range field asks for, see parse_byte_ranges
+	 */
+	enum ByteRangesResult {
+		RANGES_IGNORED,
+		RANGES_SATISFIABLE,
+		RANGES_UNSATISFIABLE
+	};
+
+	ByteRangesResult parse_byte_ranges(const std::string& field, const off_t& size, std::vector<ByteRange>& ranges);
+
+	std::string format_content_range(const ByteRange& range, const off_t& size);
+
+	namespace internal {
+		/**
+		 * @brief Boundaries of multipart/byteranges responses, one per worker
+		 * @note Not shared between threads, the worker id keeps boundaries of
+		 * workers apart
+		 */
+		class BoundaryGenerator {
+		public:
+			explicit BoundaryGenerator(const unsigned long& worker_id = 0);
+			BoundaryGenerator(const BoundaryGenerator& copy);
+			BoundaryGenerator& operator=(const BoundaryGenerator& other);
+			~BoundaryGenerator();
+
+			std::string next();
+
+		private:
+			unsigned long	_worker_id;
+			unsigned long	_count;
+		};
+	} /* namespace internal */
+} /* namespace webserv */
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+#include "ServerConfig.hpp"
+#include "VirtualHosts.hpp"
+
+namespace webserv {
+	/**
+	 * @brief Parsed server configs frozen together with their host index
+	 * @note Never changes once created, so workers share it and requests point
+	 * into it instead of copying configs. Holders keep it alive through
+	 * ConfigRef, the last reference deletes it.
+	 */
+	class ConfigSnapshot {
+	public:
+		static ConfigSnapshot* create(const std::vector<ServerConfig>& server_configs);
+
+		void retain() const;
+		void release() const;
+
+		/* Getters */
+		const std::vector<ServerConfig>& get_server_configs() const;
+		const VirtualHosts& get_virtual_hosts() const;
+
+	private:
+		const std::vector<ServerConfig>	_server_configs;
+		VirtualHosts					_virtual_hosts;
+		mutable volatile long			_references;
+
+		ConfigSnapshot(const std::vector<ServerConfig>& server_configs);
+		~ConfigSnapshot();
+
+		ConfigSnapshot(const ConfigSnapshot& copy); /* disabled */
+		ConfigSnapshot& operator=(const ConfigSnapshot& other); /* disabled */
+	};
+
+	/**
+	 * @brief Counted reference to a ConfigSnapshot, copies share the snapshot
+	 */
+	class ConfigRef {
+	public:
+		ConfigRef();
+		explicit ConfigRef(const ConfigSnapshot* snapshot);
+		ConfigRef(const ConfigRef& copy);
+		ConfigRef& operator=(const ConfigRef& other);
+		~ConfigRef();
+
+		const ConfigSnapshot* operator->() const;
+		const ConfigSnapshot& operator*() const;
+		const ConfigSnapshot* get() const;
+
+	private:
+		const ConfigSnapshot*	_snapshot;
+	};
+
+} /* namespace webserv */
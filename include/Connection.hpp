@@ -0,0 +1,97 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+#include "Request.hpp"
+#include "ServerConfig.hpp"
+#include "TimerWheel.hpp"
+#include "SharedBuffer.hpp"
+#include "GzipStream.hpp"
+
+#ifndef SEND_FILE_BUFFER
+#define SEND_FILE_BUFFER 65536 /* bytes read per send without sendfile */
+#endif
+
+#ifndef SEND_IOVECS
+#define SEND_IOVECS 16 /* memory chunks gathered by one sendmsg */
+#endif
+
+namespace webserv {
+	/**
+	 * @brief Queued output, the [offset, end) range of data, of shared or of file_fd
+	 * @note The chunk owns file_fd, a copy dups it, unless it borrows the fd of
+	 * a later chunk, and holds a reference to shared. With gzip the file range
+	 * is sent compressed, in chunked frames.
+	 */
+	struct OutputChunk {
+		std::string			data;
+		const SharedBuffer*	shared;
+		int					file_fd;
+		bool				borrows_file;
+		GzipStream*			gzip;
+		off_t				offset;
+		off_t				end;
+
+		OutputChunk();
+		OutputChunk(const OutputChunk& copy);
+		OutputChunk& operator=(const OutputChunk& other);
+		~OutputChunk();
+	};
+
+	/**
+	 * @brief State of one client connection, outlives the requests served on it
+	 */
+	class Connection {
+	public:
+		Connection(struct sockaddr_in client_address, const Listen& server_listen);
+		Connection(const Connection& copy);
+		Connection& operator=(const Connection& other);
+		~Connection();
+
+		void finish_request();
+		int get_input_timeout(const bool& was_started) const;
+
+		void keep_pending_input(const char* data, const size_t& size);
+		void take_pending_input(std::string& input);
+		bool has_pending_input() const;
+
+		void queue_output(const std::string& data);
+		void queue_shared(const SharedBuffer* shared, size_t offset, size_t end);
+		void queue_file(int file_fd, off_t offset, off_t end);
+		void queue_file_part(int file_fd, off_t offset, off_t end);
+		void queue_compressed_file(int file_fd, off_t offset, off_t end, int level);
+		bool flush_output(const int& fd);
+		bool has_pending_output() const;
+
+		/* Getters */
+		Request& get_request();
+		const Request& get_request() const;
+		const size_t& get_request_count() const;
+		const int& get_keepalive_timeout() const;
+		internal::Timer& get_timer();
+
+	private:
+		Request				_request;
+		size_t				_request_count;
+		int					_keepalive_timeout;
+		internal::Timer		_timer;
+		std::string			_pending_input;
+
+		std::deque<OutputChunk>	_output_queue;
+
+		ssize_t send_memory(const int& fd);
+		ssize_t send_file(const int& fd, OutputChunk& chunk, bool more);
+		bool compress_file();
+	};
+} /* namespace webserv */
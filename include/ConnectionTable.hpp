@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <new>
+#include <sys/resource.h>
+
+#include "Connection.hpp"
+#include "ServerConfig.hpp"
+#include "VirtualHosts.hpp"
+
+#ifndef CONNECTION_TABLE_PAGE_SIZE
+#define CONNECTION_TABLE_PAGE_SIZE 64 /* entries allocated at once */
+#endif
+
+#ifndef CONNECTION_TABLE_MAX_FDS
+#define CONNECTION_TABLE_MAX_FDS 1048576 /* cap when RLIMIT_NOFILE is unlimited or huge */
+#endif
+
+namespace webserv {
+	enum EntryType {
+		ENTRY_FREE,
+		ENTRY_LISTENER,
+		ENTRY_CLIENT
+	};
+
+	/**
+	 * @brief Slot of one fd, its address is given to the poll as event data
+	 * @note The Connection of a client is built in place in the slot storage
+	 */
+	struct ConnectionEntry {
+		EntryType			type;
+		int					fd;
+		Listen				listen;
+		const HostIndex*	hosts;
+
+		Connection& get_connection();
+
+	private:
+		union {
+			char		bytes[sizeof(Connection)];
+			long double	align_long_double;
+			void*		align_pointer;
+			long		align_long;
+		} _storage;
+
+		friend class ConnectionTable;
+	};
+
+	/**
+	 * @brief Dense fd indexed table of listeners and client connections
+	 * @note Entries live in fixed size pages allocated on first use and never
+	 * moved, the page directory is sized from RLIMIT_NOFILE
+	 */
+	class ConnectionTable {
+	public:
+		ConnectionTable();
+		~ConnectionTable();
+
+		ConnectionEntry* get(const int& fd);
+		ConnectionEntry* add_listener(const int& fd, const Listen& listen);
+		ConnectionEntry* add_client(const int& fd, struct sockaddr_in client_address, const Listen& listen);
+		void remove(const int& fd);
+
+		/* Getters */
+		const size_t& get_capacity() const;
+
+	private:
+		std::vector<ConnectionEntry*>	_pages;
+		size_t							_capacity;
+
+		ConnectionEntry* get_or_create(const int& fd);
+
+		ConnectionTable(const ConnectionTable& copy); /* disabled */
+		ConnectionTable& operator=(const ConnectionTable& other); /* disabled */
+	};
+} /* namespace webserv */
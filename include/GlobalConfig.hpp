@@ -0,0 +1,59 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <set>
+#include <cstdlib>
+#include <unistd.h>
+
+#include "utils.hpp"
+#include "MimeTypes.hpp"
+
+namespace webserv {
+	/**
+	 * @brief Configuration outside of any server block, shared by all servers
+	 */
+	class GlobalConfig {
+	public:
+		GlobalConfig();
+		GlobalConfig(const GlobalConfig& copy);
+		GlobalConfig& operator=(const GlobalConfig& other);
+		~GlobalConfig();
+
+		static void register_types(std::set<std::string>& types);
+		bool set_config(const std::string& type, const std::string& value);
+		bool set_default();
+		bool set_types(const MimeTypes& types);
+
+		/* Getters */
+		const int& get_worker_threads() const;
+		const int& get_worker_processes() const;
+		const MimeTypes& get_types() const;
+		const int& get_open_file_cache() const;
+		const int& get_open_file_cache_valid() const;
+		const bool& get_open_file_cache_errors() const;
+		const long& get_response_cache() const;
+		const long& get_response_cache_max_file() const;
+
+	private:
+		int			_worker_threads;
+		int			_worker_processes;
+		MimeTypes	_types;
+		int			_open_file_cache;
+		int			_open_file_cache_valid;
+		bool		_open_file_cache_errors;
+		long		_response_cache;
+		long		_response_cache_max_file;
+
+		bool set_worker_count(int& count, const std::string& value);
+		bool set_open_file_cache(const std::string& value);
+		bool set_open_file_cache_valid(const std::string& value);
+		bool set_open_file_cache_errors(const std::string& value);
+		bool set_response_cache(const std::string& value);
+	};
+
+#ifdef PARSER_DEBUG
+	std::ostream& operator<<(std::ostream& os, const GlobalConfig& global_config);
+#endif
+
+} /* namespace webserv */
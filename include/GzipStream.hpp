@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <sys/types.h>
+#include <zlib.h>
+
+#ifndef GZIP_BUFFER
+#define GZIP_BUFFER 16384 /* bytes of compressed output produced at once */
+#endif
+
+namespace webserv {
+	/**
+	 * @brief gzip coding of a body fed piece by piece
+	 * @note The window and memory of deflate shrink for bodies known to be
+	 * small, like nginx does, a full one takes about 256k. A copy continues
+	 * from the same state.
+	 */
+	class GzipStream {
+	public:
+		GzipStream(int level, off_t size_hint);
+		GzipStream(const GzipStream& copy);
+		~GzipStream();
+
+		static bool compress_string(std::string& data, int level);
+
+		bool compress(const char* data, size_t size, bool finish, std::string& output);
+
+	private:
+		z_stream	_stream;
+		bool		_ready;
+
+		GzipStream& operator=(const GzipStream& other); /* disabled */
+	};
+
+} /* namespace webserv */
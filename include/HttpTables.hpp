@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <strings.h>
+
+#include "utils.hpp"
+
+namespace webserv {
+	/**
+	 * @brief Header fields the server looks at, other fields are HEADER_UNKNOWN
+	 */
+	enum HeaderId {
+		HEADER_UNKNOWN,
+		HEADER_HOST,
+		HEADER_RANGE,
+		HEADER_ACCEPT,
+		HEADER_COOKIE,
+		HEADER_EXPECT,
+		HEADER_REFERER,
+		HEADER_IF_RANGE,
+		HEADER_CONNECTION,
+		HEADER_USER_AGENT,
+		HEADER_CONTENT_TYPE,
+		HEADER_IF_NONE_MATCH,
+		HEADER_CONTENT_LENGTH,
+		HEADER_ACCEPT_ENCODING,
+		HEADER_IF_MODIFIED_SINCE,
+		HEADER_TRANSFER_ENCODING,
+		HEADER_COUNT
+	};
+
+	/**
+	 * @brief Status line of a status code, "HTTP/1.1 404 Not Found\r\n" in line
+	 */
+	struct StatusLine {
+		int			code;
+		const char*	line;
+		size_t		size;
+		const char*	reason;
+	};
+
+	int lookup_method(const char* method, size_t size);
+
+	HeaderId lookup_header(const char* name, size_t size);
+
+	const char* get_header_name(HeaderId id);
+
+	const StatusLine* find_status_line(int status_code);
+} /* namespace webserv */
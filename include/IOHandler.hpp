@@ -1,10 +1,15 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <unistd.h>
 #include <cerrno>
 #include <cstring>
 #include <stdexcept>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
 
 #include "utils.hpp"
 
@@ -16,24 +21,81 @@
 #include <sys/epoll.h>
 #endif
 
+#if defined(__linux__) && defined(WEBSERV_IO_URING)
+#include <stdint.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#ifndef READ_BUFFER
+#define READ_BUFFER 2048
+#endif
+
 namespace webserv {
 	namespace internal {
-		extern bool g_shutdown;
+		extern volatile sig_atomic_t g_shutdown;
+
+#if defined(__linux__) && defined(WEBSERV_IO_URING)
+		enum UringEventType {
+			URING_ACCEPT,
+			URING_READ,
+			URING_WRITE,
+			URING_EOF,
+			URING_ERROR
+		};
+
+		/**
+		 * @brief One completed event handed to Server, data points into a provided
+		 * buffer or into the stash buffer and stays valid until the next wait
+		 */
+		struct UringEvent {
+			int				fd;
+			void*			udata;
+			UringEventType	type;
+			int				res;
+			const char*		data;
+			size_t			size;
+		};
+
+		/**
+		 * @brief Per fd bookkeeping, generation invalidates completions of a closed fd
+		 * @note Data received while the fd waits for write is stashed and reported
+		 * again after set_read_ready, like epoll keeps it in the socket
+		 */
+		struct UringFdState {
+			unsigned		generation;
+			void*			udata;
+			bool			listener;
+			bool			reading;
+			bool			accept_armed;
+			bool			recv_armed;
+			bool			poll_armed;
+			std::string		stash;
+			bool			stash_eof;
+		};
+#endif
 
 		class IOHandler {
 		public:
 			IOHandler();
 			~IOHandler();
 
-			int wait_for_new_event();
-			int get_triggered_fd(const int& i);
+			void reset();
+			int wait_for_new_event(const int& timeout_ms);
+			void* get_triggered_data(const int& i);
 			bool is_error(const int& i);
 			bool is_eof(const int& i);
 			bool is_read_ready(const int& i);
 			bool is_write_ready(const int& i);
-			void add_fd(const int& fd);
+			int accept_client(const int& i, const int& socket_fd, struct sockaddr_in* client_address);
+			ssize_t receive(const int& i, const int& fd, char* buffer, const size_t& size);
+			void add_listen_fd(const int& fd, void* data, bool exclusive = false);
+			void add_fd(const int& fd, void* data);
 			void remove_fd(const int& fd);
-			void set_write_ready(const int& fd);
+			void set_write_ready(const int& fd, void* data);
+			void set_read_ready(const int& fd, void* data);
 
 			/* Getters */
 			const int& get_poll_fd() const;
@@ -42,8 +104,47 @@ namespace webserv {
 
 #ifdef __APPLE__
 			struct kevent		_event_list[100];
-#elif __linux__
+#elif __linux__ && !defined(WEBSERV_IO_URING)
 			struct epoll_event	_event_list[100];
+#elif __linux__
+			struct io_uring_params		_params;
+			char*						_ring;
+			size_t						_ring_size;
+			struct io_uring_sqe*		_sqes;
+			size_t						_sqes_size;
+			unsigned*					_sq_head;
+			unsigned*					_sq_tail;
+			unsigned*					_sq_mask;
+			unsigned*					_sq_array;
+			unsigned					_sq_local_tail;
+			unsigned					_sq_to_submit;
+			unsigned*					_cq_head;
+			unsigned*					_cq_tail;
+			unsigned*					_cq_mask;
+			struct io_uring_cqe*		_cqes;
+			struct io_uring_buf_ring*	_buf_ring;
+			size_t						_buf_ring_size;
+			char*						_buffers;
+			char*						_stash_buffer;
+			unsigned short				_buf_tail;
+			std::vector<unsigned short>	_used_buffers;
+			std::vector<UringEvent>		_events;
+			std::vector<UringFdState>	_fds;
+			std::vector<int>			_stashed_fds;
+
+			bool setup_ring();
+			void destroy_ring();
+			UringFdState& get_fd_state(const int& fd);
+			struct io_uring_sqe* get_sqe();
+			int enter(const unsigned& min_complete, const int& timeout_ms);
+			void arm_accept(const int& fd);
+			void arm_recv(const int& fd);
+			void arm_write_poll(const int& fd);
+			void cancel(const uint64_t& user_data);
+			void recycle_buffers();
+			void report_stashes();
+			void handle_completion(const struct io_uring_cqe& cqe);
+			void push_event(const int& fd, const UringEventType& type, const int& res, const char* data, const size_t& size);
 #endif
 
 			IOHandler(const IOHandler& copy); /* disabled */
@@ -5,8 +5,31 @@
 #include <set>
 
 #include "utils.hpp"
+#include "MimeTypes.hpp"
+#include "LocationPatterns.hpp"
 
 namespace webserv {
+	/**
+	 * @brief How a location matches paths, after its nginx modifier
+	 */
+	enum LocationMatch {
+		LOCATION_PREFIX,				/* location /uri/ */
+		LOCATION_PREFIX_NO_PATTERNS,	/* location ^~ /uri/, patterns skipped when longest */
+		LOCATION_EXACT,					/* location = /uri */
+		LOCATION_REGEX,					/* location ~ regex */
+		LOCATION_REGEX_CASELESS,		/* location ~* regex */
+		LOCATION_GLOB					/* location *.php, a uri with '*' or '?' */
+	};
+
+	static const char* const LocationModifierStrings[] = {
+		"",
+		"^~",
+		"=",
+		"~",
+		"~*",
+		""
+	};
+
 	class LocationConfig {
 	public:
 		LocationConfig();
@@ -17,29 +40,51 @@ namespace webserv {
 		static void register_types(std::set<std::string>& types);
 		bool set_config(const std::string& type, const std::string& value);
 		bool set_default();
+		bool set_types(const MimeTypes& types);
 
 		/* Getters */
 		const std::string& get_location() const;
+		const LocationMatch& get_match() const;
+		bool is_prefix() const;
+		bool is_pattern() const;
 		const std::string& get_root() const;
 		const std::string& get_index() const;
 		const std::set<std::string>& get_allow_methods() const;
 		const std::string& get_cgi_path() const;
 		const std::string& get_cgi_extension() const;
 		const bool& get_autoindex() const;
+		const bool& get_etag() const;
+		const bool& get_gzip_static() const;
+		const bool& get_brotli_static() const;
+		const bool& get_gzip() const;
+		const std::set<std::string>& get_gzip_types() const;
+		const int& get_gzip_min_length() const;
+		const int& get_gzip_comp_level() const;
 		const std::string& get_redirect() const;
+		const MimeTypes& get_types() const;
 
 	private:
 		std::string				_location;
+		LocationMatch			_match;
 		std::string				_root;
 		std::string				_index;
 		std::set<std::string>	_allow_methods;
 		std::string				_cgi_path;
 		std::string				_cgi_extension;
 		bool					_autoindex;
+		bool					_etag;
+		bool					_gzip_static;
+		bool					_brotli_static;
+		bool					_gzip;
+		std::set<std::string>	_gzip_types;
+		int						_gzip_min_length;
+		int						_gzip_comp_level;
 		std::string				_redirect;
+		MimeTypes				_types;
 
+		bool set_location(const std::string& value);
 		bool add_allow_methods(const std::string& method);
-		bool set_autoindex(const std::string& value);
+		bool set_flag(const std::string& value, bool& flag);
 	};
 
 #ifdef PARSER_DEBUG
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <bitset>
+#include <cstddef>
+
+#ifndef LOCATION_PATTERNS_STATE_LIMIT
+#define LOCATION_PATTERNS_STATE_LIMIT 4096 /* DFA states of the patterns of one server */
+#endif
+
+#ifndef LOCATION_PATTERNS_NODE_LIMIT
+#define LOCATION_PATTERNS_NODE_LIMIT 8192 /* NFA nodes of one pattern, bounds {m,n} copies */
+#endif
+
+namespace webserv {
+	enum PatternSyntax {
+		PATTERN_REGEX,
+		PATTERN_REGEX_CASELESS,
+		PATTERN_GLOB
+	};
+
+	/**
+	 * @brief Regex and glob patterns of locations compiled into a single DFA
+	 * @note Patterns are turned into one Thompson NFA, then into a DFA by subset
+	 * construction over byte classes once all are added. A match is one pass
+	 * over the path with a table lookup per byte, whatever the patterns are.
+	 * Regexes are a PCRE subset searched anywhere in the path: literals, ".",
+	 * classes, \d \w \s, groups, "|", "*", "+", "?", {m,n}, "^" and "$".
+	 * Globs match the whole path, "*" any run of bytes and "?" a single one.
+	 */
+	class LocationPatterns {
+	public:
+		LocationPatterns();
+		LocationPatterns(const LocationPatterns& copy);
+		LocationPatterns& operator=(const LocationPatterns& other);
+		~LocationPatterns();
+
+		static bool is_valid(const std::string& pattern, PatternSyntax syntax);
+		void add(const std::string& pattern, PatternSyntax syntax);
+		void compile();
+		void clear();
+		int match(const char* path, size_t size) const;
+
+		/* Getters */
+		size_t get_pattern_count() const;
+		size_t get_state_count() const;
+
+	private:
+		enum NodeType {
+			NODE_EMPTY,
+			NODE_BYTES,
+			NODE_SPLIT,
+			NODE_BEGIN,
+			NODE_END,
+			NODE_MATCH
+		};
+
+		struct Node {
+			NodeType	type;
+			int			next;
+			int			alt;
+		};
+
+		struct Fragment {
+			int	start;
+			int	end;
+		};
+
+		struct Cursor {
+			const std::string*	pattern;
+			size_t				pos;
+			bool				caseless;
+			size_t				first_node;
+		};
+
+		std::vector<Node>				_nodes;
+		std::vector<std::bitset<256> >	_sets;
+		std::vector<int>				_starts;
+		std::vector<int>				_byte_classes;
+		size_t							_class_count;
+		std::vector<int>				_transitions;
+		std::vector<int>				_accepts;
+		std::vector<int>				_end_accepts;
+
+		bool parse(const std::string& pattern, PatternSyntax syntax, Fragment& fragment);
+		bool parse_alternation(Cursor& cursor, Fragment& fragment);
+		bool parse_concatenation(Cursor& cursor, Fragment& fragment);
+		bool parse_repetition(Cursor& cursor, Fragment& fragment);
+		bool parse_atom(Cursor& cursor, Fragment& fragment);
+		bool parse_class(Cursor& cursor, std::bitset<256>& set);
+		bool parse_escape(Cursor& cursor, std::bitset<256>& set);
+		bool parse_count(Cursor& cursor, int& count);
+		bool parse_glob(Cursor& cursor, Fragment& fragment);
+
+		int add_node(NodeType type, int next, int alt);
+		Fragment bytes_fragment(std::bitset<256> set, bool caseless);
+		Fragment empty_fragment();
+		Fragment concatenate(Fragment first, Fragment second);
+		Fragment alternate(Fragment first, Fragment second);
+		Fragment repeat(Fragment fragment, bool optional, bool many);
+
+		void split_byte_classes();
+		void closure(std::vector<int>& seeds, bool at_start, std::vector<int>& state, std::vector<int>& marks, int mark) const;
+		int accept_of(const std::vector<int>& state) const;
+	};
+
+} /* namespace webserv */
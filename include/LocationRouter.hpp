@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "LocationPatterns.hpp"
+
+namespace webserv {
+	/**
+	 * @brief Locations of a server compiled for lookup, by location id
+	 * @note Prefix and exact locations share a radix trie walked once over the
+	 * path bytes, regex and glob locations share one LocationPatterns DFA.
+	 * A lookup allocates nothing. Like nginx an exact match wins, then the
+	 * longest prefix if it skips patterns, then the first pattern in
+	 * configuration order that matches, then the longest prefix.
+	 */
+	class LocationRouter {
+	public:
+		LocationRouter();
+		LocationRouter(const LocationRouter& copy);
+		LocationRouter& operator=(const LocationRouter& other);
+		~LocationRouter();
+
+		void add_prefix(const std::string& prefix, int id, bool skip_patterns);
+		void add_exact(const std::string& path, int id);
+		void add_pattern(const std::string& pattern, PatternSyntax syntax, int id);
+		void compile();
+		void clear();
+		int find(const char* path, size_t size) const;
+
+	private:
+		struct Node {
+			std::string			label;
+			int					prefix;
+			int					exact;
+			bool				skip_patterns;
+			std::vector<size_t>	children;
+		};
+
+		std::vector<Node>	_nodes;
+		LocationPatterns	_patterns;
+		std::vector<int>	_pattern_ids;
+
+		size_t insert(const std::string& key);
+		size_t find_child(size_t node, unsigned char byte) const;
+		void insert_child(size_t node, size_t child);
+		static Node new_node(const std::string& label);
+	};
+
+} /* namespace webserv */
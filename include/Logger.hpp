@@ -4,6 +4,7 @@
 #include <iostream>
 #include <sstream>
 #include <unistd.h>
+#include <pthread.h>
 
 #include "utils.hpp"
 
@@ -56,6 +57,7 @@ namespace webserv {
 
 		/**
 		 * @brief Class Logger is a singleton
+		 * @note Log calls are serialized so worker threads don't interleave lines
 		 */
 		class Logger {
 		public:
@@ -66,7 +68,8 @@ namespace webserv {
 			static void set_log_file(const std::string& path);
 
 		private:
-			std::ofstream _log_fs;
+			std::ofstream	_log_fs;
+			pthread_mutex_t	_mutex;
 
 			Logger();
 			~Logger();
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <set>
+#include <cstdlib>
+#include <pthread.h>
+#include <csignal>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "GlobalConfig.hpp"
+#include "ServerConfig.hpp"
+#include "ConfigSnapshot.hpp"
+#include "Server.hpp"
+
+namespace webserv {
+	/**
+	 * @brief Own the worker event loops and run them on threads or forked processes
+	 * @note Thread workers are full Servers with their own IOHandler, client table and
+	 * SO_REUSEPORT listen sockets, so the hot path shares no lock between workers.
+	 * Process workers all inherit the listen sockets of a single Server bound by the
+	 * master, the master only supervises them and respawns the ones that die.
+	 * All workers share one frozen ConfigSnapshot.
+	 */
+	class Master {
+	public:
+		Master(const GlobalConfig& global_config, const std::vector<ServerConfig>& server_configs);
+		~Master();
+
+		void init();
+		void run();
+
+	private:
+		GlobalConfig				_global_config;
+		ConfigRef					_config;
+		std::vector<Server*>		_workers;
+		std::set<pid_t>				_worker_pids;
+
+		void run_threads();
+		void run_processes();
+		void spawn_worker_process();
+		void reap_worker_processes(bool wait);
+
+		static void* run_worker_thread(void* worker);
+
+		Master(const Master& copy); /* disabled */
+		Master& operator=(const Master& other); /* disabled */
+	};
+} /* namespace webserv */
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace webserv {
+	/**
+	 * @brief Extension to MIME type table, built once and read on every response
+	 * @note The hash seed is searched when the table is built so that every
+	 * extension gets its own slot, a lookup is one hash and one compare
+	 */
+	class MimeTypes {
+	public:
+		MimeTypes();
+		MimeTypes(const MimeTypes& copy);
+		MimeTypes& operator=(const MimeTypes& other);
+		~MimeTypes();
+
+		bool add(const std::string& type, const std::string& extension);
+		void build();
+		const std::string* find(const char* extension, size_t size) const;
+		const std::string* find_for_path(const std::string& path) const;
+		bool empty() const;
+
+		static const MimeTypes& get_default();
+
+		/* Getters */
+		const std::vector<std::pair<std::string, std::string> >& get_entries() const;
+
+	private:
+		std::vector<std::pair<std::string, std::string> >	_entries;
+		std::vector<int>									_slots;
+		size_t												_mask;
+		unsigned											_seed;
+
+		size_t slot_of(const char* extension, size_t size) const;
+		bool try_seed(unsigned seed);
+	};
+
+#ifdef PARSER_DEBUG
+	std::ostream& operator<<(std::ostream& os, const MimeTypes& mime_types);
+#endif
+
+} /* namespace webserv */
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#ifndef MULTIPART_HEADER_LIMIT
+#define MULTIPART_HEADER_LIMIT 8192 /* bytes of header fields in one part */
+#endif
+
+#ifndef MULTIPART_BOUNDARY_LIMIT
+#define MULTIPART_BOUNDARY_LIMIT 70 /* RFC 2046 5.1.1 */
+#endif
+
+namespace webserv {
+	enum MultipartState {
+		MULTIPART_DATA,
+		MULTIPART_DELIMITER,
+		MULTIPART_HEADERS,
+		MULTIPART_DONE
+	};
+
+	/**
+	 * @brief multipart/form-data body parser that writes file parts to a directory as they arrive
+	 * @note Body bytes are fed in any split, only a tail that may start a
+	 * delimiter or an incomplete part header line is kept between feeds.
+	 * Delimiters are searched with Boyer-Moore-Horspool.
+	 */
+	class MultipartParser {
+	public:
+		MultipartParser();
+		MultipartParser(const MultipartParser& copy);
+		MultipartParser& operator=(const MultipartParser& other);
+		~MultipartParser();
+
+		bool start(const std::string& boundary, const std::string& directory);
+		bool feed(const char* data, size_t size);
+		bool finish();
+		void abort();
+		bool is_started() const;
+
+		/* Getters */
+		const int& get_status_code() const;
+		const std::vector<std::string>& get_file_names() const;
+
+	private:
+		MultipartState				_state;
+		std::string					_delimiter;
+		std::vector<size_t>			_skip;
+		std::string					_directory;
+		std::string					_pending;
+		size_t						_header_size;
+		std::string					_disposition;
+		std::string					_file_name;
+		int							_fd;
+		int							_status_code;
+		std::vector<std::string>	_file_names;
+
+		size_t process(const char* data, size_t size);
+		size_t find_delimiter(const char* data, size_t size) const;
+		bool parse_header_line(const char* line, size_t size);
+		bool open_part();
+		bool write_part(const char* data, size_t size);
+		void close_part();
+		bool fail(int status_code);
+	};
+
+} /* namespace webserv */
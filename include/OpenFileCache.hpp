@@ -0,0 +1,115 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstddef>
+#include <ctime>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifndef OPEN_FILE_CACHE_EVENT_BUFFER
+#define OPEN_FILE_CACHE_EVENT_BUFFER 4096 /* bytes of inotify events read at once */
+#endif
+
+#define OPEN_FILE_CACHE_MIN_BUCKETS 8
+
+namespace webserv {
+	namespace internal {
+		/**
+		 * @brief What opening a path found
+		 * @note fd is only open on regular files, a regular file that can't be
+		 * read keeps its metadata with fd -1
+		 */
+		struct OpenFileInfo {
+			int				error;		/* errno of the failed lookup, 0 if the path exists */
+			int				fd;
+			mode_t			mode;
+			off_t			size;
+			time_t			mtime;
+			ino_t			inode;
+			unsigned long	version;	/* changes with the cache entry, 0 if not cached */
+
+			OpenFileInfo();
+
+			bool is_file() const;
+			bool is_directory() const;
+		};
+
+		/**
+		 * @brief Bounded LRU of open fds and stat metadata by path, misses included
+		 * @note One per worker, a hit is a hash probe and a dup of the cached fd.
+		 * On Linux the directory of every cached path is watched with inotify and
+		 * the events are drained once per event loop wake up, before the first
+		 * lookup. Entries older than valid_ms are checked again with stat, which
+		 * is all other platforms get and covers renames above the watched
+		 * directory. A max_entries of 0 opens every path again.
+		 */
+		class OpenFileCache {
+		public:
+			OpenFileCache(size_t max_entries, unsigned long valid_ms, bool cache_errors);
+			~OpenFileCache();
+
+			static bool open_uncached(const std::string& path, OpenFileInfo& info);
+
+			bool open(const std::string& path, OpenFileInfo& info);
+			bool lookup(const std::string& path, OpenFileInfo& info);
+			void invalidate(const std::string& path);
+			void set_now(const unsigned long& now_ms);
+			void reset();
+			void clear();
+
+			/* Getters */
+			size_t get_size() const;
+
+		private:
+			struct Entry {
+				std::string		path;
+				size_t			name_offset;
+				bool			used;
+				int				next;	/* in the bucket, or in the free list */
+				int				older;
+				int				newer;
+				int				watch;
+				unsigned long	validated_ms;
+				OpenFileInfo	info;	/* the cache owns fd */
+			};
+
+			std::vector<Entry>			_entries;
+			std::vector<int>			_buckets;
+			size_t						_mask;
+			int							_free;
+			int							_newest;
+			int							_oldest;
+			size_t						_size;
+			size_t						_max_entries;
+			unsigned long				_valid_ms;
+			bool						_cache_errors;
+			unsigned long				_version;
+			unsigned long				_now_ms;
+			bool						_drained;
+			int							_notify_fd;
+			std::map<int, size_t>		_watches;
+
+			int acquire(const std::string& path, OpenFileInfo& info);
+			int find(const std::string& path, const size_t& bucket) const;
+			int insert(const std::string& path, const size_t& bucket, const OpenFileInfo& info);
+			void remove(int index);
+			void touch(int index);
+			void unlink_lru(int index);
+			bool revalidate(const Entry& entry) const;
+			bool share(const Entry& entry, OpenFileInfo& info) const;
+			size_t bucket_of(const std::string& path) const;
+			static bool is_path_error(const int& error);
+
+			void drain();
+			void remove_watched(const int& watch, const char* name);
+			int add_watch(const std::string& path, const size_t& name_offset);
+			void release_watch(const int& watch);
+			void close_notify();
+
+			OpenFileCache(const OpenFileCache& copy); /* disabled */
+			OpenFileCache& operator=(const OpenFileCache& other); /* disabled */
+		};
+	} /* namespace internal */
+} /* namespace webserv */
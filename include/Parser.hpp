@@ -9,8 +9,10 @@
 
 #include "utils.hpp"
 #include "Tokenizer.hpp"
+#include "GlobalConfig.hpp"
 #include "ServerConfig.hpp"
 #include "LocationConfig.hpp"
+#include "MimeTypes.hpp"
 
 namespace webserv {
 	class Parser {
@@ -20,11 +22,18 @@ namespace webserv {
 
 		std::vector<ServerConfig> parse(const std::string& str_to_parse);
 
+		/* Getters */
+		const GlobalConfig& get_global_config() const;
+
 	private:
+		void parse_global_config(const internal::Token& token_type);
+
 		ServerConfig parse_server_config();
 
 		LocationConfig parse_location_config();
 
+		MimeTypes parse_types();
+
 		internal::Token expect_operator(const std::string& name);
 
 		internal::Token expect_value();
@@ -36,6 +45,7 @@ namespace webserv {
 
 		std::string						_str;
 		std::vector<internal::Token>	_tokens;
+		GlobalConfig					_global_config;
 
 		std::map<std::string, std::set<std::string> >	_scopes_and_types;
 
@@ -4,35 +4,118 @@
 #include <iostream>
 #include <map>
 #include <vector>
+#include <limits>
 #include <netinet/in.h>
 #include <cstdlib>
+#include <cctype>
+#include <cstring>
+#include <strings.h>
+#include <unistd.h>
 
 #include "utils.hpp"
+#include "Scanner.hpp"
+#include "HttpTables.hpp"
+#include "MultipartParser.hpp"
 #include "ServerConfig.hpp"
+#include "VirtualHosts.hpp"
+
+#ifndef REQUEST_HEADER_BUFFER
+#define REQUEST_HEADER_BUFFER 1024 /* header bytes reserved up front, like nginx client_header_buffer_size */
+#endif
+
+#ifndef REQUEST_HEADER_FIELDS
+#define REQUEST_HEADER_FIELDS 16 /* header fields reserved up front */
+#endif
 
 namespace webserv {
+	enum ParseState {
+		PARSE_REQUEST_LINE,
+		PARSE_HEADERS,
+		PARSE_BODY,
+		PARSE_DONE
+	};
+
+	/**
+	 * @brief Position inside a chunked body, "1a;ext\r\n<data>\r\n ... 0\r\n<trailers>\r\n"
+	 */
+	enum ChunkState {
+		CHUNK_SIZE,
+		CHUNK_EXTENSION,
+		CHUNK_DATA,
+		CHUNK_DATA_END,
+		CHUNK_TRAILER
+	};
+
+	/**
+	 * @brief Bytes [offset, offset + length) of the request header buffer
+	 * @note Offsets stay valid when the buffer grows, pointers wouldn't
+	 */
+	struct BufferView {
+		size_t	offset;
+		size_t	length;
+	};
+
+	/**
+	 * @brief Header field as received, name keeps the case sent by the client
+	 */
+	struct HeaderField {
+		HeaderId	id;
+		BufferView	name;
+		BufferView	value;
+	};
+
 	class Request {
 		private:
 			int									_status_code;
 			struct sockaddr_in					_client;
-			std::string							_raw;
+			ParseState							_parse_state;
+			bool								_started;
 			std::string							_raw_header;
+			size_t								_line_start;
+			size_t								_header_line_limit;
+			size_t								_header_size_limit;
 			std::string							_raw_body;
 			int									_method;
-			std::string							_path;
-			std::string							_query;
-			std::map<std::string, std::string>	_headers;
+			BufferView							_path;
+			BufferView							_query;
+			std::vector<HeaderField>			_headers;
 			size_t								_bytes_to_read;
-			std::vector<std::string>			_file_names;
+			size_t								_body_size;
+			int									_body_fd;
+			bool								_chunked;
+			ChunkState							_chunk_state;
+			size_t								_chunk_size;
+			size_t								_chunk_line_length;
+			size_t							_trailer_size;
+			MultipartParser						_multipart;
 			Listen								_server_listen;
 			std::string							_server_name;
-			ServerConfig						_server_config;
+			const ServerConfig*					_server_config;
+			bool								_keep_alive;
 
-			bool	parse_method(std::string const &first_line);
-			bool	parse_path(std::string const &first_line);
-			bool	parse_header();
-			bool	set_server_config(std::vector<ServerConfig> const &server_configs);
+			void	set_header_limits(HostIndex const &hosts);
+			bool	parse_line(BufferView const &line, HostIndex const &hosts);
+			bool	parse_method(BufferView const &first_line);
+			bool	parse_path(BufferView const &first_line);
+			bool	parse_header_field(BufferView const &line);
+			bool	finish_header(HostIndex const &hosts);
+			bool	set_server_config(HostIndex const &hosts);
+			bool	start_upload();
 			bool 	parse_body();
+			void	parse_connection();
+			size_t	consume_body(const char *raw, size_t size);
+			size_t	consume_chunked(const char *raw, size_t size);
+			bool	append_body(const char *data, size_t size);
+			bool	spool_body();
+			size_t	max_body_size() const;
+
+			const char			*view_data(BufferView const &view) const;
+			std::string			view_to_string(BufferView const &view) const;
+			bool				view_contains(BufferView const &view, const char *str) const;
+			const HeaderField	*find_header(HeaderId id, const HeaderField *after = NULL) const;
+			const HeaderField	*find_header(const char *name, const HeaderField *after = NULL) const;
+
+			static std::string	canonical_header_name(std::string const &name);
 
 		public:
 			Request(struct sockaddr_in client_address, Listen const &server_listen);
@@ -40,23 +123,33 @@ namespace webserv {
 			Request& operator=(Request const &other);
 			~Request();
 
-			void										init(const char *raw, size_t size, std::vector<ServerConfig> const &server_config);
-			bool										append_body(const char *raw, size_t size);
+			size_t										feed(const char *raw, size_t size, HostIndex const &hosts);
+			bool										is_complete() const;
+			bool										has_started() const;
 			bool										has_files() const;
-			bool										write_files(std::string const &path);
+			void										set_keep_alive(bool keep_alive);
+			bool										has_header(HeaderId id) const;
+			bool										has_header(const char *name) const;
+			std::string									get_header(HeaderId id) const;
+			std::string									get_header(const char *name) const;
 
 			int const									&get_status_code() const;
 			struct sockaddr_in const					&get_client() const;
+			ParseState const							&get_parse_state() const;
 			int	const 									&get_method() const;
-			std::string const							&get_path() const;
-			std::string const							&get_query() const;
-			std::map<std::string, std::string> const	&get_headers() const;
+			std::string									get_path() const;
+			std::string									get_query() const;
+			std::map<std::string, std::string>			get_headers() const;
 			std::string const							&get_body() const;
 			size_t const								&get_bytes_to_read() const;
+			size_t const								&get_body_size() const;
+			int const									&get_body_fd() const;
+			bool const									&is_chunked() const;
 			std::vector<std::string> const				&get_file_names() const;
 			Listen const								&get_server_listen() const;
 			std::string const							&get_server_name() const;
 			ServerConfig const							&get_server_config() const;
+			bool const									&is_keep_alive() const;
 	};
 } /* namespace webserv */
 
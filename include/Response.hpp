@@ -1,29 +1,43 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <map>
 #include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
 
 #pragma once
 
 #include "utils.hpp"
 #include "ServerConfig.hpp"
 #include "Request.hpp"
+#include "HttpTables.hpp"
+#include "MimeTypes.hpp"
+#include "OpenFileCache.hpp"
+#include "ResponseCache.hpp"
+#include "Connection.hpp"
+#include "ByteRanges.hpp"
 
 namespace webserv {
 	class Response {
 	public:
-		Response(Request& request);
+		Response(Request& request, internal::OpenFileCache* open_file_cache = NULL,
+			internal::ResponseCache* response_cache = NULL, internal::BoundaryGenerator* boundaries = NULL);
 		~Response();
 
 		void process();
+		void queue_to(Connection& connection);
 		const std::string& get_raw_data() const;
+		int take_file_fd();
+		const off_t& get_file_size() const;
 
 	private:
 		Request&							_request;
 		int									_status_code;
 		std::string							_server_name;
-		ServerConfig						_server_config;
+		const ServerConfig&					_server_config;
 		bool								_autoindex;
 		bool								_is_custom_error_page;
 		bool								_cgi_error;
@@ -32,10 +46,23 @@ namespace webserv {
 		std::string							_target;
 		std::string							_root;
 		std::string							_cgi_path;
-		LocationConfig						_location_config;
+		const LocationConfig*				_location_config;
 		std::map<std::string, std::string>	_cgi_env;
 		std::string							_redirect;
 		std::map<std::string, std::string>	_cgi_headers;
+		int									_file_fd;
+		off_t								_file_size;
+		time_t								_file_mtime;
+		std::vector<ByteRange>				_ranges;
+		std::vector<std::string>			_range_heads;
+		std::string							_content_range;
+		std::string							_boundary;
+		std::string							_content_encoding;
+		bool								_compress_file;
+		internal::OpenFileCache*			_open_file_cache;
+		internal::ResponseCache*			_response_cache;
+		internal::BoundaryGenerator*		_boundaries;
+		internal::CachedResponse			_cached;
 
 		bool set_server_config();
 		bool set_location_config();
@@ -44,12 +71,36 @@ namespace webserv {
 		void process_get();
 		void process_post();
 		void process_delete();
+		bool open_path(const std::string& path, internal::OpenFileInfo& info);
+		bool stat_path(const std::string& path, internal::OpenFileInfo& info);
+		std::string find_precompressed(const std::string& path);
+		bool has_static_encodings() const;
+		bool varies_on_encoding() const;
+		bool should_compress(const std::string& mime_type, const off_t& length) const;
+		bool compress_body(const std::string& mime_type);
+		std::string get_cgi_mime_type() const;
+		bool open_file(const std::string& path);
+		bool use_cached_response(const std::string& path);
+		bool read_file(const std::string& path, const internal::OpenFileInfo& file, std::string& body);
+		bool is_cacheable_request() const;
+		bool is_not_modified() const;
+		bool set_ranges();
+		bool is_if_range_current() const;
+		off_t get_content_length() const;
 		void set_response();
 		void set_error_response();
 		void setup_cgi_env();
 		void set_autoindex_body();
 		void set_redirect_response();
+		void set_not_modified_response();
 		void get_cookies();
+		bool wants_cookie() const;
+		void set_connection_header();
+		void set_status_line();
+		void append_mime_type(const std::string& path);
+		std::string get_validator_fields(const time_t& mtime, const off_t& size, bool weak) const;
+		std::string get_encoding_fields(const std::string& coding) const;
+		const std::string& get_mime_type(const std::string& path) const;
 
 		Response(const Response& copy); /* disabled */
 		Response& operator=(const Response&other); /* disabled */
@@ -58,4 +109,4 @@ namespace webserv {
 } /* namespace webserv */
 
 std::string run_cgi_script(std::map<std::string, std::string> envp_map,
-	std::string request_body);
+	std::string const &request_body, int body_fd);
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <ctime>
+
+#include "ServerConfig.hpp"
+#include "Connection.hpp"
+#include "SharedBuffer.hpp"
+
+namespace webserv {
+	namespace internal {
+		/**
+		 * @brief A prebuilt response, slices of one shared buffer
+		 * @note The buffer holds the status line, the head from Server to
+		 * Content-Type for a keep-alive then for a closing connection, then the
+		 * empty line and the body. Date and Set-Cookie come from the clock of
+		 * the cache when it is queued.
+		 */
+		struct CachedResponse {
+			const SharedBuffer*	buffer;
+			size_t				status_end;
+			size_t				keep_alive_end;
+			size_t				close_end;
+		};
+
+		/**
+		 * @brief Complete responses of small files by path, within a byte budget
+		 * @note One per worker. An entry is only valid for the open file cache
+		 * version of its file, which changes when the file does. Eviction is
+		 * CLOCK: a hit sets the referenced bit and the hand clears it once
+		 * before evicting. A hit is queued as slices of shared buffers, which
+		 * the connection sends with one sendmsg.
+		 */
+		class ResponseCache {
+		public:
+			ResponseCache(size_t budget, size_t max_body);
+			~ResponseCache();
+
+			const CachedResponse* find(const std::string& path, const int& status, const ServerConfig* server_config,
+				const LocationConfig* location_config, const unsigned long& version);
+			const CachedResponse* insert(const std::string& path, const int& status, const ServerConfig* server_config,
+				const LocationConfig* location_config, const unsigned long& version, const std::string& status_line,
+				const std::string& keep_alive_head, const std::string& close_head, const std::string& body);
+			void queue(Connection& connection, const CachedResponse& cached, bool keep_alive, bool cookie);
+			void clear();
+
+			/* Getters */
+			const size_t& get_size() const;
+			const size_t& get_max_body() const;
+
+		private:
+			struct Entry {
+				std::string				path;
+				int						status;
+				const ServerConfig*		server_config;
+				const LocationConfig*	location_config;
+				unsigned long			version;
+				bool					used;
+				bool					referenced;
+				int						next;	/* in the bucket, or in the free list */
+				size_t					cost;
+				CachedResponse			response;
+			};
+
+			std::vector<Entry>	_entries;
+			std::vector<int>	_buckets;
+			size_t				_mask;
+			int					_free;
+			size_t				_hand;
+			size_t				_budget;
+			size_t				_max_body;
+			size_t				_size;
+			const SharedBuffer*	_clock;
+			size_t				_date_end;
+			time_t				_clock_time;
+
+			bool make_room(const size_t& cost);
+			void remove(int index);
+			void update_clock();
+			size_t bucket_of(const std::string& path) const;
+
+			ResponseCache(const ResponseCache& copy); /* disabled */
+			ResponseCache& operator=(const ResponseCache& other); /* disabled */
+		};
+	} /* namespace internal */
+} /* namespace webserv */
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(WEBSERV_NO_SIMD)
+#define WEBSERV_SCAN_X86
+#endif
+
+namespace webserv {
+	namespace internal {
+		enum ScanLevel {
+			SCAN_SCALAR,
+			SCAN_SSE2,
+			SCAN_AVX2
+		};
+
+		/**
+		 * @brief Byte scanning kernels of the request and multipart parsers
+		 * @note Kernels are picked once for the running CPU, AVX2 then SSE2 then
+		 * scalar. Build with -D WEBSERV_NO_SIMD to keep only the scalar ones.
+		 */
+		const char* scan_line(const char* data, size_t size, bool& has_ctl);
+		const char* scan_token(const char* data, size_t size);
+		const char* scan_bytes(const char* data, size_t size, const char* pattern, size_t pattern_size);
+
+		size_t find_bytes(const std::string& str, const char* pattern, size_t pattern_size, size_t pos = 0);
+
+		bool is_token_char(unsigned char c);
+
+		ScanLevel get_scan_level();
+		bool set_scan_level(ScanLevel level);
+	} /* namespace internal */
+} /* namespace webserv */
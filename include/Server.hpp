@@ -1,51 +1,74 @@
 #pragma once
 
 #include <vector>
+#include <fcntl.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <cerrno>
 #include <cstring>
 #include <stdexcept>
+#include <csignal>
 
 #include "ServerConfig.hpp"
 #include "IOHandler.hpp"
 #include "Request.hpp"
+#include "Connection.hpp"
+#include "ConnectionTable.hpp"
 #include "Response.hpp"
+#include "TimerWheel.hpp"
+#include "ConfigSnapshot.hpp"
+#include "GlobalConfig.hpp"
+#include "OpenFileCache.hpp"
+#include "ResponseCache.hpp"
 
-#ifndef READ_BUFFER
-#define READ_BUFFER 2048
+#ifndef SHUTDOWN_CHECK_INTERVAL
+#define SHUTDOWN_CHECK_INTERVAL 1000 /* longest wait so worker threads notice g_shutdown */
 #endif
 
 namespace webserv {
 	namespace internal {
-		extern bool g_shutdown;
+		/* Non zero once shutdown is requested, holds the signal number that requested it */
+		extern volatile sig_atomic_t g_shutdown;
 	} /* namespace internal */
 
 	class Server {
 	public:
-		Server(const std::vector<ServerConfig>& server_configs);
+		Server(const ConfigRef& config, const GlobalConfig& global_config, bool reuse_port = false,
+			unsigned long worker_id = 0);
 		~Server();
 
 		void init();
+		void init_forked_worker();
 		void run();
 	private:
-		std::vector<ServerConfig>	_server_configs;
+		ConfigRef					_config;
 		internal::IOHandler			_iohandler;
 		std::set<Listen>			_listens;
 		std::map<int, Listen>		_socket_fds;
-		std::map<int, Request>		_clients;
+		ConnectionTable				_connections;
+		bool						_reuse_port;
+		internal::TimerWheel		_timers;
+		unsigned long				_now_ms;
+		internal::OpenFileCache		_open_file_cache;
+		internal::ResponseCache		_response_cache;
+		internal::BoundaryGenerator	_boundaries;
 
 		std::map<int, Listen>::iterator	socket_it;
 
 		static int create_socket();
-		static void bind_socket(const int& socket_fd, const std::string& host, const int& port);
+		static void bind_socket(const int& socket_fd, const std::string& host, const int& port, const bool& reuse_port);
+		static bool set_non_blocking(const int& fd);
 
-		void remove_client(const int& client_fd);
-		void handle_fail_event(const int& triggered_fd);
-		void handle_accept_client(const int& socket_fd);
-		void handle_read_event(const int& client_fd);
-		void handle_write_event(const int& client_fd);
+		void remove_client(ConnectionEntry& entry);
+		void remove_timed_out_clients();
+		void set_timeout(ConnectionEntry& entry, const int& timeout);
+		void handle_fail_event(ConnectionEntry& entry);
+		void handle_accept_client(const int& i, ConnectionEntry& listener);
+		void handle_read_event(const int& i, ConnectionEntry& entry);
+		void handle_write_event(ConnectionEntry& entry);
+		void handle_input(ConnectionEntry& entry, const char* data, const size_t& size);
+		void process_request(ConnectionEntry& entry);
 
 		ServerConfig get_server_config(Request const &req) const;
 
@@ -4,9 +4,12 @@
 #include <string>
 #include <set>
 #include <map>
+#include <vector>
 #include <cstdlib>
 
 #include "LocationConfig.hpp"
+#include "LocationRouter.hpp"
+#include "MimeTypes.hpp"
 
 namespace webserv {
 	struct Listen {
@@ -28,6 +31,8 @@ namespace webserv {
 		bool set_config(const std::string& type, const std::string& value);
 		bool set_default();
 		bool add_location(LocationConfig location_config);
+		bool set_types(const MimeTypes& types);
+		const LocationConfig* find_location(const std::string& path) const;
 
 		/* Getters */
 		const std::set<std::string>& get_server_names() const;
@@ -38,6 +43,16 @@ namespace webserv {
 		const std::map<std::string, LocationConfig>& get_locations() const;
 		const int& get_client_max_body_size() const;
 		const std::map<std::string, std::string>& get_error_pages() const;
+		const int& get_keepalive_timeout() const;
+		const int& get_keepalive_requests() const;
+		const int& get_client_header_timeout() const;
+		const int& get_client_body_timeout() const;
+		const int& get_send_timeout() const;
+		const int& get_large_header_buffers_number() const;
+		const int& get_large_header_buffers_size() const;
+		const int& get_client_body_buffer_size() const;
+		const std::string& get_client_body_temp_path() const;
+		const MimeTypes& get_types() const;
 
 	private:
 		std::set<std::string>					_server_names;
@@ -46,12 +61,28 @@ namespace webserv {
 		std::string								_index;
 		std::set<std::string>					_allow_methods;
 		std::map<std::string, LocationConfig>	_locations;
+		std::vector<std::string>				_pattern_locations;
+		LocationRouter							_location_router;
+		std::vector<const LocationConfig*>		_routes;
 		int										_client_max_body_size;
 		std::map<std::string, std::string>		_error_pages;
+		int										_keepalive_timeout;
+		int										_keepalive_requests;
+		int										_client_header_timeout;
+		int										_client_body_timeout;
+		int										_send_timeout;
+		int										_large_header_buffers_number;
+		int										_large_header_buffers_size;
+		int										_client_body_buffer_size;
+		std::string								_client_body_temp_path;
+		MimeTypes								_types;
 
 		bool add_allow_methods(const std::string& method);
 		bool add_listen(const std::string& value);
 		bool add_error_page(const std::string& value);
+		bool add_large_header_buffers(const std::string& value);
+		void route_locations();
+		void list_routes();
 	};
 
 #ifdef PARSER_DEBUG
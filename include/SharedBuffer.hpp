@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+
+namespace webserv {
+	/**
+	 * @brief Immutable bytes shared by the responses queued from them
+	 * @note Buffers stay within one worker, so the count isn't atomic. The
+	 * last release deletes it.
+	 */
+	class SharedBuffer {
+	public:
+		static SharedBuffer* create(const std::string& data);
+
+		void retain() const;
+		void release() const;
+
+		/* Getters */
+		const std::string& get_data() const;
+
+	private:
+		const std::string	_data;
+		mutable long		_references;
+
+		SharedBuffer(const std::string& data);
+		~SharedBuffer();
+
+		SharedBuffer(const SharedBuffer& copy); /* disabled */
+		SharedBuffer& operator=(const SharedBuffer& other); /* disabled */
+	};
+
+} /* namespace webserv */
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <ctime>
+
+#ifndef TIMER_WHEEL_RESOLUTION
+#define TIMER_WHEEL_RESOLUTION 10 /* ms per tick */
+#endif
+
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+
+namespace webserv {
+	namespace internal {
+		/**
+		 * @brief Intrusive timer node, embedded in the object it times out
+		 * @note A copy is never armed, and a timer unlinks itself when destroyed
+		 */
+		struct Timer {
+			Timer*			prev;
+			Timer*			next;
+			unsigned long	expires;
+			int				fd;
+
+			Timer();
+			Timer(const Timer& copy);
+			Timer& operator=(const Timer& other);
+			~Timer();
+
+			bool is_armed() const;
+			void unlink();
+		};
+
+		/**
+		 * @brief Hierarchical timer wheel, schedule/cancel/expire are O(1) per timer
+		 * @note 4 levels of 64 slots with 10ms ticks cover about 46 hours, longer
+		 * deadlines are clamped
+		 */
+		class TimerWheel {
+		public:
+			TimerWheel();
+			~TimerWheel();
+
+			static unsigned long now_ms();
+
+			void schedule(Timer& timer, const unsigned long& expires_ms);
+			void cancel(Timer& timer);
+			void expire(const unsigned long& now_ms, std::vector<int>& expired_fds);
+			int get_next_timeout(const unsigned long& now_ms) const;
+
+		private:
+			Timer			_slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+			unsigned long	_current;
+
+			void add(Timer& timer);
+			void cascade(const int& level, const unsigned long& index);
+
+			TimerWheel(const TimerWheel& copy); /* disabled */
+			TimerWheel& operator=(const TimerWheel& other); /* disabled */
+		};
+	} /* namespace internal */
+} /* namespace webserv */
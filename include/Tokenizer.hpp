@@ -41,6 +41,7 @@ namespace webserv {
 			std::vector<Token>	_tokens;
 
 			void add_current_token();
+			void add_quoted_token(char quote);
 
 			Tokenizer(const Tokenizer& copy); /* disabled */
 			Tokenizer& operator=(const Tokenizer& other); /* disabled */
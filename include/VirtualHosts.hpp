@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstddef>
+
+#include "ServerConfig.hpp"
+
+namespace webserv {
+	/**
+	 * @brief Servers of one listen by server name, the first one is the default
+	 * @note Names are lowercase in an open addressing table at most half full,
+	 * a lookup hashes the Host once and allocates nothing
+	 */
+	class HostIndex {
+	public:
+		HostIndex();
+		HostIndex(const HostIndex& copy);
+		HostIndex& operator=(const HostIndex& other);
+		~HostIndex();
+
+		void add(const ServerConfig& server_config);
+		void build();
+		const ServerConfig* find(const char* host, size_t size) const;
+
+		/* Getters */
+		const ServerConfig& get_default() const;
+
+	private:
+		std::vector<std::pair<std::string, const ServerConfig*> >	_entries;
+		std::vector<int>											_slots;
+		size_t														_mask;
+		const ServerConfig*											_default;
+
+		size_t slot_of(const char* host, size_t size) const;
+	};
+
+	/**
+	 * @brief Host index of every listen, built once before serving
+	 * @note Indexes point into the server configs they're built from, which
+	 * must outlive them
+	 */
+	class VirtualHosts {
+	public:
+		VirtualHosts();
+		VirtualHosts(const VirtualHosts& copy);
+		VirtualHosts& operator=(const VirtualHosts& other);
+		~VirtualHosts();
+
+		void build(const std::vector<ServerConfig>& server_configs);
+		const HostIndex* find(const Listen& listen) const;
+
+	private:
+		std::map<Listen, HostIndex>	_indexes;
+	};
+
+} /* namespace webserv */
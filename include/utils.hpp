@@ -23,6 +23,7 @@
 #define RESET "\033[0m"
 
 #include "Logger.hpp"
+#include "Scanner.hpp"
 
 #define CRLF "\r\n"
 
@@ -76,10 +77,16 @@ namespace webserv {
 
 	std::string get_current_time(const char* format);
 
+	std::string format_http_date(const std::time_t& time);
+
+	std::time_t parse_http_date(const std::string& date);
+
 	bool is_extension(const std::string& file, const std::string& extension);
 
 	bool is_digits(const std::string& str);
 
+	long parse_size(const std::string& str);
+
 	bool is_ip4(const std::string& ip4);
 
 	bool is_match(std::string str, std::string pattern, char delimiter);
@@ -90,9 +97,13 @@ namespace webserv {
 
 	std::map<std::string, std::string> parse_header_fields(const std::string& headers);
 
+	bool is_coding_accepted(const std::string& accept_encoding, const std::string& coding);
+
 	void string_to_file(const std::string& file_path, const std::string& content, std::ios::openmode mode = std::ios::trunc | std::ios::binary);
 
-	std::string get_status_message(const int& status_code);
+	int open_temp_file(const std::string& directory);
+
+	bool write_all(int fd, const char* data, size_t size);
 
-	std::string get_mime_type(const std::string& type);
+	std::string get_status_message(const int& status_code);
 } /* namespace webserv */
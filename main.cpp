@@ -10,12 +10,11 @@
 
 #include "utils.hpp"
 #include "Parser.hpp"
-#include "Server.hpp"
+#include "Master.hpp"
 
 void sig_handler(int num) {
 	if (num == SIGINT || num == SIGQUIT) {
-		LOG_I() << "Gracefully shutting down server...\n";
-		webserv::internal::g_shutdown = true;
+		webserv::internal::g_shutdown = num;
 	}
 }
 
@@ -36,12 +35,15 @@ int main(int argc, char **argv) {
 
 	signal(SIGINT, sig_handler);
 	signal(SIGQUIT, sig_handler);
+	signal(SIGPIPE, SIG_IGN);
 
 	webserv::Parser parser;
 	try {
-		webserv::Server server(parser.parse(webserv::file_to_string(file)));
-		server.init();
-		server.run();
+		std::vector<webserv::ServerConfig> server_configs = parser.parse(webserv::file_to_string(file));
+		webserv::Master master(parser.get_global_config(), server_configs);
+		master.init();
+		master.run();
+		LOG_I() << "Gracefully shut down server\n";
 	} catch (const webserv::ParserExceptionAtLine& e) {
 		LOG_E() << "[" << file << ":" << e.get_line() << "] " << e.what() << "\n";
 		return EXIT_FAILURE;
@@ -0,0 +1,140 @@
+#include <limits>
+#include <ctime>
+#include <strings.h>
+
+#include "ByteRanges.hpp"
+#include "utils.hpp"
+
+namespace webserv {
+	/**
+	 * @brief Parse the digits at pos of field into value, pos ends after them
+	 * @return false if there is no digit or value overflows
+	 */
+	static bool parse_position(const std::string& field, size_t& pos, off_t& value) {
+		size_t start = pos;
+
+		value = 0;
+		while (pos < field.size() && field[pos] >= '0' && field[pos] <= '9') {
+			int digit = field[pos] - '0';
+			if (value > (std::numeric_limits<off_t>::max() - digit) / 10) {
+				return false;
+			}
+			value = value * 10 + digit;
+			++pos;
+		}
+		return pos != start;
+	}
+
+	static void skip_whitespace(const std::string& field, size_t& pos) {
+		while (pos < field.size() && (field[pos] == ' ' || field[pos] == '\t')) {
+			++pos;
+		}
+	}
+
+	/**
+	 * @brief Parse the range specs of the Range field of a size bytes representation
+	 * @note A malformed field, another unit, more than BYTE_RANGES_MAX ranges
+	 * or ranges adding up to more than size are ignored and the whole
+	 * representation is sent. Unsatisfiable specs are dropped, the last
+	 * position is clamped to the size and ranges keep the order of the field.
+	 * @return RANGES_SATISFIABLE with ranges filled, otherwise ranges is empty
+	 */
+	ByteRangesResult parse_byte_ranges(const std::string& field, const off_t& size, std::vector<ByteRange>& ranges) {
+		ranges.clear();
+		if (field.size() < 6 || strncasecmp(field.c_str(), "bytes=", 6) != 0) {
+			return RANGES_IGNORED;
+		}
+
+		size_t pos = 6;
+		bool has_spec = false;
+		bool malformed = true;
+		off_t total = 0;
+		while (true) {
+			skip_whitespace(field, pos);
+			if (pos < field.size() && field[pos] == ',') {
+				++pos;
+				continue;
+			}
+			if (pos == field.size()) {
+				malformed = !has_spec;
+				break;
+			}
+
+			ByteRange range;
+			if (field[pos] == '-') {
+				off_t suffix;
+				if (!parse_position(field, ++pos, suffix)) {
+					break;
+				}
+				range.start = suffix >= size ? 0 : size - suffix;
+				range.end = suffix == 0 ? 0 : size;
+			} else {
+				off_t first;
+				off_t last = size - 1;
+				if (!parse_position(field, pos, first) || pos == field.size() || field[pos++] != '-') {
+					break;
+				}
+				if (pos < field.size() && field[pos] >= '0' && field[pos] <= '9'
+					&& (!parse_position(field, pos, last) || last < first)) {
+					break;
+				}
+				range.start = first;
+				range.end = last >= size ? size : last + 1;
+			}
+
+			skip_whitespace(field, pos);
+			if (pos < field.size() && field[pos] != ',') {
+				break;
+			}
+			has_spec = true;
+			if (range.start >= range.end) {
+				continue;
+			}
+
+			total += range.end - range.start;
+			ranges.push_back(range);
+			if (ranges.size() > BYTE_RANGES_MAX || total > size) {
+				break;
+			}
+		}
+
+		if (malformed || ranges.size() > BYTE_RANGES_MAX || total > size) {
+			ranges.clear();
+			return RANGES_IGNORED;
+		}
+		return ranges.empty() ? RANGES_UNSATISFIABLE : RANGES_SATISFIABLE;
+	}
+
+	/**
+	 * @brief Content-Range value of range, "bytes 0-499/1234"
+	 */
+	std::string format_content_range(const ByteRange& range, const off_t& size) {
+		return "bytes " + to_string(range.start) + "-" + to_string(range.end - 1) + "/" + to_string(size);
+	}
+
+	namespace internal {
+		BoundaryGenerator::BoundaryGenerator(const unsigned long& worker_id) :
+			_worker_id(worker_id),
+			_count(0) {}
+
+		BoundaryGenerator::BoundaryGenerator(const BoundaryGenerator& copy) :
+			_worker_id(copy._worker_id),
+			_count(copy._count) {}
+
+		BoundaryGenerator& BoundaryGenerator::operator=(const BoundaryGenerator& other) {
+			if (this == &other) { return *this; }
+			_worker_id = other._worker_id;
+			_count = other._count;
+			return *this;
+		}
+
+		BoundaryGenerator::~BoundaryGenerator() {}
+
+		/**
+		 * @brief Next boundary, the time, the worker id and a count of this worker
+		 */
+		std::string BoundaryGenerator::next() {
+			return to_string(std::time(0)) + "-" + to_string(_worker_id) + "-" + to_string(++_count);
+		}
+	} /* namespace internal */
+} /* namespace webserv */
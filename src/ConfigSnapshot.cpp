@@ -0,0 +1,80 @@
+#include "ConfigSnapshot.hpp"
+
+namespace webserv {
+	/* Class ConfigSnapshot */
+
+	ConfigSnapshot::ConfigSnapshot(const std::vector<ServerConfig>& server_configs) :
+		_server_configs(server_configs),
+		_virtual_hosts(),
+		_references(1) {
+		_virtual_hosts.build(_server_configs);
+	}
+
+	ConfigSnapshot::~ConfigSnapshot() {}
+
+	/**
+	 * @brief Freeze server_configs, the caller holds the first reference
+	 * @note Give it to a ConfigRef, which releases it
+	 */
+	ConfigSnapshot* ConfigSnapshot::create(const std::vector<ServerConfig>& server_configs) {
+		return new ConfigSnapshot(server_configs);
+	}
+
+	/**
+	 * @note Worker threads share a snapshot, the count is atomic
+	 */
+	void ConfigSnapshot::retain() const {
+		__sync_add_and_fetch(&_references, 1);
+	}
+
+	void ConfigSnapshot::release() const {
+		if (__sync_sub_and_fetch(&_references, 1) == 0) {
+			delete this;
+		}
+	}
+
+	/* Getters */
+	const std::vector<ServerConfig>& ConfigSnapshot::get_server_configs() const { return _server_configs; }
+	const VirtualHosts& ConfigSnapshot::get_virtual_hosts() const { return _virtual_hosts; }
+
+	/* Class ConfigRef */
+
+	ConfigRef::ConfigRef() :
+		_snapshot(NULL) {}
+
+	/**
+	 * @brief Take over the reference of a just created snapshot
+	 */
+	ConfigRef::ConfigRef(const ConfigSnapshot* snapshot) :
+		_snapshot(snapshot) {}
+
+	ConfigRef::ConfigRef(const ConfigRef& copy) :
+		_snapshot(copy._snapshot) {
+		if (_snapshot != NULL) {
+			_snapshot->retain();
+		}
+	}
+
+	ConfigRef& ConfigRef::operator=(const ConfigRef& other) {
+		if (this == &other || _snapshot == other._snapshot) { return *this; }
+		if (other._snapshot != NULL) {
+			other._snapshot->retain();
+		}
+		if (_snapshot != NULL) {
+			_snapshot->release();
+		}
+		_snapshot = other._snapshot;
+		return *this;
+	}
+
+	ConfigRef::~ConfigRef() {
+		if (_snapshot != NULL) {
+			_snapshot->release();
+		}
+	}
+
+	const ConfigSnapshot* ConfigRef::operator->() const { return _snapshot; }
+	const ConfigSnapshot& ConfigRef::operator*() const { return *_snapshot; }
+	const ConfigSnapshot* ConfigRef::get() const { return _snapshot; }
+
+} /* namespace webserv */
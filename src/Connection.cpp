@@ -0,0 +1,374 @@
+#include "Connection.hpp"
+
+namespace webserv {
+	/* Struct OutputChunk */
+
+	OutputChunk::OutputChunk() :
+		data(),
+		shared(NULL),
+		file_fd(-1),
+		borrows_file(false),
+		gzip(NULL),
+		offset(0),
+		end(0) {}
+
+	OutputChunk::OutputChunk(const OutputChunk& copy) :
+		data(copy.data),
+		shared(copy.shared),
+		file_fd(copy.file_fd == -1 || copy.borrows_file ? copy.file_fd : dup(copy.file_fd)),
+		borrows_file(copy.borrows_file),
+		gzip(copy.gzip == NULL ? NULL : new GzipStream(*copy.gzip)),
+		offset(copy.offset),
+		end(copy.end) {
+		if (shared != NULL) {
+			shared->retain();
+		}
+	}
+
+	OutputChunk& OutputChunk::operator=(const OutputChunk& other) {
+		if (this == &other) { return *this; }
+		if (file_fd != -1 && !borrows_file) {
+			close(file_fd);
+		}
+		if (other.shared != NULL) {
+			other.shared->retain();
+		}
+		if (shared != NULL) {
+			shared->release();
+		}
+		delete gzip;
+		data = other.data;
+		shared = other.shared;
+		file_fd = other.file_fd == -1 || other.borrows_file ? other.file_fd : dup(other.file_fd);
+		borrows_file = other.borrows_file;
+		gzip = other.gzip == NULL ? NULL : new GzipStream(*other.gzip);
+		offset = other.offset;
+		end = other.end;
+		return *this;
+	}
+
+	OutputChunk::~OutputChunk() {
+		if (file_fd != -1 && !borrows_file) {
+			close(file_fd);
+		}
+		if (shared != NULL) {
+			shared->release();
+		}
+		delete gzip;
+	}
+
+	/* Class Connection */
+
+	Connection::Connection(struct sockaddr_in client_address, const Listen& server_listen) :
+		_request(client_address, server_listen),
+		_request_count(0),
+		_keepalive_timeout(0),
+		_timer(),
+		_pending_input(),
+		_output_queue() {}
+
+	Connection::Connection(const Connection& copy) :
+		_request(copy._request),
+		_request_count(copy._request_count),
+		_keepalive_timeout(copy._keepalive_timeout),
+		_timer(copy._timer),
+		_pending_input(copy._pending_input),
+		_output_queue(copy._output_queue) {}
+
+	Connection& Connection::operator=(const Connection& other) {
+		if (this == &other) { return *this; }
+		_request = other._request;
+		_request_count = other._request_count;
+		_keepalive_timeout = other._keepalive_timeout;
+		_timer = other._timer;
+		_pending_input = other._pending_input;
+		_output_queue = other._output_queue;
+		return *this;
+	}
+
+	Connection::~Connection() {}
+
+	/**
+	 * @brief Reset request state so the connection can serve the next request
+	 */
+	void Connection::finish_request() {
+		++_request_count;
+		_keepalive_timeout = _request.get_server_config().get_keepalive_timeout();
+		_request = Request(_request.get_client(), _request.get_server_listen());
+	}
+
+	/**
+	 * @brief Timeout to arm once input was fed to the request, -1 keeps the armed one
+	 * @note The header deadline is armed once, at accept or when the first byte
+	 * of a keep-alive request arrives, so a header trickled in byte by byte
+	 * still expires after client_header_timeout. Body reads arm
+	 * client_body_timeout, an idle keep-alive connection keepalive_timeout.
+	 */
+	int Connection::get_input_timeout(const bool& was_started) const {
+		if (_request.get_parse_state() == PARSE_BODY) {
+			return _request.get_server_config().get_client_body_timeout();
+		}
+		if (_request_count == 0 || (was_started && _request.has_started())) {
+			return -1;
+		}
+		if (!_request.has_started()) {
+			return _keepalive_timeout;
+		}
+		return _request.get_server_config().get_client_header_timeout();
+	}
+
+	/**
+	 * @brief Keep bytes received after the current request, they start the next one
+	 */
+	void Connection::keep_pending_input(const char* data, const size_t& size) {
+		_pending_input.append(data, size);
+	}
+
+	/**
+	 * @brief Move pending input into input, leaving none in the connection
+	 */
+	void Connection::take_pending_input(std::string& input) {
+		input.clear();
+		input.swap(_pending_input);
+	}
+
+	bool Connection::has_pending_input() const {
+		return !_pending_input.empty();
+	}
+
+	/**
+	 * @brief Append data to the output queue, it is sent by flush_output
+	 */
+	void Connection::queue_output(const std::string& data) {
+		if (data.empty()) {
+			return;
+		}
+		_output_queue.push_back(OutputChunk());
+		_output_queue.back().data = data;
+		_output_queue.back().end = data.size();
+	}
+
+	/**
+	 * @brief Append the [offset, end) range of shared to the output queue, without copy
+	 */
+	void Connection::queue_shared(const SharedBuffer* shared, size_t offset, size_t end) {
+		if (offset >= end) {
+			return;
+		}
+		_output_queue.push_back(OutputChunk());
+		shared->retain();
+		_output_queue.back().shared = shared;
+		_output_queue.back().offset = offset;
+		_output_queue.back().end = end;
+	}
+
+	/**
+	 * @brief Append the [offset, end) range of file_fd to the output queue
+	 * @note Takes file_fd, it is closed once sent or with the connection
+	 */
+	void Connection::queue_file(int file_fd, off_t offset, off_t end) {
+		if (offset >= end) {
+			close(file_fd);
+			return;
+		}
+		_output_queue.push_back(OutputChunk());
+		_output_queue.back().file_fd = file_fd;
+		_output_queue.back().offset = offset;
+		_output_queue.back().end = end;
+	}
+
+	/**
+	 * @brief Append the [offset, end) range of file_fd to the output queue, without taking it
+	 * @note A later queue_file of file_fd takes it, file ranges are sent at
+	 * their own offsets so parts of one file share its fd
+	 */
+	void Connection::queue_file_part(int file_fd, off_t offset, off_t end) {
+		if (offset >= end) {
+			return;
+		}
+		_output_queue.push_back(OutputChunk());
+		_output_queue.back().file_fd = file_fd;
+		_output_queue.back().borrows_file = true;
+		_output_queue.back().offset = offset;
+		_output_queue.back().end = end;
+	}
+
+	/**
+	 * @brief Append the [offset, end) range of file_fd to the output queue,
+	 * gzip compressed at level in the chunked transfer coding
+	 * @note Takes file_fd. The range is read and compressed a piece at a time
+	 * while the socket takes the output, the last frame ends the body.
+	 */
+	void Connection::queue_compressed_file(int file_fd, off_t offset, off_t end, int level) {
+		_output_queue.push_back(OutputChunk());
+		_output_queue.back().file_fd = file_fd;
+		_output_queue.back().gzip = new GzipStream(level, end - offset);
+		_output_queue.back().offset = offset;
+		_output_queue.back().end = end;
+	}
+
+	/**
+	 * @brief Send as much queued output as the socket accepts without blocking
+	 * @note Resumes where the last call stopped, file ranges never pass through
+	 * user space where sendfile exists
+	 * @return false if the socket failed, otherwise true even if output is left
+	 */
+	bool Connection::flush_output(const int& fd) {
+		while (!_output_queue.empty()) {
+			OutputChunk& chunk = _output_queue.front();
+			ssize_t ret;
+
+			if (chunk.gzip != NULL) {
+				if (!compress_file()) {
+					return false;
+				}
+				continue;
+			} else if (chunk.file_fd == -1) {
+				ret = send_memory(fd);
+			} else {
+				ret = send_file(fd, chunk, _output_queue.size() > 1);
+				if (ret > 0 && chunk.offset == chunk.end) {
+					_output_queue.pop_front();
+				}
+			}
+
+			if (ret == -1) {
+				return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+			}
+			if (ret == 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Send the memory chunks at the front of the queue with one sendmsg
+	 * and drop the ones sent entirely
+	 * @note With more output queued, MSG_MORE holds a partial frame back so the
+	 * header leaves in the same segments as the start of the file
+	 * @return bytes sent or -1 with errno set
+	 */
+	ssize_t Connection::send_memory(const int& fd) {
+		struct iovec iovecs[SEND_IOVECS];
+		size_t count = 0;
+
+		std::deque<OutputChunk>::const_iterator it = _output_queue.begin();
+		for (; it != _output_queue.end() && it->file_fd == -1 && count < SEND_IOVECS; ++it) {
+			const char* data = it->shared == NULL ? it->data.data() : it->shared->get_data().data();
+			iovecs[count].iov_base = const_cast<char*>(data + it->offset);
+			iovecs[count].iov_len = it->end - it->offset;
+			++count;
+		}
+
+		struct msghdr message;
+		std::memset(&message, 0, sizeof(message));
+		message.msg_iov = iovecs;
+		message.msg_iovlen = count;
+
+		int flags = 0;
+#ifdef MSG_MORE
+		if (it != _output_queue.end()) {
+			flags = MSG_MORE;
+		}
+#endif
+
+		ssize_t ret = sendmsg(fd, &message, flags);
+		for (size_t sent = ret > 0 ? ret : 0; sent > 0;) {
+			OutputChunk& chunk = _output_queue.front();
+			size_t size = chunk.end - chunk.offset;
+			if (sent < size) {
+				chunk.offset += sent;
+				break;
+			}
+			sent -= size;
+			_output_queue.pop_front();
+		}
+		return ret;
+	}
+
+	/**
+	 * @brief Send the rest of a file chunk once and advance its offset
+	 * @return bytes sent or -1 with errno set, 0 if the file got shorter
+	 */
+	ssize_t Connection::send_file(const int& fd, OutputChunk& chunk, bool more) {
+#ifdef __linux__
+		(void)more;
+		// sendfile advances offset itself
+		return sendfile(fd, chunk.file_fd, &chunk.offset, chunk.end - chunk.offset);
+#else
+		int flags = 0;
+#ifdef MSG_MORE
+		if (more) {
+			flags = MSG_MORE;
+		}
+#else
+		(void)more;
+#endif
+		char buffer[SEND_FILE_BUFFER];
+		size_t size = chunk.end - chunk.offset < SEND_FILE_BUFFER ? chunk.end - chunk.offset : SEND_FILE_BUFFER;
+		ssize_t read_size = pread(chunk.file_fd, buffer, size, chunk.offset);
+		if (read_size <= 0) {
+			return read_size;
+		}
+
+		ssize_t ret = send(fd, buffer, read_size, flags);
+		if (ret > 0) {
+			chunk.offset += ret;
+		}
+		return ret;
+#endif
+	}
+
+	/**
+	 * @brief Compress the next piece of the compressed file chunk at the front
+	 * of the queue into a chunked frame queued before it
+	 * @note The last piece ends the gzip stream and the body, then the file
+	 * chunk is dropped. A piece deflate keeps back queues nothing.
+	 * @return false if the file can't be read or got shorter
+	 */
+	bool Connection::compress_file() {
+		OutputChunk& chunk = _output_queue.front();
+		char buffer[SEND_FILE_BUFFER];
+		size_t size = chunk.end - chunk.offset < SEND_FILE_BUFFER ? chunk.end - chunk.offset : SEND_FILE_BUFFER;
+		ssize_t read_size = size == 0 ? 0 : pread(chunk.file_fd, buffer, size, chunk.offset);
+		if (read_size < 0 || (read_size == 0 && size != 0)) {
+			return false;
+		}
+		chunk.offset += read_size;
+
+		bool last = chunk.offset == chunk.end;
+		std::string compressed;
+		if (!chunk.gzip->compress(buffer, read_size, last, compressed)) {
+			return false;
+		}
+
+		std::string frame;
+		if (!compressed.empty()) {
+			std::stringstream ss;
+			ss << std::hex << compressed.size();
+			frame = ss.str() + CRLF + compressed + CRLF;
+		}
+		if (last) {
+			frame += "0" CRLF CRLF;
+			_output_queue.pop_front();
+		}
+		if (!frame.empty()) {
+			_output_queue.push_front(OutputChunk());
+			_output_queue.front().data.swap(frame);
+			_output_queue.front().end = _output_queue.front().data.size();
+		}
+		return true;
+	}
+
+	bool Connection::has_pending_output() const {
+		return !_output_queue.empty();
+	}
+
+	/* Getters */
+	Request& Connection::get_request() { return _request; }
+	const Request& Connection::get_request() const { return _request; }
+	const size_t& Connection::get_request_count() const { return _request_count; }
+	const int& Connection::get_keepalive_timeout() const { return _keepalive_timeout; }
+	internal::Timer& Connection::get_timer() { return _timer; }
+} /* namespace webserv */
@@ -0,0 +1,123 @@
+#include "ConnectionTable.hpp"
+
+namespace webserv {
+	/* Struct ConnectionEntry */
+
+	Connection& ConnectionEntry::get_connection() {
+		return *reinterpret_cast<Connection*>(_storage.bytes);
+	}
+
+	/* Class ConnectionTable */
+
+	ConnectionTable::ConnectionTable() : _pages(), _capacity(CONNECTION_TABLE_MAX_FDS) {
+		struct rlimit limit;
+
+		if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY
+			&& limit.rlim_cur < CONNECTION_TABLE_MAX_FDS) {
+			_capacity = limit.rlim_cur;
+		}
+
+		_pages.resize((_capacity + CONNECTION_TABLE_PAGE_SIZE - 1) / CONNECTION_TABLE_PAGE_SIZE, NULL);
+	}
+
+	/**
+	 * @brief Destroy connections left in the table, their fds are closed by Server
+	 */
+	ConnectionTable::~ConnectionTable() {
+		for (size_t page = 0; page < _pages.size(); ++page) {
+			if (_pages[page] == NULL) {
+				continue;
+			}
+
+			for (size_t i = 0; i < CONNECTION_TABLE_PAGE_SIZE; ++i) {
+				if (_pages[page][i].type == ENTRY_CLIENT) {
+					_pages[page][i].get_connection().~Connection();
+				}
+			}
+			delete[] _pages[page];
+		}
+	}
+
+	/**
+	 * @brief Entry of fd or NULL if fd was never added
+	 */
+	ConnectionEntry* ConnectionTable::get(const int& fd) {
+		if (fd < 0 || static_cast<size_t>(fd) >= _capacity) {
+			return NULL;
+		}
+
+		ConnectionEntry* page = _pages[fd / CONNECTION_TABLE_PAGE_SIZE];
+		if (page == NULL) {
+			return NULL;
+		}
+		return &page[fd % CONNECTION_TABLE_PAGE_SIZE];
+	}
+
+	ConnectionEntry* ConnectionTable::get_or_create(const int& fd) {
+		if (fd < 0 || static_cast<size_t>(fd) >= _capacity) {
+			return NULL;
+		}
+
+		ConnectionEntry*& page = _pages[fd / CONNECTION_TABLE_PAGE_SIZE];
+		if (page == NULL) {
+			page = new ConnectionEntry[CONNECTION_TABLE_PAGE_SIZE];
+
+			for (size_t i = 0; i < CONNECTION_TABLE_PAGE_SIZE; ++i) {
+				page[i].type = ENTRY_FREE;
+				page[i].fd = fd - fd % CONNECTION_TABLE_PAGE_SIZE + i;
+				page[i].listen.port = 0;
+				page[i].hosts = NULL;
+			}
+		}
+		return &page[fd % CONNECTION_TABLE_PAGE_SIZE];
+	}
+
+	/**
+	 * @brief Register fd as listen socket of listen
+	 * @return entry or NULL if fd is already used or out of the table
+	 */
+	ConnectionEntry* ConnectionTable::add_listener(const int& fd, const Listen& listen) {
+		ConnectionEntry* entry = get_or_create(fd);
+		if (entry == NULL || entry->type != ENTRY_FREE) {
+			return NULL;
+		}
+
+		entry->type = ENTRY_LISTENER;
+		entry->listen = listen;
+		return entry;
+	}
+
+	/**
+	 * @brief Build the Connection of a client accepted on listen
+	 * @return entry or NULL if fd is already used or out of the table
+	 */
+	ConnectionEntry* ConnectionTable::add_client(const int& fd, struct sockaddr_in client_address, const Listen& listen) {
+		ConnectionEntry* entry = get_or_create(fd);
+		if (entry == NULL || entry->type != ENTRY_FREE) {
+			return NULL;
+		}
+
+		new (entry->_storage.bytes) Connection(client_address, listen);
+		entry->type = ENTRY_CLIENT;
+		entry->listen = listen;
+		return entry;
+	}
+
+	/**
+	 * @brief Free the entry of fd, destroying its Connection
+	 */
+	void ConnectionTable::remove(const int& fd) {
+		ConnectionEntry* entry = get(fd);
+		if (entry == NULL) {
+			return;
+		}
+
+		if (entry->type == ENTRY_CLIENT) {
+			entry->get_connection().~Connection();
+		}
+		entry->type = ENTRY_FREE;
+	}
+
+	/* Getters */
+	const size_t& ConnectionTable::get_capacity() const { return _capacity; }
+} /* namespace webserv */
@@ -0,0 +1,224 @@
+#include "GlobalConfig.hpp"
+
+namespace webserv {
+	GlobalConfig::GlobalConfig() :
+		_worker_threads(-1),
+		_worker_processes(-1),
+		_types(),
+		_open_file_cache(-1),
+		_open_file_cache_valid(-1),
+		_open_file_cache_errors(true),
+		_response_cache(-1),
+		_response_cache_max_file(-1) {}
+
+	GlobalConfig::GlobalConfig(const GlobalConfig& copy) :
+		_worker_threads(copy._worker_threads),
+		_worker_processes(copy._worker_processes),
+		_types(copy._types),
+		_open_file_cache(copy._open_file_cache),
+		_open_file_cache_valid(copy._open_file_cache_valid),
+		_open_file_cache_errors(copy._open_file_cache_errors),
+		_response_cache(copy._response_cache),
+		_response_cache_max_file(copy._response_cache_max_file) {}
+
+	GlobalConfig& GlobalConfig::operator=(const GlobalConfig& other) {
+		if (this == &other) { return *this; }
+		_worker_threads = other._worker_threads;
+		_worker_processes = other._worker_processes;
+		_types = other._types;
+		_open_file_cache = other._open_file_cache;
+		_open_file_cache_valid = other._open_file_cache_valid;
+		_open_file_cache_errors = other._open_file_cache_errors;
+		_response_cache = other._response_cache;
+		_response_cache_max_file = other._response_cache_max_file;
+		return *this;
+	}
+
+	GlobalConfig::~GlobalConfig() {}
+
+	/**
+	 * @brief Register the avaiable types in global scope for Parser
+	 */
+	void GlobalConfig::register_types(std::set<std::string>& types) {
+		types.insert("worker_threads");
+		types.insert("worker_processes");
+		types.insert("types");
+		types.insert("open_file_cache");
+		types.insert("open_file_cache_valid");
+		types.insert("open_file_cache_errors");
+		types.insert("response_cache");
+		types.insert("response_cache_max_file");
+	}
+
+	/**
+	 * @brief Universal setter
+	 * @return true if successfully set the value, otherwise false
+	 */
+	bool GlobalConfig::set_config(const std::string& type, const std::string& value) {
+		if (type == "worker_threads" && _worker_threads == -1) {
+			return set_worker_count(_worker_threads, value);
+		} else if (type == "worker_processes" && _worker_processes == -1) {
+			return set_worker_count(_worker_processes, value);
+		} else if (type == "open_file_cache" && _open_file_cache == -1) {
+			return set_open_file_cache(value);
+		} else if (type == "open_file_cache_valid" && _open_file_cache_valid == -1) {
+			return set_open_file_cache_valid(value);
+		} else if (type == "open_file_cache_errors") {
+			return set_open_file_cache_errors(value);
+		} else if (type == "response_cache" && _response_cache == -1) {
+			return set_response_cache(value);
+		} else if (type == "response_cache_max_file" && _response_cache_max_file == -1) {
+			_response_cache_max_file = parse_size(value);
+			return _response_cache_max_file >= 0;
+		}
+
+		return false;
+	}
+
+	/**
+	 * @brief Set the rest of unset configuration to default value
+	 * @return true if succesfully set otherwise false
+	 */
+	bool GlobalConfig::set_default() {
+		if (_worker_threads == -1) {
+			_worker_threads = 1;
+		}
+
+		if (_worker_processes == -1) {
+			_worker_processes = 1;
+		}
+
+		if (_open_file_cache == -1) {
+			_open_file_cache = 256;
+		}
+
+		if (_open_file_cache_valid == -1) {
+			_open_file_cache_valid = 60;
+		}
+
+		if (_response_cache == -1) {
+			_response_cache = 1024 * 1024;
+		}
+
+		if (_response_cache_max_file == -1) {
+			_response_cache_max_file = 64 * 1024;
+		}
+
+		/* worker processes and worker threads are two alternative models */
+		return _worker_threads == 1 || _worker_processes == 1;
+	}
+
+	/**
+	 * @brief Set types block of global config, servers without one inherit it
+	 * @return false if types were already set
+	 */
+	bool GlobalConfig::set_types(const MimeTypes& types) {
+		if (!_types.empty()) {
+			return false;
+		}
+		_types = types;
+		return true;
+	}
+
+	/**
+	 * @brief Parse a worker count, "auto" means one per online cpu core
+	 */
+	bool GlobalConfig::set_worker_count(int& count, const std::string& value) {
+		if (value == "auto") {
+			long cores = sysconf(_SC_NPROCESSORS_ONLN);
+			count = cores > 0 ? static_cast<int>(cores) : 1;
+			return true;
+		}
+
+		if (!is_digits(value) || value[0] == '-') {
+			return false;
+		}
+
+		count = std::atoi(value.c_str());
+		return count > 0 && count <= 512;
+	}
+
+	/**
+	 * @brief Parse the most entries of the open file cache of a worker, "off" is 0
+	 */
+	bool GlobalConfig::set_open_file_cache(const std::string& value) {
+		if (value == "off") {
+			_open_file_cache = 0;
+			return true;
+		}
+
+		if (!is_digits(value) || value[0] == '-' || value.size() > 7) {
+			return false;
+		}
+
+		_open_file_cache = std::atoi(value.c_str());
+		return true;
+	}
+
+	/**
+	 * @brief Parse the seconds an open file cache entry is trusted without a stat
+	 */
+	bool GlobalConfig::set_open_file_cache_valid(const std::string& value) {
+		if (!is_digits(value) || value[0] == '-' || value.size() > 7) {
+			return false;
+		}
+
+		_open_file_cache_valid = std::atoi(value.c_str());
+		return true;
+	}
+
+	/**
+	 * @brief Check open_file_cache_errors is valid and set it
+	 */
+	bool GlobalConfig::set_open_file_cache_errors(const std::string& value) {
+		if (value == "on") {
+			_open_file_cache_errors = true;
+			return true;
+		} else if (value == "off") {
+			_open_file_cache_errors = false;
+			return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * @brief Parse the byte budget of the response cache of a worker, "off" is 0
+	 */
+	bool GlobalConfig::set_response_cache(const std::string& value) {
+		if (value == "off") {
+			_response_cache = 0;
+			return true;
+		}
+
+		_response_cache = parse_size(value);
+		return _response_cache >= 0;
+	}
+
+	/* Getters */
+	const int& GlobalConfig::get_worker_threads() const { return _worker_threads; }
+	const int& GlobalConfig::get_worker_processes() const { return _worker_processes; }
+	const MimeTypes& GlobalConfig::get_types() const { return _types; }
+	const int& GlobalConfig::get_open_file_cache() const { return _open_file_cache; }
+	const int& GlobalConfig::get_open_file_cache_valid() const { return _open_file_cache_valid; }
+	const bool& GlobalConfig::get_open_file_cache_errors() const { return _open_file_cache_errors; }
+	const long& GlobalConfig::get_response_cache() const { return _response_cache; }
+	const long& GlobalConfig::get_response_cache_max_file() const { return _response_cache_max_file; }
+
+#ifdef PARSER_DEBUG
+	std::ostream& operator<<(std::ostream& os, const GlobalConfig& global_config) {
+		os << "worker_threads " << global_config.get_worker_threads() << ";\n";
+		os << "worker_processes " << global_config.get_worker_processes() << ";\n";
+		os << "open_file_cache " << global_config.get_open_file_cache() << ";\n";
+		os << "open_file_cache_valid " << global_config.get_open_file_cache_valid() << ";\n";
+		os << "open_file_cache_errors " << (global_config.get_open_file_cache_errors() ? "on" : "off") << ";\n";
+		os << "response_cache " << global_config.get_response_cache() << ";\n";
+		os << "response_cache_max_file " << global_config.get_response_cache_max_file() << ";\n";
+		if (!global_config.get_types().empty()) {
+			os << global_config.get_types();
+		}
+		return os;
+	}
+#endif
+
+} /* namespace webserv */
@@ -0,0 +1,95 @@
+#include <cstring>
+
+#include "GzipStream.hpp"
+
+#define GZIP_WINDOW_BITS 15
+#define GZIP_MIN_WINDOW_BITS 9
+#define GZIP_MEMORY_LEVEL 8
+#define GZIP_HEADER 16 /* added to the window bits for a gzip wrapper */
+
+namespace webserv {
+	/**
+	 * @brief Start a gzip stream at level, size_hint is the body size or 0 if unknown
+	 */
+	GzipStream::GzipStream(int level, off_t size_hint) :
+		_stream(),
+		_ready(false) {
+		int window_bits = GZIP_WINDOW_BITS;
+		int memory_level = GZIP_MEMORY_LEVEL;
+		if (size_hint > 0) {
+			while (window_bits > GZIP_MIN_WINDOW_BITS && size_hint <= (off_t(1) << (window_bits - 1))) {
+				--window_bits;
+				if (memory_level > 1) {
+					--memory_level;
+				}
+			}
+		}
+
+		std::memset(&_stream, 0, sizeof(_stream));
+		_ready = deflateInit2(&_stream, level, Z_DEFLATED, window_bits + GZIP_HEADER, memory_level,
+			Z_DEFAULT_STRATEGY) == Z_OK;
+	}
+
+	GzipStream::GzipStream(const GzipStream& copy) :
+		_stream(),
+		_ready(false) {
+		std::memset(&_stream, 0, sizeof(_stream));
+		if (copy._ready) {
+			_ready = deflateCopy(&_stream, const_cast<z_stream*>(&copy._stream)) == Z_OK;
+		}
+	}
+
+	GzipStream::~GzipStream() {
+		if (_ready) {
+			deflateEnd(&_stream);
+		}
+	}
+
+	/**
+	 * @brief Replace data with its gzip coding at level, at once
+	 * @return false if deflate failed, data is then left as is
+	 */
+	bool GzipStream::compress_string(std::string& data, int level) {
+		GzipStream gzip(level, data.size());
+		std::string compressed;
+		if (!gzip.compress(data.data(), data.size(), true, compressed)) {
+			return false;
+		}
+		data.swap(compressed);
+		return true;
+	}
+
+	/**
+	 * @brief Compress size bytes of data and append what deflate gives out to output
+	 * @note deflate keeps input back until it has a block, so output may not
+	 * grow. With finish the stream ends, the trailer included.
+	 * @return false if the stream failed or already ended
+	 */
+	bool GzipStream::compress(const char* data, size_t size, bool finish, std::string& output) {
+		if (!_ready) {
+			return false;
+		}
+
+		char buffer[GZIP_BUFFER];
+		_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+		_stream.avail_in = size;
+		int ret;
+		do {
+			_stream.next_out = reinterpret_cast<Bytef*>(buffer);
+			_stream.avail_out = sizeof(buffer);
+			ret = deflate(&_stream, finish ? Z_FINISH : Z_NO_FLUSH);
+			if (ret == Z_STREAM_ERROR) {
+				return false;
+			}
+			output.append(buffer, sizeof(buffer) - _stream.avail_out);
+		} while (_stream.avail_out == 0 || _stream.avail_in != 0);
+
+		if (finish) {
+			deflateEnd(&_stream);
+			_ready = false;
+			return ret == Z_STREAM_END;
+		}
+		return true;
+	}
+
+} /* namespace webserv */
@@ -0,0 +1,173 @@
+#include "HttpTables.hpp"
+
+#define STATUS_LINE(code, reason) { code, "HTTP/1.1 " #code " " reason CRLF, sizeof("HTTP/1.1 " #code " " reason CRLF) - 1, reason }
+
+namespace webserv {
+	static const char* const header_names[HEADER_COUNT] = {
+		"",
+		"Host",
+		"Range",
+		"Accept",
+		"Cookie",
+		"Expect",
+		"Referer",
+		"If-Range",
+		"Connection",
+		"User-Agent",
+		"Content-Type",
+		"If-None-Match",
+		"Content-Length",
+		"Accept-Encoding",
+		"If-Modified-Since",
+		"Transfer-Encoding"
+	};
+
+	static const StatusLine status_lines[] = {
+		STATUS_LINE(200, "OK"),
+		STATUS_LINE(201, "Created"),
+		STATUS_LINE(202, "Accepted"),
+		STATUS_LINE(204, "No Content"),
+		STATUS_LINE(206, "Partial Content"),
+		STATUS_LINE(300, "Multiple Choices"),
+		STATUS_LINE(301, "Moved Permanently"),
+		STATUS_LINE(302, "Found"),
+		STATUS_LINE(303, "See Other"),
+		STATUS_LINE(304, "Not Modified"),
+		STATUS_LINE(400, "Bad Request"),
+		STATUS_LINE(401, "Unauthorized"),
+		STATUS_LINE(403, "Forbidden"),
+		STATUS_LINE(404, "Not Found"),
+		STATUS_LINE(405, "Method Not Allowed"),
+		STATUS_LINE(408, "Request Timeout"),
+		STATUS_LINE(411, "Length Required"),
+		STATUS_LINE(412, "Precondition Failed"),
+		STATUS_LINE(413, "Request Too Large"),
+		STATUS_LINE(414, "URI Too Long"),
+		STATUS_LINE(416, "Range Not Satisfiable"),
+		STATUS_LINE(418, "I'm a teapot"),
+		STATUS_LINE(500, "Internal Server Error"),
+		STATUS_LINE(501, "Not Implemented"),
+		STATUS_LINE(502, "Bad Gateway"),
+		STATUS_LINE(503, "Service Unavailable"),
+		STATUS_LINE(504, "Gateway Timeout"),
+		STATUS_LINE(505, "HTTP Version Not Supported")
+	};
+
+	/* status code to its line, zero initialized then filled during static initialization */
+	static const StatusLine* status_line_index[600];
+
+	static bool build_status_line_index() {
+		for (size_t i = 0; i < sizeof(status_lines) / sizeof(status_lines[0]); ++i) {
+			status_line_index[status_lines[i].code] = &status_lines[i];
+		}
+		return true;
+	}
+
+	static const bool status_line_index_built = build_status_line_index();
+
+	/**
+	 * @brief Method of a request line, methods are case-sensitive
+	 * @return requests value, UNKNOWN if it isn't one
+	 * @note Length and first byte select the only candidate, then one memcmp
+	 */
+	int lookup_method(const char* method, size_t size) {
+		int candidate = UNKNOWN;
+
+		switch (size) {
+			case 3:
+				candidate = method[0] == 'G' ? GET : PUT;
+				break;
+			case 4:
+				candidate = method[0] == 'H' ? HEAD : POST;
+				break;
+			case 5:
+				candidate = TRACE;
+				break;
+			case 6:
+				candidate = DELETE;
+				break;
+			case 7:
+				candidate = method[0] == 'C' ? CONNECT : OPTIONS;
+				break;
+		}
+
+		if (candidate == UNKNOWN || std::memcmp(method, HTTPMethodStrings[candidate], size) != 0) {
+			return UNKNOWN;
+		}
+		return candidate;
+	}
+
+	/**
+	 * @brief Id of a header field name, names are case-insensitive
+	 * @note Length and first byte select the only candidate, then one strncasecmp
+	 */
+	HeaderId lookup_header(const char* name, size_t size) {
+		HeaderId candidate = HEADER_UNKNOWN;
+
+		switch (size) {
+			case 4:
+				candidate = HEADER_HOST;
+				break;
+			case 5:
+				candidate = HEADER_RANGE;
+				break;
+			case 6:
+				switch (name[0] | 0x20) {
+					case 'a': candidate = HEADER_ACCEPT; break;
+					case 'c': candidate = HEADER_COOKIE; break;
+					case 'e': candidate = HEADER_EXPECT; break;
+				}
+				break;
+			case 7:
+				candidate = HEADER_REFERER;
+				break;
+			case 8:
+				candidate = HEADER_IF_RANGE;
+				break;
+			case 10:
+				candidate = (name[0] | 0x20) == 'c' ? HEADER_CONNECTION : HEADER_USER_AGENT;
+				break;
+			case 12:
+				candidate = HEADER_CONTENT_TYPE;
+				break;
+			case 13:
+				candidate = HEADER_IF_NONE_MATCH;
+				break;
+			case 14:
+				candidate = HEADER_CONTENT_LENGTH;
+				break;
+			case 15:
+				candidate = HEADER_ACCEPT_ENCODING;
+				break;
+			case 17:
+				candidate = (name[0] | 0x20) == 'i' ? HEADER_IF_MODIFIED_SINCE : HEADER_TRANSFER_ENCODING;
+				break;
+		}
+
+		if (candidate == HEADER_UNKNOWN || strncasecmp(name, header_names[candidate], size) != 0) {
+			return HEADER_UNKNOWN;
+		}
+		return candidate;
+	}
+
+	/**
+	 * @brief Name of a header field id as usually written, "" for HEADER_UNKNOWN
+	 */
+	const char* get_header_name(HeaderId id) {
+		return id < HEADER_COUNT ? header_names[id] : header_names[HEADER_UNKNOWN];
+	}
+
+	/**
+	 * @brief Prebuilt status line of status code
+	 * @return line or NULL if the status code has none
+	 */
+	const StatusLine* find_status_line(int status_code) {
+		(void)status_line_index_built;
+		if (status_code < 0 || status_code >= 600) {
+			return NULL;
+		}
+		return status_line_index[status_code];
+	}
+} /* namespace webserv */
+
+#undef STATUS_LINE
@@ -12,17 +12,40 @@ namespace webserv {
 			}
 		}
 
-		int IOHandler::wait_for_new_event() {
-			int new_event_size = kevent(_poll_fd, NULL, 0, _event_list, 100, NULL);
-			if (new_event_size == -1 && !g_shutdown) {
+		/**
+		 * @brief Replace poll with a fresh one without any registered fd
+		 * @note kqueue isn't inherited by fork() so a forked worker must create its own
+		 */
+		void IOHandler::reset() {
+			if (_poll_fd > 0) {
+				close(_poll_fd);
+			}
+			_poll_fd = kqueue();
+			if (_poll_fd == -1) {
+				throw std::runtime_error("Fail to create poll: " + std::string(std::strerror(errno)) + "\n");
+			}
+		}
+
+		/**
+		 * @brief Wait for new events, negative timeout waits forever
+		 */
+		int IOHandler::wait_for_new_event(const int& timeout_ms) {
+			struct timespec timeout;
+			timeout.tv_sec = timeout_ms / 1000;
+			timeout.tv_nsec = (timeout_ms % 1000) * 1000000;
+
+			int new_event_size = kevent(_poll_fd, NULL, 0, _event_list, 100, timeout_ms < 0 ? NULL : &timeout);
+			if (new_event_size == -1 && (errno == EINTR || g_shutdown)) {
+				return 0;
+			} else if (new_event_size == -1) {
 				throw std::runtime_error("Poll event failed: " + std::string(std::strerror(errno)) + "\n");
 			}
 
 			return new_event_size;
 		}
 
-		int IOHandler::get_triggered_fd(const int& i) {
-			return _event_list[i].ident;
+		void* IOHandler::get_triggered_data(const int& i) {
+			return _event_list[i].udata;
 		}
 
 		bool IOHandler::is_error(const int& i) {
@@ -41,11 +64,48 @@ namespace webserv {
 			return _event_list[i].filter == EVFILT_WRITE;
 		}
 
-		void IOHandler::add_fd(const int& fd) {
+		/**
+		 * @brief Accept one pending connection of socket_fd as non-blocking fd
+		 * @return client fd or -1 with errno set, EAGAIN once nothing is pending
+		 */
+		int IOHandler::accept_client(const int& i, const int& socket_fd, struct sockaddr_in* client_address) {
+			(void)i;
+			socklen_t address_len = sizeof(*client_address);
+
+			int client_fd = accept(socket_fd, (struct sockaddr*)client_address, &address_len);
+			if (client_fd != -1 && fcntl(client_fd, F_SETFL, O_NONBLOCK) == -1) {
+				close(client_fd);
+				return -1;
+			}
+
+			return client_fd;
+		}
+
+		/**
+		 * @brief Read data of triggered fd
+		 */
+		ssize_t IOHandler::receive(const int& i, const int& fd, char* buffer, const size_t& size) {
+			(void)i;
+			return recv(fd, buffer, size, 0);
+		}
+
+		/**
+		 * @brief Watch listen socket for new connection
+		 * @note exclusive has no kqueue equivalent, it's ignored
+		 */
+		void IOHandler::add_listen_fd(const int& fd, void* data, bool exclusive) {
+			(void)exclusive;
+			add_fd(fd, data);
+		}
+
+		/**
+		 * @brief Watch fd for read, data is given back by get_triggered_data
+		 */
+		void IOHandler::add_fd(const int& fd, void* data) {
 			struct kevent new_change;
 			bzero(&new_change, sizeof(new_change));
 
-			EV_SET(&new_change, fd, EVFILT_READ, EV_ADD, 0, 0, NULL);
+			EV_SET(&new_change, fd, EVFILT_READ, EV_ADD, 0, 0, data);
 			if (kevent(_poll_fd, &new_change, 1, NULL, 0, NULL) == -1) {
 				throw std::runtime_error("Failed to add fd to poll: " + std::string(std::strerror(errno)) + "\n");
 			}
@@ -61,22 +121,40 @@ namespace webserv {
 			}
 		}
 
-		void IOHandler::set_write_ready(const int& fd) {
-			struct kevent new_change;
-			bzero(&new_change, sizeof(new_change));
+		/**
+		 * @brief Watch fd for write, reading is paused until set_read_ready
+		 */
+		void IOHandler::set_write_ready(const int& fd, void* data) {
+			struct kevent new_changes[2];
+			bzero(new_changes, sizeof(new_changes));
 
-			EV_SET(&new_change, fd, EVFILT_WRITE, EV_ADD, 0, 0, NULL);
-			if (kevent(_poll_fd, &new_change, 1, NULL, 0, NULL) == -1) {
+			EV_SET(&new_changes[0], fd, EVFILT_WRITE, EV_ADD, 0, 0, data);
+			EV_SET(&new_changes[1], fd, EVFILT_READ, EV_DISABLE, 0, 0, data);
+			if (kevent(_poll_fd, new_changes, 2, NULL, 0, NULL) == -1) {
 				throw std::runtime_error("Failed to set fd to write ready to poll: " + std::string(std::strerror(errno)) + "\n");
 			}
 		}
 
+		/**
+		 * @brief Stop watching fd for write, keep it armed for read
+		 */
+		void IOHandler::set_read_ready(const int& fd, void* data) {
+			struct kevent new_changes[2];
+			bzero(new_changes, sizeof(new_changes));
+
+			EV_SET(&new_changes[0], fd, EVFILT_WRITE, EV_DELETE, 0, 0, data);
+			EV_SET(&new_changes[1], fd, EVFILT_READ, EV_ENABLE, 0, 0, data);
+			if (kevent(_poll_fd, new_changes, 2, NULL, 0, NULL) == -1) {
+				throw std::runtime_error("Failed to set fd to read ready to poll: " + std::string(std::strerror(errno)) + "\n");
+			}
+		}
+
 		/* Getters */
 		const int& IOHandler::get_poll_fd() const { return _poll_fd; }
 	} /* namespace internal */
 } /* namespace webserv */
 
-#elif __linux__
+#elif __linux__ && !defined(WEBSERV_IO_URING)
 
 namespace webserv {
 	namespace internal {
@@ -88,19 +166,36 @@ namespace webserv {
 			}
 		}
 
-		int IOHandler::wait_for_new_event() {
-			int new_event_size = epoll_wait(_poll_fd, _event_list, 100, -1);
-			if (new_event_size == 0) {
-				LOG_D() << "No new event within timeout\n";
-			} else if (new_event_size == -1 && !g_shutdown) {
+		/**
+		 * @brief Replace poll with a fresh one without any registered fd
+		 * @note A forked worker must not share the epoll instance of its parent
+		 */
+		void IOHandler::reset() {
+			if (_poll_fd > 0) {
+				close(_poll_fd);
+			}
+			_poll_fd = epoll_create(69);
+			if (_poll_fd == -1) {
+				throw std::runtime_error("Fail to create poll: " + std::string(std::strerror(errno)) + "\n");
+			}
+		}
+
+		/**
+		 * @brief Wait for new events, negative timeout waits forever
+		 */
+		int IOHandler::wait_for_new_event(const int& timeout_ms) {
+			int new_event_size = epoll_wait(_poll_fd, _event_list, 100, timeout_ms);
+			if (new_event_size == -1 && (errno == EINTR || g_shutdown)) {
+				return 0;
+			} else if (new_event_size == -1) {
 				throw std::runtime_error("Poll event failed: " + std::string(std::strerror(errno)) + "\n");
 			}
 
 			return new_event_size;
 		}
 
-		int IOHandler::get_triggered_fd(const int& i) {
-			return _event_list[i].data.fd;
+		void* IOHandler::get_triggered_data(const int& i) {
+			return _event_list[i].data.ptr;
 		}
 
 		bool IOHandler::is_error(const int& i) {
@@ -120,12 +215,57 @@ namespace webserv {
 			return (_event_list[i].events & EPOLLOUT) == EPOLLOUT;
 		}
 
-		void IOHandler::add_fd(const int& fd) {
+		/**
+		 * @brief Accept one pending connection of socket_fd as non-blocking fd
+		 * @return client fd or -1 with errno set, EAGAIN once nothing is pending
+		 */
+		int IOHandler::accept_client(const int& i, const int& socket_fd, struct sockaddr_in* client_address) {
+			(void)i;
+			socklen_t address_len = sizeof(*client_address);
+
+			return accept4(socket_fd, (struct sockaddr*)client_address, &address_len, SOCK_NONBLOCK);
+		}
+
+		/**
+		 * @brief Read data of triggered fd
+		 */
+		ssize_t IOHandler::receive(const int& i, const int& fd, char* buffer, const size_t& size) {
+			(void)i;
+			return recv(fd, buffer, size, 0);
+		}
+
+		/**
+		 * @brief Watch listen socket for new connection
+		 * @note exclusive wakes only one of the processes polling a shared listen
+		 * socket instead of all of them
+		 */
+		void IOHandler::add_listen_fd(const int& fd, void* data, bool exclusive) {
 			struct epoll_event new_change;
 			bzero(&new_change, sizeof(new_change));
 
 			new_change.events = EPOLLIN | EPOLLPRI;
-			new_change.data.fd = fd;
+#ifdef EPOLLEXCLUSIVE
+			if (exclusive) {
+				new_change.events = EPOLLIN | EPOLLEXCLUSIVE;
+			}
+#else
+			(void)exclusive;
+#endif
+			new_change.data.ptr = data;
+			if (epoll_ctl(_poll_fd, EPOLL_CTL_ADD, fd, &new_change) == -1) {
+				throw std::runtime_error("Failed to add fd to poll: " + std::string(std::strerror(errno)) + "\n");
+			}
+		}
+
+		/**
+		 * @brief Watch fd for read, data is given back by get_triggered_data
+		 */
+		void IOHandler::add_fd(const int& fd, void* data) {
+			struct epoll_event new_change;
+			bzero(&new_change, sizeof(new_change));
+
+			new_change.events = EPOLLIN | EPOLLPRI;
+			new_change.data.ptr = data;
 			if (epoll_ctl(_poll_fd, EPOLL_CTL_ADD, fd, &new_change) == -1) {
 				throw std::runtime_error("Failed to add fd to poll: " + std::string(std::strerror(errno)) + "\n");
 			}
@@ -137,17 +277,34 @@ namespace webserv {
 			}
 		}
 
-		void IOHandler::set_write_ready(const int& fd) {
+		/**
+		 * @brief Watch fd for write, reading is paused until set_read_ready
+		 */
+		void IOHandler::set_write_ready(const int& fd, void* data) {
 			struct epoll_event new_change;
 			bzero(&new_change, sizeof(new_change));
 
-			new_change.events = EPOLLOUT | EPOLLIN | EPOLLPRI;
-			new_change.data.fd = fd;
+			new_change.events = EPOLLOUT;
+			new_change.data.ptr = data;
 			if (epoll_ctl(_poll_fd, EPOLL_CTL_MOD, fd, &new_change) == -1) {
 				throw std::runtime_error("Failed to set fd to write ready to poll: " + std::string(std::strerror(errno)) + "\n");
 			}
 		}
 
+		/**
+		 * @brief Stop watching fd for write, keep it armed for read
+		 */
+		void IOHandler::set_read_ready(const int& fd, void* data) {
+			struct epoll_event new_change;
+			bzero(&new_change, sizeof(new_change));
+
+			new_change.events = EPOLLIN | EPOLLPRI;
+			new_change.data.ptr = data;
+			if (epoll_ctl(_poll_fd, EPOLL_CTL_MOD, fd, &new_change) == -1) {
+				throw std::runtime_error("Failed to set fd to read ready to poll: " + std::string(std::strerror(errno)) + "\n");
+			}
+		}
+
 		/* Getters */
 		const int& IOHandler::get_poll_fd() const { return _poll_fd; }
 	} /* namespace internal */
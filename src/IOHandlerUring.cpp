@@ -0,0 +1,642 @@
+#include "IOHandler.hpp"
+
+#if defined(__linux__) && defined(WEBSERV_IO_URING)
+
+/*
+ * io_uring backend of IOHandler, enabled with `make IO_URING=1`.
+ *
+ * Listen sockets use one multishot accept, client sockets one multishot recv
+ * filling buffers of a provided buffer ring, so accepting and reading cost no
+ * syscall per connection or per read. Write interest is a multishot poll and
+ * sending stays a plain non-blocking send() from Connection. Every arm, disarm
+ * and cancel is queued as SQE and submitted together with the next wait, which
+ * is the only io_uring_enter of an event loop iteration.
+ */
+
+#define URING_ENTRIES 256
+#define URING_CQ_ENTRIES 4096
+#define URING_MAX_EVENTS 256
+#define URING_BUFFER_COUNT 1024
+#define URING_BUFFER_GROUP 0
+
+namespace webserv {
+	namespace internal {
+		enum UringOp {
+			OP_ACCEPT = 1,
+			OP_RECV,
+			OP_POLL,
+			OP_CANCEL
+		};
+
+		/**
+		 * @brief user_data layout: fd in the low 32 bits, generation in the next 24, op on top
+		 */
+		static uint64_t make_user_data(const int& fd, const unsigned& generation, const UringOp& op) {
+			return static_cast<uint64_t>(static_cast<unsigned>(fd))
+				| (static_cast<uint64_t>(generation & 0xFFFFFF) << 32)
+				| (static_cast<uint64_t>(op) << 56);
+		}
+
+		static int user_data_fd(const uint64_t& user_data) { return static_cast<int>(user_data & 0xFFFFFFFF); }
+		static unsigned user_data_generation(const uint64_t& user_data) { return (user_data >> 32) & 0xFFFFFF; }
+		static UringOp user_data_op(const uint64_t& user_data) { return static_cast<UringOp>(user_data >> 56); }
+
+		template <typename T>
+		static T load_acquire(const T* p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+
+		template <typename T>
+		static void store_release(T* p, const T& v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+
+		IOHandler::IOHandler() :
+			_poll_fd(-1),
+			_ring(NULL),
+			_ring_size(0),
+			_sqes(NULL),
+			_sqes_size(0),
+			_sq_head(NULL),
+			_sq_tail(NULL),
+			_sq_mask(NULL),
+			_sq_array(NULL),
+			_sq_local_tail(0),
+			_sq_to_submit(0),
+			_cq_head(NULL),
+			_cq_tail(NULL),
+			_cq_mask(NULL),
+			_cqes(NULL),
+			_buf_ring(NULL),
+			_buf_ring_size(0),
+			_buffers(NULL),
+			_stash_buffer(NULL),
+			_buf_tail(0),
+			_used_buffers(),
+			_events(),
+			_fds(),
+			_stashed_fds() {
+			if (!setup_ring()) {
+				int saved_errno = errno;
+				destroy_ring();
+				errno = saved_errno;
+			}
+		}
+
+		IOHandler::~IOHandler() {
+			destroy_ring();
+		}
+
+		/**
+		 * @brief Replace ring with a fresh one without any registered fd
+		 * @note A forked worker must not share the ring of its parent
+		 */
+		void IOHandler::reset() {
+			destroy_ring();
+			_fds.clear();
+			_events.clear();
+			_used_buffers.clear();
+			_stashed_fds.clear();
+			if (!setup_ring()) {
+				std::string error(std::strerror(errno));
+				destroy_ring();
+				throw std::runtime_error("Fail to create poll: " + error + "\n");
+			}
+		}
+
+		/**
+		 * @brief Create the ring, map it and register the provided buffer ring
+		 * @return false with errno set if io_uring or a needed feature is missing
+		 */
+		bool IOHandler::setup_ring() {
+			bzero(&_params, sizeof(_params));
+			_params.flags = IORING_SETUP_CQSIZE;
+			_params.cq_entries = URING_CQ_ENTRIES;
+
+			_poll_fd = syscall(__NR_io_uring_setup, URING_ENTRIES, &_params);
+			if (_poll_fd == -1) {
+				return false;
+			}
+
+			if (!(_params.features & IORING_FEAT_SINGLE_MMAP) || !(_params.features & IORING_FEAT_EXT_ARG)
+				|| !(_params.features & IORING_FEAT_NODROP)) {
+				errno = ENOSYS;
+				return false;
+			}
+
+			size_t sq_size = _params.sq_off.array + _params.sq_entries * sizeof(unsigned);
+			size_t cq_size = _params.cq_off.cqes + _params.cq_entries * sizeof(struct io_uring_cqe);
+			_ring_size = sq_size > cq_size ? sq_size : cq_size;
+
+			void* ring = mmap(NULL, _ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _poll_fd, IORING_OFF_SQ_RING);
+			if (ring == MAP_FAILED) {
+				return false;
+			}
+			_ring = static_cast<char*>(ring);
+
+			_sqes_size = _params.sq_entries * sizeof(struct io_uring_sqe);
+			void* sqes = mmap(NULL, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _poll_fd, IORING_OFF_SQES);
+			if (sqes == MAP_FAILED) {
+				return false;
+			}
+			_sqes = static_cast<struct io_uring_sqe*>(sqes);
+
+			_sq_head = reinterpret_cast<unsigned*>(_ring + _params.sq_off.head);
+			_sq_tail = reinterpret_cast<unsigned*>(_ring + _params.sq_off.tail);
+			_sq_mask = reinterpret_cast<unsigned*>(_ring + _params.sq_off.ring_mask);
+			_sq_array = reinterpret_cast<unsigned*>(_ring + _params.sq_off.array);
+			_sq_local_tail = *_sq_tail;
+			_sq_to_submit = 0;
+			_cq_head = reinterpret_cast<unsigned*>(_ring + _params.cq_off.head);
+			_cq_tail = reinterpret_cast<unsigned*>(_ring + _params.cq_off.tail);
+			_cq_mask = reinterpret_cast<unsigned*>(_ring + _params.cq_off.ring_mask);
+			_cqes = reinterpret_cast<struct io_uring_cqe*>(_ring + _params.cq_off.cqes);
+
+			/* provided buffer ring, the kernel picks a buffer for each received chunk */
+			_buf_ring_size = URING_BUFFER_COUNT * sizeof(struct io_uring_buf);
+			void* buf_ring = mmap(NULL, _buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (buf_ring == MAP_FAILED) {
+				return false;
+			}
+			_buf_ring = static_cast<struct io_uring_buf_ring*>(buf_ring);
+
+			_buffers = new char[URING_BUFFER_COUNT * READ_BUFFER];
+			_stash_buffer = new char[URING_MAX_EVENTS * READ_BUFFER];
+
+			struct io_uring_buf_reg reg;
+			bzero(&reg, sizeof(reg));
+			reg.ring_addr = reinterpret_cast<uintptr_t>(_buf_ring);
+			reg.ring_entries = URING_BUFFER_COUNT;
+			reg.bgid = URING_BUFFER_GROUP;
+			if (syscall(__NR_io_uring_register, _poll_fd, IORING_REGISTER_PBUF_RING, &reg, 1) == -1) {
+				return false;
+			}
+
+			_buf_tail = 0;
+			for (unsigned short bid = 0; bid < URING_BUFFER_COUNT; ++bid) {
+				_used_buffers.push_back(bid);
+			}
+			recycle_buffers();
+
+			_events.reserve(URING_MAX_EVENTS);
+			return true;
+		}
+
+		void IOHandler::destroy_ring() {
+			if (_sqes != NULL) {
+				munmap(_sqes, _sqes_size);
+				_sqes = NULL;
+			}
+			if (_ring != NULL) {
+				munmap(_ring, _ring_size);
+				_ring = NULL;
+			}
+			if (_buf_ring != NULL) {
+				munmap(_buf_ring, _buf_ring_size);
+				_buf_ring = NULL;
+			}
+			delete[] _buffers;
+			_buffers = NULL;
+			delete[] _stash_buffer;
+			_stash_buffer = NULL;
+			if (_poll_fd > 0) {
+				close(_poll_fd);
+			}
+			_poll_fd = -1;
+		}
+
+		UringFdState& IOHandler::get_fd_state(const int& fd) {
+			if (static_cast<size_t>(fd) >= _fds.size()) {
+				UringFdState state;
+				state.generation = 0;
+				state.udata = NULL;
+				state.listener = false;
+				state.reading = false;
+				state.accept_armed = false;
+				state.recv_armed = false;
+				state.poll_armed = false;
+				state.stash_eof = false;
+				_fds.resize(fd + 1, state);
+			}
+			return _fds[fd];
+		}
+
+		/**
+		 * @brief Get the next free SQE, submit queued ones first if SQ is full
+		 */
+		struct io_uring_sqe* IOHandler::get_sqe() {
+			if (_sq_local_tail - load_acquire(_sq_head) >= _params.sq_entries) {
+				enter(0, 0);
+			}
+
+			unsigned index = _sq_local_tail & *_sq_mask;
+			struct io_uring_sqe* sqe = &_sqes[index];
+			bzero(sqe, sizeof(*sqe));
+			_sq_array[index] = index;
+			++_sq_local_tail;
+			++_sq_to_submit;
+			return sqe;
+		}
+
+		/**
+		 * @brief Submit queued SQEs and wait for min_complete completions
+		 * @return -1 on failure other than timeout or signal
+		 */
+		int IOHandler::enter(const unsigned& min_complete, const int& timeout_ms) {
+			struct __kernel_timespec timeout;
+			struct io_uring_getevents_arg arg;
+			bzero(&arg, sizeof(arg));
+
+			if (timeout_ms >= 0) {
+				timeout.tv_sec = timeout_ms / 1000;
+				timeout.tv_nsec = (timeout_ms % 1000) * 1000000;
+				arg.ts = reinterpret_cast<uintptr_t>(&timeout);
+			}
+
+			store_release(_sq_tail, _sq_local_tail);
+
+			unsigned flags = IORING_ENTER_EXT_ARG;
+			if (min_complete > 0) {
+				flags |= IORING_ENTER_GETEVENTS;
+			}
+
+			int ret = syscall(__NR_io_uring_enter, _poll_fd, _sq_to_submit, min_complete, flags, &arg, sizeof(arg));
+			if (ret >= 0) {
+				_sq_to_submit -= ret < static_cast<int>(_sq_to_submit) ? ret : _sq_to_submit;
+				return ret;
+			}
+
+			if (errno == ETIME || errno == EINTR || errno == EBUSY) {
+				return 0;
+			}
+			return -1;
+		}
+
+		/**
+		 * @brief Wait for new events, negative timeout waits forever
+		 * @note Completions of the previous call are released here, their data
+		 * pointers are invalid afterward
+		 */
+		int IOHandler::wait_for_new_event(const int& timeout_ms) {
+			recycle_buffers();
+			_events.clear();
+			report_stashes();
+
+			bool has_completion = load_acquire(_cq_tail) != *_cq_head;
+			unsigned min_complete = (_events.empty() && !has_completion) ? 1 : 0;
+
+			if (enter(min_complete, timeout_ms) == -1 && !g_shutdown) {
+				throw std::runtime_error("Poll event failed: " + std::string(std::strerror(errno)) + "\n");
+			}
+
+			unsigned head = *_cq_head;
+			unsigned tail = load_acquire(_cq_tail);
+			for (; head != tail && _events.size() < URING_MAX_EVENTS; ++head) {
+				handle_completion(_cqes[head & *_cq_mask]);
+			}
+			store_release(_cq_head, head);
+
+			return _events.size();
+		}
+
+		/**
+		 * @brief Turn one CQE into events and re-arm multishot requests the kernel ended
+		 */
+		void IOHandler::handle_completion(const struct io_uring_cqe& cqe) {
+			UringOp op = user_data_op(cqe.user_data);
+			int fd = user_data_fd(cqe.user_data);
+			bool more = cqe.flags & IORING_CQE_F_MORE;
+			const char* data = NULL;
+
+			if (cqe.flags & IORING_CQE_F_BUFFER) {
+				unsigned short bid = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+				data = _buffers + static_cast<size_t>(bid) * READ_BUFFER;
+				_used_buffers.push_back(bid);
+			}
+
+			if (op == OP_CANCEL || static_cast<size_t>(fd) >= _fds.size()
+				|| user_data_generation(cqe.user_data) != (_fds[fd].generation & 0xFFFFFF)) {
+				return;
+			}
+			UringFdState& state = _fds[fd];
+
+			switch (op) {
+				case OP_ACCEPT:
+					state.accept_armed = more;
+					if (cqe.res >= 0) {
+						push_event(fd, URING_ACCEPT, cqe.res, NULL, 0);
+					}
+					if (!state.accept_armed && state.listener) {
+						arm_accept(fd);
+					}
+					break;
+				case OP_RECV:
+					state.recv_armed = more;
+					if (cqe.res > 0 && state.reading && state.stash.empty()) {
+						push_event(fd, URING_READ, cqe.res, data, cqe.res);
+					} else if (cqe.res > 0) {
+						state.stash.append(data, cqe.res);
+					} else if (cqe.res == 0 && state.reading && state.stash.empty()) {
+						push_event(fd, URING_EOF, 0, NULL, 0);
+					} else if (cqe.res == 0) {
+						state.stash_eof = true;
+					} else if (cqe.res != -ECANCELED && cqe.res != -ENOBUFS) {
+						push_event(fd, URING_ERROR, cqe.res, NULL, 0);
+						break;
+					}
+					if (!state.recv_armed && state.reading && cqe.res != 0) {
+						arm_recv(fd);
+					}
+					break;
+				case OP_POLL:
+					state.poll_armed = more;
+					if (cqe.res < 0 || state.reading) {
+						break;
+					}
+					if (cqe.res & POLLERR) {
+						push_event(fd, URING_ERROR, cqe.res, NULL, 0);
+					} else if (cqe.res & POLLHUP) {
+						push_event(fd, URING_EOF, 0, NULL, 0);
+					} else if (cqe.res & POLLOUT) {
+						push_event(fd, URING_WRITE, cqe.res, NULL, 0);
+					}
+					if (!state.poll_armed) {
+						arm_write_poll(fd);
+					}
+					break;
+				default:
+					break;
+			}
+		}
+
+		void IOHandler::push_event(const int& fd, const UringEventType& type, const int& res, const char* data, const size_t& size) {
+			UringEvent event;
+			event.fd = fd;
+			event.udata = _fds[fd].udata;
+			event.type = type;
+			event.res = res;
+			event.data = data;
+			event.size = size;
+			_events.push_back(event);
+		}
+
+		/**
+		 * @brief Report data received while fd was waiting for write
+		 * @note At most READ_BUFFER bytes per fd and wait, the rest stays stashed
+		 * so that new completions keep being appended behind it in order
+		 */
+		void IOHandler::report_stashes() {
+			std::vector<int> stashed_fds;
+			stashed_fds.swap(_stashed_fds);
+
+			size_t reported = 0;
+			for (size_t i = 0; i < stashed_fds.size(); ++i) {
+				int fd = stashed_fds[i];
+				if (static_cast<size_t>(fd) >= _fds.size() || !_fds[fd].reading) {
+					continue;
+				}
+
+				UringFdState& state = _fds[fd];
+				if (!state.stash.empty() && reported < URING_MAX_EVENTS) {
+					char* data = _stash_buffer + reported * READ_BUFFER;
+					size_t size = state.stash.copy(data, READ_BUFFER);
+					state.stash.erase(0, size);
+					push_event(fd, URING_READ, size, data, size);
+					++reported;
+					if (!state.stash.empty() || state.stash_eof) {
+						_stashed_fds.push_back(fd);
+					}
+				} else if (!state.stash.empty()) {
+					_stashed_fds.push_back(fd);
+				} else if (state.stash_eof) {
+					push_event(fd, URING_EOF, 0, NULL, 0);
+				}
+			}
+		}
+
+		/**
+		 * @brief Give consumed buffers back to the kernel in one tail update
+		 */
+		void IOHandler::recycle_buffers() {
+			if (_used_buffers.empty()) {
+				return;
+			}
+
+			/* bufs is declared with an empty struct in front, which isn't empty in C++ */
+			struct io_uring_buf* bufs = reinterpret_cast<struct io_uring_buf*>(_buf_ring);
+			unsigned short mask = URING_BUFFER_COUNT - 1;
+			for (size_t i = 0; i < _used_buffers.size(); ++i) {
+				struct io_uring_buf* buf = &bufs[(_buf_tail + i) & mask];
+				buf->addr = reinterpret_cast<uintptr_t>(_buffers + static_cast<size_t>(_used_buffers[i]) * READ_BUFFER);
+				buf->len = READ_BUFFER;
+				buf->bid = _used_buffers[i];
+			}
+			_buf_tail += _used_buffers.size();
+			store_release(&_buf_ring->tail, _buf_tail);
+			_used_buffers.clear();
+		}
+
+		void IOHandler::arm_accept(const int& fd) {
+			UringFdState& state = get_fd_state(fd);
+			struct io_uring_sqe* sqe = get_sqe();
+
+			sqe->opcode = IORING_OP_ACCEPT;
+			sqe->fd = fd;
+			sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+			sqe->accept_flags = SOCK_NONBLOCK;
+			sqe->user_data = make_user_data(fd, state.generation, OP_ACCEPT);
+			state.accept_armed = true;
+		}
+
+		void IOHandler::arm_recv(const int& fd) {
+			UringFdState& state = get_fd_state(fd);
+			struct io_uring_sqe* sqe = get_sqe();
+
+			sqe->opcode = IORING_OP_RECV;
+			sqe->fd = fd;
+			sqe->ioprio = IORING_RECV_MULTISHOT;
+			sqe->flags = IOSQE_BUFFER_SELECT;
+			sqe->buf_group = URING_BUFFER_GROUP;
+			sqe->user_data = make_user_data(fd, state.generation, OP_RECV);
+			state.recv_armed = true;
+		}
+
+		void IOHandler::arm_write_poll(const int& fd) {
+			UringFdState& state = get_fd_state(fd);
+			struct io_uring_sqe* sqe = get_sqe();
+
+			sqe->opcode = IORING_OP_POLL_ADD;
+			sqe->fd = fd;
+			sqe->len = IORING_POLL_ADD_MULTI;
+			sqe->poll32_events = POLLOUT;
+			sqe->user_data = make_user_data(fd, state.generation, OP_POLL);
+			state.poll_armed = true;
+		}
+
+		/**
+		 * @brief Cancel the request identified by user_data
+		 */
+		void IOHandler::cancel(const uint64_t& user_data) {
+			struct io_uring_sqe* sqe = get_sqe();
+
+			sqe->opcode = IORING_OP_ASYNC_CANCEL;
+			sqe->fd = -1;
+			sqe->addr = user_data;
+			sqe->user_data = make_user_data(-1, 0, OP_CANCEL);
+		}
+
+		void* IOHandler::get_triggered_data(const int& i) {
+			return _events[i].udata;
+		}
+
+		bool IOHandler::is_error(const int& i) {
+			return _events[i].type == URING_ERROR;
+		}
+
+		bool IOHandler::is_eof(const int& i) {
+			return _events[i].type == URING_EOF;
+		}
+
+		bool IOHandler::is_read_ready(const int& i) {
+			return _events[i].type == URING_READ || _events[i].type == URING_ACCEPT;
+		}
+
+		bool IOHandler::is_write_ready(const int& i) {
+			return _events[i].type == URING_WRITE;
+		}
+
+		/**
+		 * @brief Return the fd accepted by the multishot accept of event i
+		 * @return client fd the first time, then -1 with errno EAGAIN
+		 */
+		int IOHandler::accept_client(const int& i, const int& socket_fd, struct sockaddr_in* client_address) {
+			UringEvent& event = _events[i];
+
+			if (event.type != URING_ACCEPT || event.fd != socket_fd || event.res < 0) {
+				errno = EAGAIN;
+				return -1;
+			}
+
+			int client_fd = event.res;
+			event.res = -1;
+
+			socklen_t address_len = sizeof(*client_address);
+			getpeername(client_fd, (struct sockaddr*)client_address, &address_len);
+			return client_fd;
+		}
+
+		/**
+		 * @brief Copy data received in event i
+		 * @return size copied or -1 with errno EAGAIN if event has no data left
+		 * @note Bytes that don't fit in buffer are stashed and reported next wait
+		 */
+		ssize_t IOHandler::receive(const int& i, const int& fd, char* buffer, const size_t& size) {
+			UringEvent& event = _events[i];
+
+			if (event.type != URING_READ || event.fd != fd || event.size == 0) {
+				errno = EAGAIN;
+				return -1;
+			}
+
+			size_t copy_size = event.size < size ? event.size : size;
+			std::memcpy(buffer, event.data, copy_size);
+
+			if (copy_size < event.size) {
+				UringFdState& state = _fds[fd];
+				state.stash.insert(0, event.data + copy_size, event.size - copy_size);
+				_stashed_fds.push_back(fd);
+			}
+			event.size = 0;
+			return copy_size;
+		}
+
+		/**
+		 * @brief Watch listen socket with a multishot accept
+		 * @note The kernel wakes a single io_uring accept per connection, so
+		 * exclusive needs no extra flag
+		 */
+		void IOHandler::add_listen_fd(const int& fd, void* data, bool exclusive) {
+			(void)exclusive;
+			UringFdState& state = get_fd_state(fd);
+			state.udata = data;
+			state.listener = true;
+			arm_accept(fd);
+		}
+
+		/**
+		 * @brief Watch client fd with a multishot recv, data is given back by get_triggered_data
+		 */
+		void IOHandler::add_fd(const int& fd, void* data) {
+			UringFdState& state = get_fd_state(fd);
+			state.udata = data;
+			state.listener = false;
+			state.reading = true;
+			state.stash.clear();
+			state.stash_eof = false;
+			arm_recv(fd);
+		}
+
+		/**
+		 * @brief Cancel every request of fd, late completions are dropped by generation
+		 */
+		void IOHandler::remove_fd(const int& fd) {
+			UringFdState& state = get_fd_state(fd);
+
+			if (state.accept_armed) {
+				cancel(make_user_data(fd, state.generation, OP_ACCEPT));
+			}
+			if (state.recv_armed) {
+				cancel(make_user_data(fd, state.generation, OP_RECV));
+			}
+			if (state.poll_armed) {
+				cancel(make_user_data(fd, state.generation, OP_POLL));
+			}
+
+			++state.generation;
+			state.udata = NULL;
+			state.listener = false;
+			state.reading = false;
+			state.accept_armed = false;
+			state.recv_armed = false;
+			state.poll_armed = false;
+			state.stash.clear();
+			state.stash_eof = false;
+		}
+
+		/**
+		 * @brief Watch fd for write, reading is paused until set_read_ready
+		 */
+		void IOHandler::set_write_ready(const int& fd, void* data) {
+			UringFdState& state = get_fd_state(fd);
+			state.udata = data;
+
+			state.reading = false;
+			if (state.recv_armed) {
+				cancel(make_user_data(fd, state.generation, OP_RECV));
+			}
+			if (!state.poll_armed) {
+				arm_write_poll(fd);
+			}
+		}
+
+		/**
+		 * @brief Stop watching fd for write, keep it armed for read
+		 */
+		void IOHandler::set_read_ready(const int& fd, void* data) {
+			UringFdState& state = get_fd_state(fd);
+			state.udata = data;
+
+			state.reading = true;
+			if (state.poll_armed) {
+				cancel(make_user_data(fd, state.generation, OP_POLL));
+			}
+			if (!state.recv_armed) {
+				arm_recv(fd);
+			}
+			if (!state.stash.empty() || state.stash_eof) {
+				_stashed_fds.push_back(fd);
+			}
+		}
+
+		/* Getters */
+		const int& IOHandler::get_poll_fd() const { return _poll_fd; }
+	} /* namespace internal */
+} /* namespace webserv */
+
+#endif
@@ -3,34 +3,61 @@
 namespace webserv {
 	LocationConfig::LocationConfig() :
 		_location(""),
+		_match(LOCATION_PREFIX),
 		_root(""),
 		_index(""),
 		_allow_methods(),
 		_cgi_path(""),
 		_cgi_extension(""),
 		_autoindex(false),
-		_redirect() {}
+		_etag(true),
+		_gzip_static(false),
+		_brotli_static(false),
+		_gzip(false),
+		_gzip_types(),
+		_gzip_min_length(-1),
+		_gzip_comp_level(-1),
+		_redirect(),
+		_types() {}
 
 	LocationConfig::LocationConfig(const LocationConfig& copy) :
 		_location(copy._location),
+		_match(copy._match),
 		_root(copy._root),
 		_index(copy._index),
 		_allow_methods(copy._allow_methods),
 		_cgi_path(copy._cgi_path),
 		_cgi_extension(copy._cgi_extension),
 		_autoindex(copy._autoindex),
-		_redirect(copy._redirect) {}
+		_etag(copy._etag),
+		_gzip_static(copy._gzip_static),
+		_brotli_static(copy._brotli_static),
+		_gzip(copy._gzip),
+		_gzip_types(copy._gzip_types),
+		_gzip_min_length(copy._gzip_min_length),
+		_gzip_comp_level(copy._gzip_comp_level),
+		_redirect(copy._redirect),
+		_types(copy._types) {}
 
 	LocationConfig& LocationConfig::operator=(const LocationConfig& other) {
 		if (this == &other) { return *this; }
 		_location = other._location;
+		_match = other._match;
 		_root = other._root;
 		_index = other._index;
 		_allow_methods = other._allow_methods;
 		_cgi_path = other._cgi_path;
 		_cgi_extension = other._cgi_extension;
 		_autoindex = other._autoindex;
+		_etag = other._etag;
+		_gzip_static = other._gzip_static;
+		_brotli_static = other._brotli_static;
+		_gzip = other._gzip;
+		_gzip_types = other._gzip_types;
+		_gzip_min_length = other._gzip_min_length;
+		_gzip_comp_level = other._gzip_comp_level;
 		_redirect = other._redirect;
+		_types = other._types;
 		return *this;
 	}
 
@@ -47,7 +74,15 @@ namespace webserv {
 		types.insert("cgi_path");
 		types.insert("cgi_extension");
 		types.insert("autoindex");
+		types.insert("etag");
+		types.insert("gzip_static");
+		types.insert("brotli_static");
+		types.insert("gzip");
+		types.insert("gzip_types");
+		types.insert("gzip_min_length");
+		types.insert("gzip_comp_level");
 		types.insert("redirect");
+		types.insert("types");
 	}
 
 	/**
@@ -57,7 +92,7 @@ namespace webserv {
 	 */
 	bool LocationConfig::set_config(const std::string& type, const std::string& value) {
 		if (type == "location" && _location.empty()) {
-			_location = value;
+			return set_location(value);
 		} else if (type == "root" && _root.empty()) {
 			_root = value;
 		} else if (type == "index" && _index.empty()) {
@@ -69,7 +104,21 @@ namespace webserv {
 		} else if (type == "cgi_extension" && _cgi_extension.empty()) {
 			_cgi_extension = value;
 		} else if (type == "autoindex") {
-			return set_autoindex(value);
+			return set_flag(value, _autoindex);
+		} else if (type == "etag") {
+			return set_flag(value, _etag);
+		} else if (type == "gzip_static") {
+			return set_flag(value, _gzip_static);
+		} else if (type == "brotli_static") {
+			return set_flag(value, _brotli_static);
+		} else if (type == "gzip") {
+			return set_flag(value, _gzip);
+		} else if (type == "gzip_types") {
+			return _gzip_types.insert(value).second;
+		} else if (type == "gzip_min_length" && _gzip_min_length == -1 && is_digits(value) && value[0] != '-') {
+			_gzip_min_length = std::atoi(value.c_str());
+		} else if (type == "gzip_comp_level" && _gzip_comp_level == -1 && value.size() == 1 && value[0] >= '1' && value[0] <= '9') {
+			_gzip_comp_level = value[0] - '0';
 		} else if (type == "redirect" && _redirect.empty()) {
 			_redirect = value;
 		} else {
@@ -97,9 +146,53 @@ namespace webserv {
 			}
 		}
 
+		// Like nginx, text/html is always compressed with gzip on
+		_gzip_types.insert("text/html");
+
+		if (_gzip_min_length == -1) {
+			_gzip_min_length = 20;
+		}
+
+		if (_gzip_comp_level == -1) {
+			_gzip_comp_level = 1;
+		}
+
 		return true;
 	}
 
+	/**
+	 * @brief Set the modifier, then the uri or pattern of the location
+	 * @note Like nginx "=" is exact, "^~" a prefix that skips patterns, "~" and
+	 * "~*" regexes. A prefix with '*' or '?' is a glob.
+	 * @return false if the pattern isn't valid
+	 */
+	bool LocationConfig::set_location(const std::string& value) {
+		if (_match == LOCATION_PREFIX) {
+			for (int match = LOCATION_PREFIX_NO_PATTERNS; match <= LOCATION_REGEX_CASELESS; ++match) {
+				if (value == LocationModifierStrings[match]) {
+					_match = static_cast<LocationMatch>(match);
+					return true;
+				}
+			}
+		}
+
+		_location = value;
+		if (_match == LOCATION_PREFIX && value.find_first_of("*?") != std::string::npos) {
+			_match = LOCATION_GLOB;
+		}
+
+		switch (_match) {
+			case LOCATION_REGEX:
+				return LocationPatterns::is_valid(value, PATTERN_REGEX);
+			case LOCATION_REGEX_CASELESS:
+				return LocationPatterns::is_valid(value, PATTERN_REGEX_CASELESS);
+			case LOCATION_GLOB:
+				return LocationPatterns::is_valid(value, PATTERN_GLOB);
+			default:
+				return true;
+		}
+	}
+
 	/**
 	 * @brief Check if method is valid and add method to allow_methods
 	 */
@@ -120,14 +213,27 @@ namespace webserv {
 	}
 
 	/**
-	 * @brief Check autoindex is valid and set it
+	 * @brief Set types block of location config
+	 * @return false if types were already set
 	 */
-	bool LocationConfig::set_autoindex(const std::string& value) {
+	bool LocationConfig::set_types(const MimeTypes& types) {
+		if (!_types.empty()) {
+			return false;
+		}
+		_types = types;
+		return true;
+	}
+
+	/**
+	 * @brief Check an on|off value is valid and set flag, autoindex, etag,
+	 * gzip_static or brotli_static
+	 */
+	bool LocationConfig::set_flag(const std::string& value, bool& flag) {
 		if (value == "on") {
-			_autoindex = true;
+			flag = true;
 			return true;
 		} else if (value == "off") {
-			_autoindex = false;
+			flag = false;
 			return true;
 		}
 
@@ -136,17 +242,32 @@ namespace webserv {
 
 	/* Getters */
 	const std::string& LocationConfig::get_location() const { return _location; }
+	const LocationMatch& LocationConfig::get_match() const { return _match; }
+	bool LocationConfig::is_prefix() const { return _match == LOCATION_PREFIX || _match == LOCATION_PREFIX_NO_PATTERNS; }
+	bool LocationConfig::is_pattern() const { return _match >= LOCATION_REGEX; }
 	const std::string& LocationConfig::get_root() const { return _root; }
 	const std::string& LocationConfig::get_index() const { return _index; }
 	const std::set<std::string>& LocationConfig::get_allow_methods() const { return _allow_methods; }
 	const std::string& LocationConfig::get_cgi_path() const { return _cgi_path; }
 	const bool& LocationConfig::get_autoindex() const { return _autoindex; }
+	const bool& LocationConfig::get_etag() const { return _etag; }
+	const bool& LocationConfig::get_gzip_static() const { return _gzip_static; }
+	const bool& LocationConfig::get_brotli_static() const { return _brotli_static; }
+	const bool& LocationConfig::get_gzip() const { return _gzip; }
+	const std::set<std::string>& LocationConfig::get_gzip_types() const { return _gzip_types; }
+	const int& LocationConfig::get_gzip_min_length() const { return _gzip_min_length; }
+	const int& LocationConfig::get_gzip_comp_level() const { return _gzip_comp_level; }
 	const std::string& LocationConfig::get_cgi_extension() const { return _cgi_extension; }
 	const std::string& LocationConfig::get_redirect() const { return _redirect; }
+	const MimeTypes& LocationConfig::get_types() const { return _types; }
 
 #ifdef PARSER_DEBUG
 	std::ostream& operator<<(std::ostream& os, const LocationConfig& location_config) {
-		os << "\tlocation " << location_config.get_location() << " {\n";
+		os << "\tlocation ";
+		if (*LocationModifierStrings[location_config.get_match()] != '\0') {
+			os << LocationModifierStrings[location_config.get_match()] << " ";
+		}
+		os << location_config.get_location() << " {\n";
 
 		os << "\t\troot " << location_config.get_root() << ";\n";
 		os << "\t\tindex " << location_config.get_index() << ";\n";
@@ -158,6 +279,23 @@ namespace webserv {
 		os << ";\n";
 
 		os << "\t\tcgi_path " << location_config.get_cgi_path() << ";\n";
+		os << "\t\tetag " << (location_config.get_etag() ? "on" : "off") << ";\n";
+		os << "\t\tgzip_static " << (location_config.get_gzip_static() ? "on" : "off") << ";\n";
+		os << "\t\tbrotli_static " << (location_config.get_brotli_static() ? "on" : "off") << ";\n";
+		os << "\t\tgzip " << (location_config.get_gzip() ? "on" : "off") << ";\n";
+
+		os << "\t\tgzip_types";
+		for (std::set<std::string>::const_iterator _it = location_config.get_gzip_types().begin();
+			_it != location_config.get_gzip_types().end(); ++_it)
+			os << " " << *_it;
+		os << ";\n";
+
+		os << "\t\tgzip_min_length " << location_config.get_gzip_min_length() << ";\n";
+		os << "\t\tgzip_comp_level " << location_config.get_gzip_comp_level() << ";\n";
+
+		if (!location_config.get_types().empty()) {
+			os << location_config.get_types();
+		}
 
 		os << "\t}\n";
 		return os;
@@ -0,0 +1,668 @@
+#include "LocationPatterns.hpp"
+
+#include <map>
+#include <algorithm>
+#include <stdexcept>
+#include <cctype>
+#include <cstring>
+#include <cstdlib>
+
+#define LOCATION_PATTERNS_REPEAT_LIMIT 255 /* largest m and n of {m,n} */
+
+namespace webserv {
+	LocationPatterns::LocationPatterns() :
+		_nodes(),
+		_sets(),
+		_starts(),
+		_byte_classes(),
+		_class_count(0),
+		_transitions(),
+		_accepts(),
+		_end_accepts() {}
+
+	LocationPatterns::LocationPatterns(const LocationPatterns& copy) :
+		_nodes(copy._nodes),
+		_sets(copy._sets),
+		_starts(copy._starts),
+		_byte_classes(copy._byte_classes),
+		_class_count(copy._class_count),
+		_transitions(copy._transitions),
+		_accepts(copy._accepts),
+		_end_accepts(copy._end_accepts) {}
+
+	LocationPatterns& LocationPatterns::operator=(const LocationPatterns& other) {
+		if (this == &other) { return *this; }
+		_nodes = other._nodes;
+		_sets = other._sets;
+		_starts = other._starts;
+		_byte_classes = other._byte_classes;
+		_class_count = other._class_count;
+		_transitions = other._transitions;
+		_accepts = other._accepts;
+		_end_accepts = other._end_accepts;
+		return *this;
+	}
+
+	LocationPatterns::~LocationPatterns() {}
+
+	/**
+	 * @brief Check pattern is in the supported syntax, without adding it
+	 */
+	bool LocationPatterns::is_valid(const std::string& pattern, PatternSyntax syntax) {
+		LocationPatterns patterns;
+		Fragment fragment;
+
+		return patterns.parse(pattern, syntax, fragment);
+	}
+
+	/**
+	 * @brief Add pattern, its index is the number of patterns added before it
+	 * @note Takes effect on the next compile
+	 * @exception Throw runtime_error if pattern isn't valid
+	 */
+	void LocationPatterns::add(const std::string& pattern, PatternSyntax syntax) {
+		Fragment fragment;
+		if (!parse(pattern, syntax, fragment)) {
+			throw std::runtime_error("Invalid location pattern: " + pattern);
+		}
+
+		_nodes[fragment.end].next = add_node(NODE_MATCH, -1, _starts.size());
+		_starts.push_back(fragment.start);
+	}
+
+	/**
+	 * @brief Build the DFA of all patterns added
+	 * @note Every state holds the start of the unanchored patterns, which is how
+	 * they're searched anywhere in the path
+	 * @exception Throw runtime_error if the DFA would have too many states
+	 */
+	void LocationPatterns::compile() {
+		split_byte_classes();
+		_transitions.clear();
+		_accepts.clear();
+		_end_accepts.clear();
+
+		std::vector<int> representatives(_class_count, -1);
+		for (int byte = 0; byte < 256; ++byte) {
+			if (representatives[_byte_classes[byte]] == -1) {
+				representatives[_byte_classes[byte]] = byte;
+			}
+		}
+
+		std::map<std::vector<int>, int> ids;
+		std::vector<std::vector<int> > states;
+		std::vector<int> marks(_nodes.size(), 0);
+		int mark = 0;
+
+		std::vector<int> seeds(_starts);
+		states.push_back(std::vector<int>());
+		closure(seeds, true, states.back(), marks, ++mark);
+		ids[states.back()] = 0;
+		_accepts.push_back(accept_of(states.back()));
+
+		for (size_t i = 0; i < states.size(); ++i) {
+			_transitions.resize((i + 1) * _class_count);
+
+			for (size_t byte_class = 0; byte_class < _class_count; ++byte_class) {
+				seeds = _starts;
+				for (size_t j = 0; j < states[i].size(); ++j) {
+					const Node& node = _nodes[states[i][j]];
+					if (node.type == NODE_BYTES && _sets[node.alt].test(representatives[byte_class])) {
+						seeds.push_back(node.next);
+					}
+				}
+
+				std::vector<int> target;
+				closure(seeds, false, target, marks, ++mark);
+				std::map<std::vector<int>, int>::iterator it = ids.find(target);
+				if (it == ids.end()) {
+					if (states.size() >= LOCATION_PATTERNS_STATE_LIMIT) {
+						throw std::runtime_error("Too many states in the location patterns of a server");
+					}
+					it = ids.insert(std::make_pair(target, static_cast<int>(states.size()))).first;
+					states.push_back(target);
+					_accepts.push_back(accept_of(target));
+				}
+				_transitions[i * _class_count + byte_class] = it->second;
+			}
+
+			// "$" only passes at the end of the path, seen once after its last byte
+			seeds.clear();
+			for (size_t j = 0; j < states[i].size(); ++j) {
+				const Node& node = _nodes[states[i][j]];
+				if (node.type == NODE_END) {
+					seeds.push_back(node.next);
+				}
+			}
+			std::vector<int> end_state;
+			closure(seeds, false, end_state, marks, ++mark);
+			_end_accepts.push_back(accept_of(end_state));
+		}
+	}
+
+	void LocationPatterns::clear() {
+		_nodes.clear();
+		_sets.clear();
+		_starts.clear();
+		_byte_classes.clear();
+		_class_count = 0;
+		_transitions.clear();
+		_accepts.clear();
+		_end_accepts.clear();
+	}
+
+	/**
+	 * @brief First pattern added that matches path
+	 * @return index of the pattern or -1 if none matches
+	 */
+	int LocationPatterns::match(const char* path, size_t size) const {
+		if (_accepts.empty()) {
+			return -1;
+		}
+
+		int state = 0;
+		int first = _accepts[0];
+		for (size_t i = 0; i < size && first != 0; ++i) {
+			state = _transitions[state * _class_count + _byte_classes[static_cast<unsigned char>(path[i])]];
+			if (_accepts[state] != -1 && (first == -1 || _accepts[state] < first)) {
+				first = _accepts[state];
+			}
+		}
+		if (_end_accepts[state] != -1 && (first == -1 || _end_accepts[state] < first)) {
+			first = _end_accepts[state];
+		}
+		return first;
+	}
+
+	/* Getters */
+	size_t LocationPatterns::get_pattern_count() const { return _starts.size(); }
+	size_t LocationPatterns::get_state_count() const { return _accepts.size(); }
+
+	/**
+	 * @brief Parse pattern into a fragment of new nodes, nothing is added on failure
+	 */
+	bool LocationPatterns::parse(const std::string& pattern, PatternSyntax syntax, Fragment& fragment) {
+		size_t node_count = _nodes.size();
+		size_t set_count = _sets.size();
+		Cursor cursor;
+		cursor.pattern = &pattern;
+		cursor.pos = 0;
+		cursor.caseless = syntax == PATTERN_REGEX_CASELESS;
+		cursor.first_node = node_count;
+
+		bool parsed = syntax == PATTERN_GLOB ? parse_glob(cursor, fragment) : parse_alternation(cursor, fragment);
+		if (!parsed || cursor.pos != pattern.size() || _nodes.size() - node_count > LOCATION_PATTERNS_NODE_LIMIT) {
+			_nodes.resize(node_count);
+			_sets.resize(set_count);
+			return false;
+		}
+		return true;
+	}
+
+	bool LocationPatterns::parse_alternation(Cursor& cursor, Fragment& fragment) {
+		if (!parse_concatenation(cursor, fragment)) {
+			return false;
+		}
+
+		const std::string& pattern = *cursor.pattern;
+		while (cursor.pos < pattern.size() && pattern[cursor.pos] == '|') {
+			++cursor.pos;
+			Fragment other;
+			if (!parse_concatenation(cursor, other)) {
+				return false;
+			}
+			fragment = alternate(fragment, other);
+		}
+		return true;
+	}
+
+	bool LocationPatterns::parse_concatenation(Cursor& cursor, Fragment& fragment) {
+		const std::string& pattern = *cursor.pattern;
+
+		fragment = empty_fragment();
+		while (cursor.pos < pattern.size() && pattern[cursor.pos] != '|' && pattern[cursor.pos] != ')') {
+			Fragment part;
+			if (!parse_repetition(cursor, part)) {
+				return false;
+			}
+			fragment = concatenate(fragment, part);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Atom and its quantifier, {m,n} parses the atom again for every copy
+	 * @note Lazy quantifiers match the same paths, their "?" is ignored
+	 */
+	bool LocationPatterns::parse_repetition(Cursor& cursor, Fragment& fragment) {
+		const std::string& pattern = *cursor.pattern;
+		size_t atom_begin = cursor.pos;
+
+		if (!parse_atom(cursor, fragment)) {
+			return false;
+		}
+		if (cursor.pos == pattern.size()) {
+			return true;
+		}
+
+		char quantifier = pattern[cursor.pos];
+		if (quantifier == '*' || quantifier == '+' || quantifier == '?') {
+			++cursor.pos;
+			fragment = repeat(fragment, quantifier != '+', quantifier != '?');
+		} else if (quantifier == '{') {
+			int min = 0;
+			int max = 0;
+			++cursor.pos;
+			if (!parse_count(cursor, min)) {
+				return false;
+			}
+			max = min;
+			if (cursor.pos < pattern.size() && pattern[cursor.pos] == ',') {
+				++cursor.pos;
+				max = -1;
+				if (cursor.pos < pattern.size() && pattern[cursor.pos] != '}' && !parse_count(cursor, max)) {
+					return false;
+				}
+			}
+			if (cursor.pos == pattern.size() || pattern[cursor.pos] != '}' || (max != -1 && max < min)) {
+				return false;
+			}
+			size_t atom_end = ++cursor.pos;
+
+			int copies = max == -1 ? min + 1 : max;
+			Fragment repeated = empty_fragment();
+			for (int i = 0; i < copies; ++i) {
+				Fragment copy = fragment;
+				if (i > 0) {
+					cursor.pos = atom_begin;
+					parse_atom(cursor, copy);
+					if (_nodes.size() - cursor.first_node > LOCATION_PATTERNS_NODE_LIMIT) {
+						return false;
+					}
+				}
+				if (i >= min) {
+					copy = repeat(copy, true, max == -1);
+				}
+				repeated = concatenate(repeated, copy);
+			}
+			cursor.pos = atom_end;
+			fragment = repeated;
+		} else {
+			return true;
+		}
+
+		if (cursor.pos < pattern.size() && pattern[cursor.pos] == '?') {
+			++cursor.pos;
+		}
+		// Nothing to repeat, or a possessive quantifier that could reject paths
+		return cursor.pos == pattern.size() || std::strchr("*+?{", pattern[cursor.pos]) == NULL;
+	}
+
+	bool LocationPatterns::parse_atom(Cursor& cursor, Fragment& fragment) {
+		const std::string& pattern = *cursor.pattern;
+		std::bitset<256> set;
+
+		switch (pattern[cursor.pos]) {
+			case '(':
+				++cursor.pos;
+				if (pattern.compare(cursor.pos, 2, "?:") == 0) {
+					cursor.pos += 2;
+				} else if (cursor.pos < pattern.size() && pattern[cursor.pos] == '?') {
+					return false; // lookarounds and named groups
+				}
+				if (!parse_alternation(cursor, fragment) || cursor.pos == pattern.size()) {
+					return false;
+				}
+				++cursor.pos;
+				return true;
+			case '[':
+				if (!parse_class(cursor, set)) {
+					return false;
+				}
+				fragment = bytes_fragment(set, false);
+				return true;
+			case '.':
+				++cursor.pos;
+				set.set();
+				set.reset('\n');
+				fragment = bytes_fragment(set, false);
+				return true;
+			case '^':
+			case '$':
+				fragment = empty_fragment();
+				fragment.start = add_node(pattern[cursor.pos] == '^' ? NODE_BEGIN : NODE_END, fragment.end, -1);
+				++cursor.pos;
+				return true;
+			case '\\':
+				if (!parse_escape(cursor, set)) {
+					return false;
+				}
+				fragment = bytes_fragment(set, cursor.caseless);
+				return true;
+			case '*':
+			case '+':
+			case '?':
+			case '{':
+				return false;
+			default:
+				set.set(static_cast<unsigned char>(pattern[cursor.pos++]));
+				fragment = bytes_fragment(set, cursor.caseless);
+				return true;
+		}
+	}
+
+	/**
+	 * @brief Bracket expression, without POSIX [:classes:]
+	 */
+	bool LocationPatterns::parse_class(Cursor& cursor, std::bitset<256>& set) {
+		const std::string& pattern = *cursor.pattern;
+		bool negate = false;
+		bool first = true;
+
+		++cursor.pos;
+		if (cursor.pos < pattern.size() && pattern[cursor.pos] == '^') {
+			negate = true;
+			++cursor.pos;
+		}
+
+		while (true) {
+			if (cursor.pos == pattern.size()) {
+				return false;
+			}
+			char c = pattern[cursor.pos];
+			if (c == ']' && !first) {
+				++cursor.pos;
+				break;
+			}
+			if (c == '[' && cursor.pos + 1 < pattern.size() && std::strchr(":.=", pattern[cursor.pos + 1]) != NULL) {
+				return false;
+			}
+			first = false;
+
+			std::bitset<256> low;
+			if (c == '\\') {
+				if (!parse_escape(cursor, low)) {
+					return false;
+				}
+			} else {
+				low.set(static_cast<unsigned char>(c));
+				++cursor.pos;
+			}
+
+			if (low.count() != 1 || cursor.pos + 1 >= pattern.size() || pattern[cursor.pos] != '-' || pattern[cursor.pos + 1] == ']') {
+				set |= low;
+				continue;
+			}
+
+			++cursor.pos;
+			std::bitset<256> high;
+			if (pattern[cursor.pos] == '\\') {
+				if (!parse_escape(cursor, high) || high.count() != 1) {
+					return false;
+				}
+			} else {
+				high.set(static_cast<unsigned char>(pattern[cursor.pos++]));
+			}
+
+			int from = 0;
+			int to = 0;
+			while (!low.test(from)) { ++from; }
+			while (!high.test(to)) { ++to; }
+			if (to < from) {
+				return false;
+			}
+			for (int byte = from; byte <= to; ++byte) {
+				set.set(byte);
+			}
+		}
+
+		// Fold before negating, [^a] caseless excludes 'A' too
+		if (cursor.caseless) {
+			for (int byte = 'a'; byte <= 'z'; ++byte) {
+				if (set.test(byte) || set.test(std::toupper(byte))) {
+					set.set(byte);
+					set.set(std::toupper(byte));
+				}
+			}
+		}
+		if (negate) {
+			set.flip();
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Escaped byte or shorthand class, backreferences and assertions aren't supported
+	 */
+	bool LocationPatterns::parse_escape(Cursor& cursor, std::bitset<256>& set) {
+		const std::string& pattern = *cursor.pattern;
+
+		if (++cursor.pos == pattern.size()) {
+			return false;
+		}
+
+		char c = pattern[cursor.pos++];
+		bool negate = c == 'D' || c == 'W' || c == 'S';
+		switch (std::tolower(static_cast<unsigned char>(c))) {
+			case 'd':
+				for (int byte = '0'; byte <= '9'; ++byte) { set.set(byte); }
+				break;
+			case 'w':
+				for (int byte = 0; byte < 256; ++byte) {
+					if (std::isalnum(byte) || byte == '_') { set.set(byte); }
+				}
+				break;
+			case 's':
+				set.set(' '); set.set('\t'); set.set('\n'); set.set('\r'); set.set('\f'); set.set('\v');
+				break;
+			default:
+				negate = false;
+				if (c == 'n') {
+					set.set('\n');
+				} else if (c == 't') {
+					set.set('\t');
+				} else if (c == 'r') {
+					set.set('\r');
+				} else if (c == 'x') {
+					if (cursor.pos + 2 > pattern.size() || !std::isxdigit(static_cast<unsigned char>(pattern[cursor.pos]))
+						|| !std::isxdigit(static_cast<unsigned char>(pattern[cursor.pos + 1]))) {
+						return false;
+					}
+					set.set(std::strtol(pattern.substr(cursor.pos, 2).c_str(), NULL, 16));
+					cursor.pos += 2;
+				} else if (std::isalnum(static_cast<unsigned char>(c))) {
+					return false;
+				} else {
+					set.set(static_cast<unsigned char>(c));
+				}
+		}
+
+		if (negate) {
+			set.flip();
+		}
+		return true;
+	}
+
+	bool LocationPatterns::parse_count(Cursor& cursor, int& count) {
+		const std::string& pattern = *cursor.pattern;
+		size_t begin = cursor.pos;
+
+		count = 0;
+		while (cursor.pos < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[cursor.pos]))) {
+			count = count * 10 + (pattern[cursor.pos++] - '0');
+			if (count > LOCATION_PATTERNS_REPEAT_LIMIT) {
+				return false;
+			}
+		}
+		return cursor.pos != begin;
+	}
+
+	/**
+	 * @brief Glob anchored at both ends of the path, "\" escapes the next byte
+	 */
+	bool LocationPatterns::parse_glob(Cursor& cursor, Fragment& fragment) {
+		const std::string& pattern = *cursor.pattern;
+		std::bitset<256> any;
+		any.set();
+
+		fragment = empty_fragment();
+		fragment.start = add_node(NODE_BEGIN, fragment.end, -1);
+		while (cursor.pos < pattern.size()) {
+			char c = pattern[cursor.pos++];
+			std::bitset<256> set;
+
+			if (c == '*') {
+				fragment = concatenate(fragment, repeat(bytes_fragment(any, false), true, true));
+				continue;
+			}
+			if (c == '?') {
+				set = any;
+			} else if (c == '\\' && cursor.pos < pattern.size()) {
+				set.set(static_cast<unsigned char>(pattern[cursor.pos++]));
+			} else if (c == '\\') {
+				return false;
+			} else {
+				set.set(static_cast<unsigned char>(c));
+			}
+			fragment = concatenate(fragment, bytes_fragment(set, false));
+		}
+
+		Fragment end = empty_fragment();
+		end.start = add_node(NODE_END, end.end, -1);
+		fragment = concatenate(fragment, end);
+		return true;
+	}
+
+	int LocationPatterns::add_node(NodeType type, int next, int alt) {
+		Node node;
+		node.type = type;
+		node.next = next;
+		node.alt = alt;
+		_nodes.push_back(node);
+		return _nodes.size() - 1;
+	}
+
+	LocationPatterns::Fragment LocationPatterns::bytes_fragment(std::bitset<256> set, bool caseless) {
+		if (caseless) {
+			for (int byte = 'a'; byte <= 'z'; ++byte) {
+				if (set.test(byte) || set.test(std::toupper(byte))) {
+					set.set(byte);
+					set.set(std::toupper(byte));
+				}
+			}
+		}
+		_sets.push_back(set);
+
+		Fragment fragment = empty_fragment();
+		fragment.start = add_node(NODE_BYTES, fragment.end, _sets.size() - 1);
+		return fragment;
+	}
+
+	/**
+	 * @brief Fragment of a single empty node, every fragment ends with one
+	 */
+	LocationPatterns::Fragment LocationPatterns::empty_fragment() {
+		Fragment fragment;
+		fragment.start = add_node(NODE_EMPTY, -1, -1);
+		fragment.end = fragment.start;
+		return fragment;
+	}
+
+	LocationPatterns::Fragment LocationPatterns::concatenate(Fragment first, Fragment second) {
+		_nodes[first.end].next = second.start;
+		first.end = second.end;
+		return first;
+	}
+
+	LocationPatterns::Fragment LocationPatterns::alternate(Fragment first, Fragment second) {
+		Fragment fragment = empty_fragment();
+		_nodes[first.end].next = fragment.end;
+		_nodes[second.end].next = fragment.end;
+		fragment.start = add_node(NODE_SPLIT, first.start, second.start);
+		return fragment;
+	}
+
+	/**
+	 * @brief "?" when only optional, "+" when only many and "*" when both
+	 */
+	LocationPatterns::Fragment LocationPatterns::repeat(Fragment fragment, bool optional, bool many) {
+		Fragment repeated = empty_fragment();
+		int split = add_node(NODE_SPLIT, fragment.start, repeated.end);
+
+		_nodes[fragment.end].next = many ? split : repeated.end;
+		repeated.start = optional ? split : fragment.start;
+		return repeated;
+	}
+
+	/**
+	 * @brief Group bytes no pattern tells apart, the DFA has a column per group
+	 */
+	void LocationPatterns::split_byte_classes() {
+		_byte_classes.assign(256, 0);
+		_class_count = 1;
+
+		for (size_t i = 0; i < _sets.size(); ++i) {
+			std::map<std::pair<int, bool>, int> classes;
+			for (int byte = 0; byte < 256; ++byte) {
+				std::pair<int, bool> key(_byte_classes[byte], _sets[i].test(byte));
+				std::map<std::pair<int, bool>, int>::iterator it = classes.find(key);
+				if (it == classes.end()) {
+					it = classes.insert(std::make_pair(key, static_cast<int>(classes.size()))).first;
+				}
+				_byte_classes[byte] = it->second;
+			}
+			_class_count = classes.size();
+		}
+	}
+
+	/**
+	 * @brief Nodes reachable from seeds without reading a byte, sorted
+	 * @note Keeps the nodes that read a byte, "$" or accept. "^" passes only
+	 * at_start. marks must hold no mark yet.
+	 */
+	void LocationPatterns::closure(std::vector<int>& seeds, bool at_start, std::vector<int>& state, std::vector<int>& marks, int mark) const {
+		while (!seeds.empty()) {
+			int index = seeds.back();
+			seeds.pop_back();
+			if (marks[index] == mark) {
+				continue;
+			}
+			marks[index] = mark;
+
+			const Node& node = _nodes[index];
+			switch (node.type) {
+				case NODE_EMPTY:
+					seeds.push_back(node.next);
+					break;
+				case NODE_SPLIT:
+					seeds.push_back(node.next);
+					seeds.push_back(node.alt);
+					break;
+				case NODE_BEGIN:
+					if (at_start) {
+						seeds.push_back(node.next);
+					}
+					break;
+				default:
+					state.push_back(index);
+			}
+		}
+		std::sort(state.begin(), state.end());
+	}
+
+	/**
+	 * @brief First pattern accepted in state or -1
+	 */
+	int LocationPatterns::accept_of(const std::vector<int>& state) const {
+		int accept = -1;
+
+		for (size_t i = 0; i < state.size(); ++i) {
+			const Node& node = _nodes[state[i]];
+			if (node.type == NODE_MATCH && (accept == -1 || node.alt < accept)) {
+				accept = node.alt;
+			}
+		}
+		return accept;
+	}
+
+} /* namespace webserv */
@@ -0,0 +1,212 @@
+#include "LocationRouter.hpp"
+
+namespace webserv {
+	LocationRouter::LocationRouter() :
+		_nodes(1, new_node("")),
+		_patterns(),
+		_pattern_ids() {}
+
+	LocationRouter::LocationRouter(const LocationRouter& copy) :
+		_nodes(copy._nodes),
+		_patterns(copy._patterns),
+		_pattern_ids(copy._pattern_ids) {}
+
+	LocationRouter& LocationRouter::operator=(const LocationRouter& other) {
+		if (this == &other) { return *this; }
+		_nodes = other._nodes;
+		_patterns = other._patterns;
+		_pattern_ids = other._pattern_ids;
+		return *this;
+	}
+
+	LocationRouter::~LocationRouter() {}
+
+	/**
+	 * @brief Route paths starting with prefix to id
+	 * @note A prefix already added keeps its first id
+	 */
+	void LocationRouter::add_prefix(const std::string& prefix, int id, bool skip_patterns) {
+		Node& node = _nodes[insert(prefix)];
+
+		if (node.prefix == -1) {
+			node.prefix = id;
+			node.skip_patterns = skip_patterns;
+		}
+	}
+
+	/**
+	 * @brief Route path, and only path, to id
+	 */
+	void LocationRouter::add_exact(const std::string& path, int id) {
+		Node& node = _nodes[insert(path)];
+
+		if (node.exact == -1) {
+			node.exact = id;
+		}
+	}
+
+	/**
+	 * @brief Route paths matching pattern to id, patterns are tried in the order added
+	 * @note Takes effect on the next compile
+	 */
+	void LocationRouter::add_pattern(const std::string& pattern, PatternSyntax syntax, int id) {
+		_patterns.add(pattern, syntax);
+		_pattern_ids.push_back(id);
+	}
+
+	/**
+	 * @brief Compile the patterns added
+	 * @exception Throw runtime_error if they're too complex for a DFA
+	 */
+	void LocationRouter::compile() {
+		_patterns.compile();
+	}
+
+	void LocationRouter::clear() {
+		_nodes.assign(1, new_node(""));
+		_patterns.clear();
+		_pattern_ids.clear();
+	}
+
+	/**
+	 * @brief Id of the location of path
+	 * @note Like a directory, path is matched by prefixes as if it ended with '/'
+	 * @return id or -1 if no location matches
+	 */
+	int LocationRouter::find(const char* path, size_t size) const {
+		size_t length = size + (size == 0 || path[size - 1] != '/');
+		int prefix = _nodes[0].prefix;
+		bool skip_patterns = _nodes[0].skip_patterns;
+		size_t node = 0;
+		size_t pos = 0;
+
+		while (true) {
+			if (pos == size && _nodes[node].exact != -1) {
+				return _nodes[node].exact;
+			}
+			if (pos == length) {
+				break;
+			}
+
+			size_t child = find_child(node, pos < size ? path[pos] : '/');
+			if (child == 0) {
+				break;
+			}
+
+			const std::string& label = _nodes[child].label;
+			size_t end = pos + label.size();
+			if (end > length) {
+				break;
+			}
+			size_t i = 1;
+			while (i < label.size() && label[i] == (pos + i < size ? path[pos + i] : '/')) {
+				++i;
+			}
+			if (i < label.size()) {
+				break;
+			}
+
+			node = child;
+			pos = end;
+			if (_nodes[node].prefix != -1) {
+				prefix = _nodes[node].prefix;
+				skip_patterns = _nodes[node].skip_patterns;
+			}
+		}
+
+		if (!skip_patterns && !_pattern_ids.empty()) {
+			int pattern = _patterns.match(path, size);
+			if (pattern != -1) {
+				return _pattern_ids[pattern];
+			}
+		}
+		return prefix;
+	}
+
+	/**
+	 * @brief Node ending exactly at key, splitting an edge or adding a leaf if needed
+	 */
+	size_t LocationRouter::insert(const std::string& key) {
+		size_t node = 0;
+		size_t pos = 0;
+
+		while (pos < key.size()) {
+			size_t child = find_child(node, key[pos]);
+			if (child == 0) {
+				_nodes.push_back(new_node(key.substr(pos)));
+				insert_child(node, _nodes.size() - 1);
+				return _nodes.size() - 1;
+			}
+
+			const std::string& label = _nodes[child].label;
+			size_t common = 1;
+			while (common < label.size() && pos + common < key.size() && label[common] == key[pos + common]) {
+				++common;
+			}
+
+			if (common < label.size()) {
+				// Split the edge, the new node takes the place of child under node
+				Node middle = new_node(label.substr(0, common));
+				middle.children.push_back(child);
+				_nodes[child].label.erase(0, common);
+				_nodes.push_back(middle);
+
+				std::vector<size_t>& children = _nodes[node].children;
+				for (size_t i = 0; i < children.size(); ++i) {
+					if (children[i] == child) {
+						children[i] = _nodes.size() - 1;
+					}
+				}
+				child = _nodes.size() - 1;
+			}
+			node = child;
+			pos += common;
+		}
+		return node;
+	}
+
+	/**
+	 * @brief Child of node whose label starts with byte, children are sorted by it
+	 * @return child or 0, the root is nobody's child
+	 */
+	size_t LocationRouter::find_child(size_t node, unsigned char byte) const {
+		const std::vector<size_t>& children = _nodes[node].children;
+		size_t low = 0;
+		size_t high = children.size();
+
+		while (low < high) {
+			size_t middle = (low + high) / 2;
+			unsigned char first = _nodes[children[middle]].label[0];
+			if (first == byte) {
+				return children[middle];
+			}
+			if (first < byte) {
+				low = middle + 1;
+			} else {
+				high = middle;
+			}
+		}
+		return 0;
+	}
+
+	void LocationRouter::insert_child(size_t node, size_t child) {
+		unsigned char byte = _nodes[child].label[0];
+		std::vector<size_t>& children = _nodes[node].children;
+		std::vector<size_t>::iterator it = children.begin();
+
+		while (it != children.end() && static_cast<unsigned char>(_nodes[*it].label[0]) < byte) {
+			++it;
+		}
+		children.insert(it, child);
+	}
+
+	LocationRouter::Node LocationRouter::new_node(const std::string& label) {
+		Node node;
+		node.label = label;
+		node.prefix = -1;
+		node.exact = -1;
+		node.skip_patterns = false;
+		return node;
+	}
+
+} /* namespace webserv */
@@ -33,12 +33,15 @@ namespace webserv {
 
 		/* Class Logger */
 
-		Logger::Logger() : _log_fs() {}
+		Logger::Logger() : _log_fs() {
+			pthread_mutex_init(&_mutex, NULL);
+		}
 
 		Logger::~Logger() {
 			if (_log_fs.is_open()) {
 				_log_fs.close();
 			}
+			pthread_mutex_destroy(&_mutex);
 		}
 
 		/**
@@ -62,11 +65,13 @@ namespace webserv {
 					break;
 			}
 
+			pthread_mutex_lock(&_mutex);
 			if (_log_fs.is_open()) {
 				_log_fs << log_data.get_message();
 				_log_fs.flush();
 			}
 			*os << BLUE << log_data.get_message().insert(log_data.get_message().find("]") + 1, LogLevelColor[log_data.get_log_level()]) << RESET << std::flush;
+			pthread_mutex_unlock(&_mutex);
 
 		}
 
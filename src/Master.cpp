@@ -0,0 +1,186 @@
+#include "Master.hpp"
+
+namespace webserv {
+	Master::Master(const GlobalConfig& global_config, const std::vector<ServerConfig>& server_configs) :
+		_global_config(global_config), _config(ConfigSnapshot::create(server_configs)), _workers(), _worker_pids() {}
+
+	Master::~Master() {
+		for (size_t i = 0; i < _workers.size(); ++i) {
+			delete _workers[i];
+		}
+	}
+
+	/**
+	 * @brief Create and init one Server per worker thread, or a single one whose
+	 * listen sockets are shared by all worker processes
+	 */
+	void Master::init() {
+		if (_global_config.get_worker_processes() > 1) {
+			_workers.push_back(new Server(_config, _global_config));
+			_workers.back()->init();
+			LOG_I() << "Initialized listen sockets for " << _global_config.get_worker_processes() << " worker processes\n";
+			return;
+		}
+
+		int worker_threads = _global_config.get_worker_threads();
+		bool reuse_port = worker_threads > 1;
+
+		for (int i = 0; i < worker_threads; ++i) {
+			_workers.push_back(new Server(_config, _global_config, reuse_port, i));
+			_workers.back()->init();
+		}
+		LOG_I() << "Initialized " << worker_threads << " worker(s)\n";
+	}
+
+	/**
+	 * @brief Run the workers, a single worker runs on the calling thread
+	 */
+	void Master::run() {
+		if (_global_config.get_worker_processes() > 1) {
+			return run_processes();
+		}
+
+		if (_workers.size() == 1) {
+			return _workers.front()->run();
+		}
+
+		run_threads();
+	}
+
+	/**
+	 * @brief Start one thread per worker and wait for all of them to stop
+	 * @note Workers block SIGINT/SIGQUIT so signals are handled by this thread,
+	 * workers see g_shutdown on their next event loop wake up
+	 */
+	void Master::run_threads() {
+		sigset_t signals;
+		sigset_t old_signals;
+		sigemptyset(&signals);
+		sigaddset(&signals, SIGINT);
+		sigaddset(&signals, SIGQUIT);
+		pthread_sigmask(SIG_BLOCK, &signals, &old_signals);
+
+		std::vector<pthread_t> threads;
+		for (size_t i = 0; i < _workers.size(); ++i) {
+			pthread_t thread;
+			int ret = pthread_create(&thread, NULL, run_worker_thread, _workers[i]);
+			if (ret != 0) {
+				LOG_E() << "Failed to create worker thread: " << std::strerror(ret) << "\n";
+				internal::g_shutdown = 1;
+				break;
+			}
+			threads.push_back(thread);
+		}
+
+		pthread_sigmask(SIG_SETMASK, &old_signals, NULL);
+
+		for (size_t i = 0; i < threads.size(); ++i) {
+			pthread_join(threads[i], NULL);
+		}
+	}
+
+	/**
+	 * @brief Fork the worker processes and supervise them until shutdown
+	 * @note Missing workers are respawned at most once per second so a worker
+	 * crashing at start up can't turn into a fork loop. On shutdown the signal
+	 * received by the master is forwarded to every worker.
+	 */
+	void Master::run_processes() {
+		size_t worker_processes = _global_config.get_worker_processes();
+
+		while (!internal::g_shutdown) {
+			reap_worker_processes(false);
+
+			while (!internal::g_shutdown && _worker_pids.size() < worker_processes) {
+				spawn_worker_process();
+			}
+
+			sleep(1);
+		}
+
+		std::set<pid_t>::const_iterator it = _worker_pids.begin();
+		for (; it != _worker_pids.end(); ++it) {
+			kill(*it, internal::g_shutdown);
+		}
+
+		while (!_worker_pids.empty()) {
+			reap_worker_processes(true);
+		}
+	}
+
+	/**
+	 * @brief Fork a worker running its own event loop on the inherited listen sockets
+	 */
+	void Master::spawn_worker_process() {
+		pid_t pid = fork();
+
+		if (pid == -1) {
+			LOG_E() << "Failed to fork worker process: " << std::strerror(errno) << "\n";
+			sleep(1);
+			return;
+		}
+
+		if (pid == 0) {
+			int status = EXIT_SUCCESS;
+			try {
+				_workers.front()->init_forked_worker();
+				_workers.front()->run();
+			} catch (const std::exception& e) {
+				LOG_E() << e.what() << "\n";
+				status = EXIT_FAILURE;
+			}
+			std::exit(status);
+		}
+
+		LOG_I() << "Started worker process, pid: " << pid << "\n";
+		_worker_pids.insert(pid);
+	}
+
+	/**
+	 * @brief Collect exited worker processes
+	 * @param wait block until at least one worker exited
+	 */
+	void Master::reap_worker_processes(bool wait) {
+		int status;
+		pid_t pid;
+
+		while ((pid = waitpid(-1, &status, wait ? 0 : WNOHANG)) != 0) {
+			if (pid == -1) {
+				if (errno == EINTR) {
+					continue;
+				}
+				_worker_pids.clear();
+				return;
+			}
+
+			if (_worker_pids.erase(pid) == 0) {
+				continue;
+			}
+
+			if (WIFSIGNALED(status)) {
+				LOG_E() << "Worker process " << pid << " killed by signal " << WTERMSIG(status) << "\n";
+			} else if (WIFEXITED(status) && WEXITSTATUS(status) != EXIT_SUCCESS) {
+				LOG_E() << "Worker process " << pid << " exited with status " << WEXITSTATUS(status) << "\n";
+			} else {
+				LOG_I() << "Worker process " << pid << " exited\n";
+			}
+
+			if (wait) {
+				return;
+			}
+		}
+	}
+
+	/**
+	 * @brief Thread entry, a failing worker shuts down the whole server
+	 */
+	void* Master::run_worker_thread(void* worker) {
+		try {
+			static_cast<Server*>(worker)->run();
+		} catch (const std::exception& e) {
+			LOG_E() << e.what() << "\n";
+			internal::g_shutdown = 1;
+		}
+		return NULL;
+	}
+} /* namespace webserv */
@@ -0,0 +1,246 @@
+#include "MimeTypes.hpp"
+
+#include <cctype>
+#include <strings.h>
+
+#define MIME_TYPES_MIN_SLOTS 16
+#define MIME_TYPES_SEEDS 64 /* seeds tried per table size before doubling it */
+
+namespace webserv {
+	static const char* const default_mime_types[][2] = {
+		{ "aac", "audio/aac" },
+		{ "abw", "application/x-abiword" },
+		{ "arc", "application/octet-stream" },
+		{ "avi", "video/x-msvideo" },
+		{ "avif", "image/avif" },
+		{ "azw", "application/vnd.amazon.ebook" },
+		{ "bin", "application/octet-stream" },
+		{ "bmp", "image/bmp" },
+		{ "bz", "application/x-bzip" },
+		{ "bz2", "application/x-bzip2" },
+		{ "cda", "application/x-cdf" },
+		{ "csh", "application/x-csh" },
+		{ "css", "text/css" },
+		{ "csv", "text/csv" },
+		{ "doc", "application/msword" },
+		{ "epub", "application/epub+zip" },
+		{ "gif", "image/gif" },
+		{ "htm", "text/html" },
+		{ "html", "text/html" },
+		{ "ico", "image/x-icon" },
+		{ "ics", "text/calendar" },
+		{ "jar", "application/java-archive" },
+		{ "jpeg", "image/jpeg" },
+		{ "jpg", "image/jpeg" },
+		{ "js", "text/javascript" },
+		{ "json", "application/json" },
+		{ "mid", "audio/midi" },
+		{ "midi", "audio/midi" },
+		{ "mpeg", "video/mpeg" },
+		{ "mpkg", "application/vnd.apple.installer+xml" },
+		{ "odp", "application/vnd.oasis.opendocument.presentation" },
+		{ "ods", "application/vnd.oasis.opendocument.spreadsheet" },
+		{ "odt", "application/vnd.oasis.opendocument.text" },
+		{ "oga", "audio/ogg" },
+		{ "ogv", "video/ogg" },
+		{ "ogx", "application/ogg" },
+		{ "pdf", "application/pdf" },
+		{ "png", "image/png" },
+		{ "ppt", "application/vnd.ms-powerpoint" },
+		{ "rar", "application/x-rar-compressed" },
+		{ "rtf", "application/rtf" },
+		{ "sh", "application/x-sh" },
+		{ "svg", "image/svg+xml" },
+		{ "swf", "application/x-shockwave-flash" },
+		{ "tar", "application/x-tar" },
+		{ "tif", "image/tiff" },
+		{ "tiff", "image/tiff" },
+		{ "ttf", "application/x-font-ttf" },
+		{ "txt", "text/plain" },
+		{ "vsd", "application/vnd.visio" },
+		{ "wav", "audio/x-wav" },
+		{ "weba", "audio/webm" },
+		{ "webm", "video/webm" },
+		{ "webp", "image/webp" },
+		{ "woff", "application/x-font-woff" },
+		{ "xhtml", "application/xhtml+xml" },
+		{ "xls", "application/vnd.ms-excel" },
+		{ "xml", "application/xml" },
+		{ "xul", "application/vnd.mozilla.xul+xml" },
+		{ "zip", "application/zip" },
+		{ "3gp", "video/3gpp audio/3gpp" },
+		{ "3g2", "video/3gpp2 audio/3gpp2" },
+		{ "7z", "application/x-7z-compressed" }
+	};
+
+	MimeTypes::MimeTypes() :
+		_entries(),
+		_slots(),
+		_mask(0),
+		_seed(0) {}
+
+	MimeTypes::MimeTypes(const MimeTypes& copy) :
+		_entries(copy._entries),
+		_slots(copy._slots),
+		_mask(copy._mask),
+		_seed(copy._seed) {}
+
+	MimeTypes& MimeTypes::operator=(const MimeTypes& other) {
+		if (this == &other) { return *this; }
+		_entries = other._entries;
+		_slots = other._slots;
+		_mask = other._mask;
+		_seed = other._seed;
+		return *this;
+	}
+
+	MimeTypes::~MimeTypes() {}
+
+	/**
+	 * @brief Map extension (without dot, case-insensitive) to type, like "html" to "text/html"
+	 * @note A repeated extension takes the last type, call build once all are added
+	 * @return false if extension is invalid
+	 */
+	bool MimeTypes::add(const std::string& type, const std::string& extension) {
+		if (type.empty() || extension.empty() || extension.find_first_of("./") != std::string::npos) {
+			return false;
+		}
+
+		std::string lower_extension = extension;
+		for (size_t i = 0; i < lower_extension.size(); ++i) {
+			lower_extension[i] = std::tolower(lower_extension[i]);
+		}
+
+		for (size_t i = 0; i < _entries.size(); ++i) {
+			if (_entries[i].first == lower_extension) {
+				_entries[i].second = type;
+				return true;
+			}
+		}
+		_entries.push_back(std::make_pair(lower_extension, type));
+		return true;
+	}
+
+	/**
+	 * @brief Build the slot table, searching a seed without collision
+	 * @note Slots are at least twice the entries, if no seed is found the table
+	 * doubles, the last try is kept with linear probing if it never succeeds
+	 */
+	void MimeTypes::build() {
+		size_t slot_count = MIME_TYPES_MIN_SLOTS;
+		while (slot_count < _entries.size() * 2) {
+			slot_count *= 2;
+		}
+
+		size_t max_slot_count = slot_count * 64;
+		for (; slot_count <= max_slot_count; slot_count *= 2) {
+			_slots.assign(slot_count, -1);
+			_mask = slot_count - 1;
+
+			for (unsigned seed = 0; seed < MIME_TYPES_SEEDS; ++seed) {
+				if (try_seed(seed)) {
+					return;
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief MIME type of extension, without dot and case-insensitive
+	 * @return type or NULL if unknown
+	 */
+	const std::string* MimeTypes::find(const char* extension, size_t size) const {
+		if (_slots.empty()) {
+			return NULL;
+		}
+
+		for (size_t slot = slot_of(extension, size); _slots[slot] != -1; slot = (slot + 1) & _mask) {
+			const std::pair<std::string, std::string>& entry = _entries[_slots[slot]];
+			if (entry.first.size() == size && strncasecmp(entry.first.data(), extension, size) == 0) {
+				return &entry.second;
+			}
+		}
+		return NULL;
+	}
+
+	/**
+	 * @brief MIME type of the extension of the last path segment
+	 * @return type or NULL if unknown or path has no extension
+	 */
+	const std::string* MimeTypes::find_for_path(const std::string& path) const {
+		size_t dot = path.find_last_of("./");
+		if (dot == std::string::npos || path[dot] != '.') {
+			return NULL;
+		}
+		return find(path.data() + dot + 1, path.size() - dot - 1);
+	}
+
+	bool MimeTypes::empty() const {
+		return _entries.empty();
+	}
+
+	static MimeTypes build_default_mime_types() {
+		MimeTypes mime_types;
+
+		for (size_t i = 0; i < sizeof(default_mime_types) / sizeof(default_mime_types[0]); ++i) {
+			mime_types.add(default_mime_types[i][1], default_mime_types[i][0]);
+		}
+		mime_types.build();
+		return mime_types;
+	}
+
+	/**
+	 * @brief Types used when the configuration has no types block
+	 */
+	const MimeTypes& MimeTypes::get_default() {
+		static const MimeTypes mime_types = build_default_mime_types();
+		return mime_types;
+	}
+
+	/**
+	 * @brief Seeded FNV-1a of the lowercase extension, folded on the table size
+	 */
+	size_t MimeTypes::slot_of(const char* extension, size_t size) const {
+		unsigned hash = 2166136261u ^ (_seed * 0x9E3779B9u);
+
+		for (size_t i = 0; i < size; ++i) {
+			hash ^= static_cast<unsigned char>(std::tolower(extension[i]));
+			hash *= 16777619u;
+		}
+		return (hash ^ (hash >> 16)) & _mask;
+	}
+
+	/**
+	 * @brief Fill slots with seed
+	 * @return true if no two extensions share a slot
+	 */
+	bool MimeTypes::try_seed(unsigned seed) {
+		bool perfect = true;
+
+		_seed = seed;
+		_slots.assign(_slots.size(), -1);
+		for (size_t i = 0; i < _entries.size(); ++i) {
+			size_t slot = slot_of(_entries[i].first.data(), _entries[i].first.size());
+			for (; _slots[slot] != -1; slot = (slot + 1) & _mask) {
+				perfect = false;
+			}
+			_slots[slot] = i;
+		}
+		return perfect;
+	}
+
+	/* Getters */
+	const std::vector<std::pair<std::string, std::string> >& MimeTypes::get_entries() const { return _entries; }
+
+#ifdef PARSER_DEBUG
+	std::ostream& operator<<(std::ostream& os, const MimeTypes& mime_types) {
+		os << "types {\n";
+		for (size_t i = 0; i < mime_types.get_entries().size(); ++i) {
+			os << "\t" << mime_types.get_entries()[i].second << " " << mime_types.get_entries()[i].first << ";\n";
+		}
+		os << "}\n";
+		return os;
+	}
+#endif
+
+} /* namespace webserv */
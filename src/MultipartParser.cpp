@@ -0,0 +1,326 @@
+#include "MultipartParser.hpp"
+#include "utils.hpp"
+
+#include <cstring>
+#include <strings.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace webserv {
+	MultipartParser::MultipartParser() :
+		_state(MULTIPART_DATA),
+		_delimiter(),
+		_skip(),
+		_directory(),
+		_pending(),
+		_header_size(0),
+		_disposition(),
+		_file_name(),
+		_fd(-1),
+		_status_code(0),
+		_file_names() {}
+
+	/**
+	 * @note An open part file is duplicated, each copy closes its own descriptor
+	 */
+	MultipartParser::MultipartParser(const MultipartParser& copy) :
+		_state(copy._state),
+		_delimiter(copy._delimiter),
+		_skip(copy._skip),
+		_directory(copy._directory),
+		_pending(copy._pending),
+		_header_size(copy._header_size),
+		_disposition(copy._disposition),
+		_file_name(copy._file_name),
+		_fd(copy._fd == -1 ? -1 : dup(copy._fd)),
+		_status_code(copy._status_code),
+		_file_names(copy._file_names) {}
+
+	MultipartParser& MultipartParser::operator=(const MultipartParser& other) {
+		if (this == &other) { return *this; }
+		if (_fd != -1) {
+			close(_fd);
+		}
+		_state = other._state;
+		_delimiter = other._delimiter;
+		_skip = other._skip;
+		_directory = other._directory;
+		_pending = other._pending;
+		_header_size = other._header_size;
+		_disposition = other._disposition;
+		_file_name = other._file_name;
+		_fd = other._fd == -1 ? -1 : dup(other._fd);
+		_status_code = other._status_code;
+		_file_names = other._file_names;
+		return *this;
+	}
+
+	MultipartParser::~MultipartParser() {
+		if (_fd != -1) {
+			close(_fd);
+		}
+	}
+
+	/**
+	 * @brief Start parsing a body split by boundary, files are written in directory
+	 * @return false if boundary is invalid
+	 */
+	bool MultipartParser::start(const std::string& boundary, const std::string& directory) {
+		if (boundary.empty() || boundary.size() > MULTIPART_BOUNDARY_LIMIT) {
+			return false;
+		}
+
+		_state = MULTIPART_DATA;
+		_delimiter = "\r\n--" + boundary;
+		_skip.assign(256, _delimiter.size());
+		for (size_t i = 0; i + 1 < _delimiter.size(); ++i) {
+			_skip[static_cast<unsigned char>(_delimiter[i])] = _delimiter.size() - 1 - i;
+		}
+		_directory = directory;
+		// The first delimiter has no line break before it, pretend it has one
+		_pending = "\r\n";
+		_header_size = 0;
+		_disposition.clear();
+		_file_name.clear();
+		_status_code = 0;
+		_file_names.clear();
+		return true;
+	}
+
+	/**
+	 * @brief Parse the next body bytes
+	 * @return false on error, with status code set
+	 * @note When bytes are left from the previous feed, only enough new bytes to
+	 * decide on them are copied behind them, the rest is parsed in place
+	 */
+	bool MultipartParser::feed(const char* data, size_t size) {
+		if (_status_code != 0) {
+			return false;
+		}
+
+		size_t used = 0;
+		if (!_pending.empty()) {
+			size_t pending_size = _pending.size();
+			size_t window = size < _delimiter.size() ? size : _delimiter.size();
+
+			_pending.append(data, window);
+			size_t processed = process(_pending.data(), _pending.size());
+			if (processed < pending_size) {
+				_pending.erase(0, processed);
+				_pending.append(data + window, size - window);
+				_pending.erase(0, process(_pending.data(), _pending.size()));
+				return _status_code == 0;
+			}
+			used = processed - pending_size;
+			_pending.clear();
+		}
+
+		size_t processed = process(data + used, size - used);
+		_pending.assign(data + used + processed, size - used - processed);
+		return _status_code == 0;
+	}
+
+	/**
+	 * @brief Body is complete, it must have ended with the close delimiter
+	 * @return false if it didn't, with status code set
+	 */
+	bool MultipartParser::finish() {
+		if (_status_code != 0) {
+			return false;
+		}
+		if (_state != MULTIPART_DONE) {
+			return fail(400);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Remove the file of the part being written, files already complete stay
+	 */
+	void MultipartParser::abort() {
+		if (_fd == -1) {
+			return;
+		}
+		close(_fd);
+		_fd = -1;
+		unlink((_directory + _file_name).c_str());
+	}
+
+	bool MultipartParser::is_started() const {
+		return !_delimiter.empty();
+	}
+
+	/**
+	 * @brief Parse as many bytes as can be decided on
+	 * @return number of bytes used, the rest must be given again with more bytes
+	 */
+	size_t MultipartParser::process(const char* data, size_t size) {
+		size_t pos = 0;
+
+		while (pos < size && _status_code == 0) {
+			switch (_state) {
+				case MULTIPART_DATA: {
+					size_t delimiter = find_delimiter(data + pos, size - pos);
+					if (delimiter == std::string::npos) {
+						// A tail shorter than the delimiter may be the start of one
+						size_t keep = size - pos < _delimiter.size() - 1 ? size - pos : _delimiter.size() - 1;
+						write_part(data + pos, size - pos - keep);
+						return size - keep;
+					}
+					if (!write_part(data + pos, delimiter)) {
+						return pos;
+					}
+					close_part();
+					pos += delimiter + _delimiter.size();
+					_state = MULTIPART_DELIMITER;
+					break;
+				}
+				case MULTIPART_DELIMITER:
+					// "--" ends the body, otherwise optional padding and CRLF start a part
+					if (data[pos] == ' ' || data[pos] == '\t') {
+						++pos;
+						break;
+					}
+					if (size - pos < 2) {
+						return pos;
+					}
+					if (data[pos] == '-' && data[pos + 1] == '-') {
+						_state = MULTIPART_DONE;
+						return size;
+					}
+					if (data[pos] != '\r' || data[pos + 1] != '\n') {
+						fail(400);
+						return pos;
+					}
+					pos += 2;
+					_header_size = 0;
+					_state = MULTIPART_HEADERS;
+					break;
+				case MULTIPART_HEADERS: {
+					const char* line_end = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+					size_t line_size = line_end == NULL ? size - pos : line_end - (data + pos) + 1;
+					if (_header_size + line_size > MULTIPART_HEADER_LIMIT) {
+						fail(400);
+						return pos;
+					}
+					if (line_end == NULL) {
+						return pos;
+					}
+					_header_size += line_size;
+					if (!parse_header_line(data + pos, line_size - 1)) {
+						return pos;
+					}
+					pos += line_size;
+					break;
+				}
+				case MULTIPART_DONE:
+					// Epilogue is ignored
+					return size;
+			}
+		}
+		return pos;
+	}
+
+	/**
+	 * @brief Boyer-Moore-Horspool search of the delimiter
+	 * @return offset of the delimiter or npos if data doesn't contain it whole
+	 */
+	size_t MultipartParser::find_delimiter(const char* data, size_t size) const {
+		const char* pattern = _delimiter.data();
+		size_t last = _delimiter.size() - 1;
+
+		for (size_t i = 0; i + last < size; i += _skip[static_cast<unsigned char>(data[i + last])]) {
+			if (data[i + last] == pattern[last] && std::memcmp(data + i, pattern, last) == 0) {
+				return i;
+			}
+		}
+		return std::string::npos;
+	}
+
+	/**
+	 * @brief Parse one part header line without its LF, an empty line starts the part data
+	 * @note Only Content-Disposition is looked at
+	 */
+	bool MultipartParser::parse_header_line(const char* line, size_t size) {
+		if (size > 0 && line[size - 1] == '\r') {
+			--size;
+		}
+
+		if (size == 0) {
+			_state = MULTIPART_DATA;
+			return open_part();
+		}
+
+		if (size >= 20 && strncasecmp(line, "Content-Disposition:", 20) == 0) {
+			size_t start = 20;
+			while (start < size && (line[start] == ' ' || line[start] == '\t')) {
+				++start;
+			}
+			_disposition.assign(line + start, size - start);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Open the file of a part with a file name, other parts are skipped
+	 */
+	bool MultipartParser::open_part() {
+		std::string disposition;
+		disposition.swap(_disposition);
+
+		if (disposition.find("form-data; name=\"") == std::string::npos) {
+			return fail(400);
+		}
+
+		size_t file_name = disposition.find("; filename=\"");
+		if (file_name == std::string::npos) {
+			return true;
+		}
+		file_name += 12;
+		size_t file_name_end = disposition.find('"', file_name);
+		if (file_name_end == std::string::npos) {
+			return fail(400);
+		}
+
+		_file_name = disposition.substr(file_name, file_name_end - file_name);
+		if (_file_name.empty()) {
+			return true;
+		}
+		if (_file_name.find('/') != std::string::npos || _file_name == "." || _file_name == "..") {
+			return fail(400);
+		}
+
+		_fd = open((_directory + _file_name).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if (_fd == -1) {
+			return fail(500);
+		}
+		return true;
+	}
+
+	bool MultipartParser::write_part(const char* data, size_t size) {
+		if (_fd == -1 || write_all(_fd, data, size)) {
+			return true;
+		}
+		return fail(500);
+	}
+
+	void MultipartParser::close_part() {
+		if (_fd == -1) {
+			return;
+		}
+		close(_fd);
+		_fd = -1;
+		_file_names.push_back(_file_name);
+	}
+
+	bool MultipartParser::fail(int status_code) {
+		_status_code = status_code;
+		abort();
+		return false;
+	}
+
+	/* Getters */
+	const int& MultipartParser::get_status_code() const { return _status_code; }
+	const std::vector<std::string>& MultipartParser::get_file_names() const { return _file_names; }
+
+} /* namespace webserv */
@@ -0,0 +1,477 @@
+#include "OpenFileCache.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+
+#define OPEN_FILE_CACHE_EVENTS (IN_ATTRIB | IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE \
+	| IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)
+#endif
+
+namespace webserv {
+	namespace internal {
+		/* Struct OpenFileInfo */
+
+		OpenFileInfo::OpenFileInfo() :
+			error(0),
+			fd(-1),
+			mode(0),
+			size(0),
+			mtime(0),
+			inode(0),
+			version(0) {}
+
+		bool OpenFileInfo::is_file() const { return error == 0 && S_ISREG(mode); }
+		bool OpenFileInfo::is_directory() const { return error == 0 && S_ISDIR(mode); }
+
+		/* Class OpenFileCache */
+
+		OpenFileCache::OpenFileCache(size_t max_entries, unsigned long valid_ms, bool cache_errors) :
+			_entries(),
+			_buckets(),
+			_mask(0),
+			_free(-1),
+			_newest(-1),
+			_oldest(-1),
+			_size(0),
+			_max_entries(max_entries),
+			_valid_ms(valid_ms),
+			_cache_errors(cache_errors),
+			_version(0),
+			_now_ms(0),
+			_drained(false),
+			_notify_fd(-1),
+			_watches() {
+			size_t bucket_count = OPEN_FILE_CACHE_MIN_BUCKETS;
+			while (bucket_count < _max_entries) {
+				bucket_count *= 2;
+			}
+			_buckets.assign(bucket_count, -1);
+			_mask = bucket_count - 1;
+
+			if (_max_entries > 0) {
+				reset();
+			}
+		}
+
+		OpenFileCache::~OpenFileCache() {
+			clear();
+			close_notify();
+		}
+
+		/**
+		 * @brief Open path and stat it, without any cache
+		 * @note A path that exists but can't be opened, like a directory or file
+		 * without read permission, is only stat
+		 * @return true if path exists, otherwise false with info.error set
+		 */
+		bool OpenFileCache::open_uncached(const std::string& path, OpenFileInfo& info) {
+			struct stat file_info;
+			info = OpenFileInfo();
+
+			// O_NONBLOCK so a fifo doesn't block the worker, regular files ignore it
+			int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+			if (fd == -1) {
+				if (errno != EACCES || stat(path.c_str(), &file_info) == -1) {
+					info.error = errno;
+					return false;
+				}
+			} else if (fstat(fd, &file_info) == -1) {
+				info.error = errno;
+				close(fd);
+				return false;
+			}
+
+			if (fd != -1 && !S_ISREG(file_info.st_mode)) {
+				close(fd);
+				fd = -1;
+			}
+			info.fd = fd;
+			info.mode = file_info.st_mode;
+			info.size = file_info.st_size;
+			info.mtime = file_info.st_mtime;
+			info.inode = file_info.st_ino;
+			return true;
+		}
+
+		/**
+		 * @brief Open path through the cache, info.fd is a new fd the caller closes
+		 * @return true if path exists, otherwise false with info.error set
+		 */
+		bool OpenFileCache::open(const std::string& path, OpenFileInfo& info) {
+			if (_max_entries == 0) {
+				return open_uncached(path, info);
+			}
+
+			int index = acquire(path, info);
+			if (index == -1) {
+				return false;
+			}
+			return share(_entries[index], info);
+		}
+
+		/**
+		 * @brief Metadata of path through the cache, info.fd is always -1
+		 * @return true if path exists, otherwise false with info.error set
+		 */
+		bool OpenFileCache::lookup(const std::string& path, OpenFileInfo& info) {
+			if (_max_entries == 0) {
+				bool found = open_uncached(path, info);
+				if (info.fd != -1) {
+					close(info.fd);
+					info.fd = -1;
+				}
+				return found;
+			}
+
+			int index = acquire(path, info);
+			if (index == -1) {
+				return false;
+			}
+			info = _entries[index].info;
+			info.fd = -1;
+			return info.error == 0;
+		}
+
+		/**
+		 * @brief Forget path, for changes this worker made itself
+		 * @note Also drains pending events on the next lookup, the kernel queued
+		 * them before the change returned
+		 */
+		void OpenFileCache::invalidate(const std::string& path) {
+			_drained = false;
+			if (_max_entries == 0) {
+				return;
+			}
+
+			int index = find(path, bucket_of(path));
+			if (index != -1) {
+				remove(index);
+			}
+		}
+
+		/**
+		 * @brief Time of the event loop wake up, the next lookup drains events first
+		 */
+		void OpenFileCache::set_now(const unsigned long& now_ms) {
+			_now_ms = now_ms;
+			_drained = false;
+		}
+
+		/**
+		 * @brief Empty the cache and open a new inotify instance
+		 * @note For a forked worker, the instance inherited is shared with the others
+		 */
+		void OpenFileCache::reset() {
+			clear();
+			close_notify();
+#ifdef __linux__
+			_notify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+		}
+
+		/**
+		 * @brief Close every cached fd and drop every entry
+		 */
+		void OpenFileCache::clear() {
+			while (_oldest != -1) {
+				remove(_oldest);
+			}
+		}
+
+		/**
+		 * @brief Valid entry of path, opened and added if missing
+		 * @return entry or -1 with info set if the result isn't cached
+		 */
+		int OpenFileCache::acquire(const std::string& path, OpenFileInfo& info) {
+			if (!_drained) {
+				drain();
+			}
+
+			size_t bucket = bucket_of(path);
+			int index = find(path, bucket);
+			if (index != -1 && _now_ms - _entries[index].validated_ms >= _valid_ms) {
+				if (revalidate(_entries[index])) {
+					_entries[index].validated_ms = _now_ms;
+				} else {
+					remove(index);
+					index = -1;
+				}
+			}
+
+			if (index == -1) {
+				OpenFileInfo opened;
+				open_uncached(path, opened);
+				if (opened.error != 0 && (!_cache_errors || !is_path_error(opened.error))) {
+					info = opened;
+					return -1;
+				}
+				opened.version = ++_version;
+				index = insert(path, bucket, opened);
+			}
+
+			touch(index);
+			return index;
+		}
+
+		int OpenFileCache::find(const std::string& path, const size_t& bucket) const {
+			for (int index = _buckets[bucket]; index != -1; index = _entries[index].next) {
+				if (_entries[index].path == path) {
+					return index;
+				}
+			}
+			return -1;
+		}
+
+		/**
+		 * @brief Add path as the newest entry, evicting the oldest if full
+		 * @note Entries are reused from the free list, so their path keeps its buffer
+		 */
+		int OpenFileCache::insert(const std::string& path, const size_t& bucket, const OpenFileInfo& info) {
+			if (_size == _max_entries) {
+				remove(_oldest);
+			}
+
+			int index = _free;
+			if (index != -1) {
+				_free = _entries[index].next;
+			} else {
+				_entries.push_back(Entry());
+				index = _entries.size() - 1;
+			}
+
+			Entry& entry = _entries[index];
+			size_t slash = path.rfind('/');
+			entry.path = path;
+			entry.name_offset = slash == std::string::npos ? 0 : slash + 1;
+			entry.used = true;
+			entry.older = -1;
+			entry.newer = -1;
+			entry.validated_ms = _now_ms;
+			entry.info = info;
+			entry.watch = add_watch(path, entry.name_offset);
+
+			entry.next = _buckets[bucket];
+			_buckets[bucket] = index;
+			++_size;
+			return index;
+		}
+
+		void OpenFileCache::remove(int index) {
+			Entry& entry = _entries[index];
+
+			int* link = &_buckets[bucket_of(entry.path)];
+			while (*link != index) {
+				link = &_entries[*link].next;
+			}
+			*link = entry.next;
+			unlink_lru(index);
+
+			if (entry.info.fd != -1) {
+				close(entry.info.fd);
+			}
+			release_watch(entry.watch);
+			entry.used = false;
+			entry.watch = -1;
+			entry.info = OpenFileInfo();
+
+			entry.next = _free;
+			_free = index;
+			--_size;
+		}
+
+		/**
+		 * @brief Make index the newest entry
+		 */
+		void OpenFileCache::touch(int index) {
+			if (_newest == index) {
+				return;
+			}
+			unlink_lru(index);
+
+			Entry& entry = _entries[index];
+			entry.older = _newest;
+			if (_newest != -1) {
+				_entries[_newest].newer = index;
+			}
+			_newest = index;
+			if (_oldest == -1) {
+				_oldest = index;
+			}
+		}
+
+		void OpenFileCache::unlink_lru(int index) {
+			Entry& entry = _entries[index];
+
+			if (entry.newer != -1) {
+				_entries[entry.newer].older = entry.older;
+			} else if (_newest == index) {
+				_newest = entry.older;
+			}
+			if (entry.older != -1) {
+				_entries[entry.older].newer = entry.newer;
+			} else if (_oldest == index) {
+				_oldest = entry.newer;
+			}
+			entry.older = -1;
+			entry.newer = -1;
+		}
+
+		/**
+		 * @brief Check an expired entry against a fresh stat, like nginx does
+		 * @return true if the path is still the same file, or still missing
+		 */
+		bool OpenFileCache::revalidate(const Entry& entry) const {
+			struct stat file_info;
+
+			if (stat(entry.path.c_str(), &file_info) == -1) {
+				return entry.info.error == errno;
+			}
+			return entry.info.error == 0
+				&& file_info.st_ino == entry.info.inode
+				&& file_info.st_mode == entry.info.mode
+				&& file_info.st_size == entry.info.size
+				&& file_info.st_mtime == entry.info.mtime;
+		}
+
+		/**
+		 * @brief Copy the entry to info with a dup of its fd
+		 */
+		bool OpenFileCache::share(const Entry& entry, OpenFileInfo& info) const {
+			info = entry.info;
+			if (info.fd == -1) {
+				return info.error == 0;
+			}
+
+			info.fd = fcntl(entry.info.fd, F_DUPFD_CLOEXEC, 0);
+			if (info.fd == -1) {
+				info.error = errno;
+				return false;
+			}
+			return true;
+		}
+
+		/**
+		 * @brief FNV-1a of the path, folded on the bucket count
+		 */
+		size_t OpenFileCache::bucket_of(const std::string& path) const {
+			unsigned hash = 2166136261u;
+
+			for (size_t i = 0; i < path.size(); ++i) {
+				hash ^= static_cast<unsigned char>(path[i]);
+				hash *= 16777619u;
+			}
+			return (hash ^ (hash >> 16)) & _mask;
+		}
+
+		/**
+		 * @brief Errors that say something about the path, others like EMFILE
+		 * are about this moment and aren't cached
+		 */
+		bool OpenFileCache::is_path_error(const int& error) {
+			return error == ENOENT || error == ENOTDIR || error == EACCES
+				|| error == ENAMETOOLONG || error == ELOOP;
+		}
+
+		/**
+		 * @brief Drop the entries of every path changed since the last drain
+		 */
+		void OpenFileCache::drain() {
+			_drained = true;
+#ifdef __linux__
+			if (_notify_fd == -1) {
+				return;
+			}
+
+			long buffer[OPEN_FILE_CACHE_EVENT_BUFFER / sizeof(long)];
+			ssize_t size;
+			while ((size = read(_notify_fd, buffer, sizeof(buffer))) > 0) {
+				const char* events = reinterpret_cast<const char*>(buffer);
+
+				for (ssize_t offset = 0; offset < size;) {
+					const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(events + offset);
+					offset += sizeof(struct inotify_event) + event->len;
+
+					if (event->mask & IN_Q_OVERFLOW) {
+						clear();
+					} else if (event->mask & IN_IGNORED) {
+						// The kernel already removed the watch, its directory is gone
+						remove_watched(event->wd, NULL);
+						_watches.erase(event->wd);
+					} else if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+						remove_watched(event->wd, NULL);
+					} else if (event->len > 0) {
+						remove_watched(event->wd, event->name);
+					}
+				}
+			}
+#endif
+		}
+
+		/**
+		 * @brief Drop the entries watched by watch, only the one named name if not NULL
+		 */
+		void OpenFileCache::remove_watched(const int& watch, const char* name) {
+			for (size_t i = 0; i < _entries.size(); ++i) {
+				const Entry& entry = _entries[i];
+				if (entry.used && entry.watch == watch
+					&& (name == NULL || std::strcmp(entry.path.c_str() + entry.name_offset, name) == 0)) {
+					remove(i);
+				}
+			}
+		}
+
+		/**
+		 * @brief Watch the directory of path, one watch per directory is shared
+		 * @return watch or -1 if the directory can't be watched
+		 */
+		int OpenFileCache::add_watch(const std::string& path, const size_t& name_offset) {
+#ifdef __linux__
+			if (_notify_fd == -1) {
+				return -1;
+			}
+
+			std::string directory = name_offset == 0 ? "." : path.substr(0, name_offset);
+			int watch = inotify_add_watch(_notify_fd, directory.c_str(), OPEN_FILE_CACHE_EVENTS);
+			if (watch != -1) {
+				++_watches[watch];
+			}
+			return watch;
+#else
+			(void)path;
+			(void)name_offset;
+			return -1;
+#endif
+		}
+
+		/**
+		 * @brief Remove the watch with its last entry
+		 */
+		void OpenFileCache::release_watch(const int& watch) {
+			std::map<int, size_t>::iterator it = _watches.find(watch);
+			if (it == _watches.end() || --it->second > 0) {
+				return;
+			}
+
+#ifdef __linux__
+			inotify_rm_watch(_notify_fd, watch);
+#endif
+			_watches.erase(it);
+		}
+
+		void OpenFileCache::close_notify() {
+			if (_notify_fd != -1) {
+				close(_notify_fd);
+				_notify_fd = -1;
+			}
+			_watches.clear();
+		}
+
+		/* Getters */
+		size_t OpenFileCache::get_size() const { return _size; }
+	} /* namespace internal */
+} /* namespace webserv */
@@ -3,9 +3,10 @@
 namespace webserv {
 	/* Class Parser */
 
-	Parser::Parser() : _tokenizer(), _str(), _tokens(), _scopes_and_types() {
+	Parser::Parser() : _tokenizer(), _str(), _tokens(), _global_config(), _scopes_and_types() {
 		/* register global scope types */
 		_scopes_and_types["global"].insert("server");
+		GlobalConfig::register_types(_scopes_and_types["global"]);
 
 		/* register other scope types */
 		ServerConfig::register_types(_scopes_and_types["server"]);
@@ -24,6 +25,7 @@ namespace webserv {
 
 		_token_it = _tokens.begin();
 		_token_ite = _tokens.end();
+		_global_config = GlobalConfig();
 
 		std::vector<ServerConfig> server_configs;
 		while (_token_it != _token_ite) {
@@ -33,16 +35,52 @@ namespace webserv {
 				ServerConfig server_config;
 				server_config = parse_server_config();
 				server_configs.push_back(server_config);
+			} else if (token.text == "types") {
+				if (!_global_config.set_types(parse_types())) {
+					throw ParserExceptionAtLine("Unexpected token: " + token.text, token.line_number);
+				}
+			} else {
+				parse_global_config(token);
+			}
+		}
+
+		if (!_global_config.set_default()) {
+			throw ParserException("Invalid global configuration: worker_threads and worker_processes can't be both greater than 1");
+		}
+
+		/* servers without types block inherit the global one */
+		std::vector<ServerConfig>::iterator server_it = server_configs.begin();
+		for (; server_it != server_configs.end(); ++server_it) {
+			if (server_it->get_types().empty()) {
+				server_it->set_types(_global_config.get_types());
 			}
 		}
 
 #ifdef PARSER_DEBUG
+		/* debug */ LOG_D() << _global_config;
 		/* debug */ internal::print_debug_vector(server_configs);
 #endif
 
 		return server_configs;
 	}
 
+	/**
+	 * @brief Parse a directive of global scope
+	 * @exception Throw ParserException if fail to set global config
+	 */
+	void Parser::parse_global_config(const internal::Token& token_type) {
+		while (_token_it != _token_ite
+			&& (_token_it->type != internal::OPERATOR && _token_it->text != ";")) {
+			internal::Token token_value = expect_value();
+
+			if (!_global_config.set_config(token_type.text, token_value.text)) {
+				throw ParserExceptionAtLine("Unexpected token: " + token_value.text, token_value.line_number);
+			}
+		}
+
+		expect_operator(";");
+	}
+
 	/**
 	 * @brief Parse server config
 	 * @exception Throw ParserException if fail to set server config
@@ -62,6 +100,13 @@ namespace webserv {
 				continue;
 			}
 
+			if (token_type.text == "types") {
+				if (!server_config.set_types(parse_types())) {
+					throw ParserExceptionAtLine("Unexpected token: " + token_type.text, token_type.line_number);
+				}
+				continue;
+			}
+
 			while (_token_it != _token_ite
 				&& (_token_it->type != internal::OPERATOR && _token_it->text != ";")) {
 				internal::Token token_value = expect_value();
@@ -89,10 +134,17 @@ namespace webserv {
 	LocationConfig Parser::parse_location_config() {
 		LocationConfig location_config;
 
+		// Optional modifier, then uri or pattern
 		internal::Token token_value = expect_value();
 		if (!location_config.set_config("location", token_value.text)) {
 			throw ParserExceptionAtLine("Unexpected token: " + token_value.text, token_value.line_number);
 		}
+		if (_token_it != _token_ite && _token_it->type != internal::OPERATOR) {
+			token_value = expect_value();
+			if (!location_config.set_config("location", token_value.text)) {
+				throw ParserExceptionAtLine("Unexpected token: " + token_value.text, token_value.line_number);
+			}
+		}
 
 		expect_operator("{");
 
@@ -100,6 +152,13 @@ namespace webserv {
 			&& (_token_it->type != internal::OPERATOR && _token_it->text != "}")) {
 			internal::Token token_type = expect_type("location");
 
+			if (token_type.text == "types") {
+				if (!location_config.set_types(parse_types())) {
+					throw ParserExceptionAtLine("Unexpected token: " + token_type.text, token_type.line_number);
+				}
+				continue;
+			}
+
 			while (_token_it != _token_ite
 				&& (_token_it->type != internal::OPERATOR && _token_it->text != ";")) {
 				token_value = expect_value();
@@ -120,6 +179,35 @@ namespace webserv {
 		return location_config;
 	}
 
+	/**
+	 * @brief Parse types block, lines of a MIME type followed by its extensions
+	 * @exception Throw ParserException if a line has no extension or an invalid one
+	 */
+	MimeTypes Parser::parse_types() {
+		MimeTypes types;
+		expect_operator("{");
+
+		while (_token_it != _token_ite
+			&& (_token_it->type != internal::OPERATOR && _token_it->text != "}")) {
+			internal::Token token_type = expect_value();
+
+			do {
+				internal::Token token_value = expect_value();
+
+				if (!types.add(token_type.text, token_value.text)) {
+					throw ParserExceptionAtLine("Unexpected token: " + token_value.text, token_value.line_number);
+				}
+			} while (_token_it != _token_ite
+				&& (_token_it->type != internal::OPERATOR && _token_it->text != ";"));
+
+			expect_operator(";");
+		}
+
+		expect_operator("}");
+		types.build();
+		return types;
+	}
+
 	/**
 	 * @brief Expect and return operator token matched name
 	 * @exception Throw ParserException if can't find expected opterator
@@ -187,6 +275,9 @@ namespace webserv {
 		return token;
 	}
 
+	/* Getters */
+	const GlobalConfig& Parser::get_global_config() const { return _global_config; }
+
 	/* Class ParserException */
 
 	ParserException::ParserException(std::string message) throw() : std::invalid_argument(message) {}
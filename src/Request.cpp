@@ -4,332 +4,796 @@ namespace webserv {
 	Request::Request(struct sockaddr_in client_address, Listen const &server_listen) :
 		_status_code(0),
 		_client(client_address),
-		_raw(),
+		_parse_state(PARSE_REQUEST_LINE),
+		_started(false),
 		_raw_header(),
+		_line_start(0),
+		_header_line_limit(0),
+		_header_size_limit(0),
 		_raw_body(),
 		_method(-1),
 		_path(),
 		_query(),
 		_headers(),
 		_bytes_to_read(0),
-		_file_names(),
+		_body_size(0),
+		_body_fd(-1),
+		_chunked(false),
+		_chunk_state(CHUNK_SIZE),
+		_chunk_size(0),
+		_chunk_line_length(0),
+		_trailer_size(0),
+		_multipart(),
 		_server_listen(server_listen),
 		_server_name(),
-		_server_config() {}
+		_server_config(NULL),
+		_keep_alive(false) {}
 
 	Request::Request(Request const &other) :
 		_status_code(other._status_code),
 		_client(other._client),
-		_raw(other._raw),
+		_parse_state(other._parse_state),
+		_started(other._started),
 		_raw_header(other._raw_header),
+		_line_start(other._line_start),
+		_header_line_limit(other._header_line_limit),
+		_header_size_limit(other._header_size_limit),
 		_raw_body(other._raw_body),
 		_method(other._method),
 		_path(other._path),
 		_query(other._query),
 		_headers(other._headers),
 		_bytes_to_read(other._bytes_to_read),
-		_file_names(other._file_names),
+		_body_size(other._body_size),
+		_body_fd(other._body_fd == -1 ? -1 : dup(other._body_fd)),
+		_chunked(other._chunked),
+		_chunk_state(other._chunk_state),
+		_chunk_size(other._chunk_size),
+		_chunk_line_length(other._chunk_line_length),
+		_trailer_size(other._trailer_size),
+		_multipart(other._multipart),
 		_server_listen(other._server_listen),
 		_server_name(other._server_name),
-		_server_config(other._server_config) {}
+		_server_config(other._server_config),
+		_keep_alive(other._keep_alive) {}
 
 	Request& Request::operator=(Request const &other) {
 		_status_code = other._status_code;
 		_client = other._client;
-		_raw = other._raw;
+		_parse_state = other._parse_state;
+		_started = other._started;
 		_raw_header = other._raw_header;
+		_line_start = other._line_start;
+		_header_line_limit = other._header_line_limit;
+		_header_size_limit = other._header_size_limit;
 		_raw_body = other._raw_body;
 		_method = other._method;
 		_path = other._path;
 		_query = other._query;
 		_headers = other._headers;
 		_bytes_to_read = other._bytes_to_read;
-		_file_names = other._file_names;
+		_body_size = other._body_size;
+		if (_body_fd != -1) {
+			close(_body_fd);
+		}
+		_body_fd = other._body_fd == -1 ? -1 : dup(other._body_fd);
+		_chunked = other._chunked;
+		_chunk_state = other._chunk_state;
+		_chunk_size = other._chunk_size;
+		_chunk_line_length = other._chunk_line_length;
+		_trailer_size = other._trailer_size;
+		_multipart = other._multipart;
 		_server_listen = other._server_listen;
 		_server_name = other._server_name;
 		_server_config = other._server_config;
+		_keep_alive = other._keep_alive;
 		return *this;
 	}
 
-	Request::~Request() {}
+	Request::~Request() {
+		if (_body_fd != -1) {
+			close(_body_fd);
+		}
+	}
 
-	void Request::init(const char *raw, size_t size, std::vector<ServerConfig> const &server_configs) {
-		_raw = raw;
+	/**
+	 * @brief Parse the next bytes received for this request
+	 * @return number of bytes used, the rest belongs to the next pipelined request
+	 * @note Header bytes are scanned once, a line is parsed when its LF arrives
+	 * and control bytes in the header are rejected.
+	 * Method, path, query and header fields are views into the header buffer,
+	 * strings are only built when asked for. Parsing stops at the first error,
+	 * with status code set.
+	 */
+	size_t Request::feed(const char *raw, size_t size, HostIndex const &hosts) {
+		size_t consumed = 0;
+
+		_started = _started || size > 0;
+		if (_header_size_limit == 0) {
+			set_header_limits(hosts);
+			_raw_header.reserve(REQUEST_HEADER_BUFFER < _header_size_limit ? REQUEST_HEADER_BUFFER : _header_size_limit);
+			_headers.reserve(REQUEST_HEADER_FIELDS);
+		}
 
 		try {
-			// Separate raw to header and body
-			size_t pos = _raw.find("\r\n\r\n");
-			if (pos == std::string::npos) {
-				_status_code = 400;
-				return;
-			}
-			_raw_header = _raw.substr(0, pos);
-			_raw_body.append(raw + pos + 4, size - (_raw_header.size() + 4));
+			while (consumed < size && _status_code == 0 && _parse_state < PARSE_BODY) {
+				const char *start = raw + consumed;
+				bool has_ctl = false;
+				const char *line_end = internal::scan_line(start, size - consumed, has_ctl);
+				size_t chunk_size = line_end == NULL ? size - consumed : line_end - start + 1;
 
-			// Get first line of header
-			pos = _raw_header.find("\r\n");
-			if (pos == std::string::npos) {
-				_status_code = 400;
-				return;
+				if (has_ctl) {
+					_status_code = 400;
+					break;
+				}
+
+				if (_raw_header.size() - _line_start + chunk_size > _header_line_limit) {
+					_status_code = _parse_state == PARSE_REQUEST_LINE ? 414 : 400;
+					break;
+				}
+				if (_raw_header.size() + chunk_size > _header_size_limit) {
+					_status_code = 400;
+					break;
+				}
+
+				_raw_header.append(start, chunk_size);
+				consumed += chunk_size;
+				if (line_end == NULL) {
+					break;
+				}
+
+				BufferView line;
+				line.offset = _line_start;
+				line.length = _raw_header.size() - _line_start - 1;
+				if (line.length > 0 && _raw_header[line.offset + line.length - 1] == '\r') {
+					--line.length;
+				}
+				_line_start = _raw_header.size();
+
+				parse_line(line, hosts);
 			}
-			std::string first_line = _raw_header.substr(0, pos);
 
-			if (!parse_method(first_line) || !parse_path(first_line) || !parse_header() ||
-				!set_server_config(server_configs) || !parse_body()) {
-				return;
+			if (_status_code == 0 && _parse_state == PARSE_BODY) {
+				consumed += _chunked ? consume_chunked(raw + consumed, size - consumed) : consume_body(raw + consumed, size - consumed);
+			}
+			if (_status_code == 0 && _parse_state == PARSE_DONE && _multipart.is_started() && !_multipart.finish()) {
+				_status_code = _multipart.get_status_code();
 			}
 		} catch (const std::exception &e) {
 			_status_code = 500;
-			return;
 		}
+
+		if (_status_code != 0) {
+			_keep_alive = false;
+			_multipart.abort();
+		}
+		return consumed;
 	}
 
 	/**
-	 * @brief Parse method from first line of header
+	 * @brief Check if request is ready for a response, parsed or failed
 	 */
-	bool Request::parse_method(std::string const &first_line) {
-		std::string maybe_method = first_line.substr(0, first_line.find(" "));
+	bool Request::is_complete() const {
+		return _status_code != 0 || _parse_state == PARSE_DONE;
+	}
 
-		for (int i = 0; i < 8; i++) {
-			if (maybe_method == HTTPMethodStrings[i]) {
-				_method = i;
+	/**
+	 * @brief Check if a byte of this request arrived, empty lines before it included
+	 */
+	bool Request::has_started() const {
+		return _started;
+	}
+
+	/**
+	 * @brief Take the default server of the listen and its header limits
+	 * @note Host isn't known yet, like nginx the default server decides
+	 */
+	void Request::set_header_limits(HostIndex const &hosts) {
+		_server_config = &hosts.get_default();
+		_header_line_limit = _server_config->get_large_header_buffers_size();
+		_header_size_limit = _header_line_limit * _server_config->get_large_header_buffers_number();
+	}
+
+	/**
+	 * @brief Parse one complete line of the request line or header block
+	 */
+	bool Request::parse_line(BufferView const &line, HostIndex const &hosts) {
+		if (_parse_state == PARSE_REQUEST_LINE) {
+			// Empty lines before request line are ignored (RFC 7230 3.5)
+			if (line.length == 0) {
+				_raw_header.clear();
+				_line_start = 0;
 				return true;
 			}
+			if (!parse_method(line) || !parse_path(line)) {
+				return false;
+			}
+			_parse_state = PARSE_HEADERS;
+			return true;
 		}
 
-		_method = UNKNOWN;
-		_status_code = 400;
-		return false;
+		if (line.length == 0) {
+			return finish_header(hosts);
+		}
+		return parse_header_field(line);
 	}
 
 	/**
-	 * @brief Parse path and query from first line of header, also ensure it's HTTP/1.1
+	 * @brief Header block is complete, select server and prepare body
 	 */
-	bool Request::parse_path(std::string const &first_line) {
-		std::string maybe_path = first_line.substr(first_line.find(" ") + 1);
-		size_t pos = maybe_path.find(" ");
-		if (pos == std::string::npos || maybe_path.substr(pos + 1) != "HTTP/1.1") {
-			_status_code = 400;
+	bool Request::finish_header(HostIndex const &hosts) {
+		if (!set_server_config(hosts) || !parse_body()) {
 			return false;
 		}
-		_path = maybe_path.substr(0, pos);
-
-		if (_path.empty()) {
-			_status_code = 400;
+		parse_connection();
+		if (!start_upload()) {
 			return false;
 		}
 
-		pos = _path.find("?");
-		if (pos != std::string::npos) {
-			_query = _path.substr(pos + 1);
-			_path = _path.substr(0, pos);
+		_parse_state = _bytes_to_read > 0 || _chunked ? PARSE_BODY : PARSE_DONE;
+		return true;
+	}
+
+	/**
+	 * @brief Append body bytes, never more than Content-Length
+	 * @return number of bytes used
+	 */
+	size_t Request::consume_body(const char *raw, size_t size) {
+		size_t body_size = size < _bytes_to_read ? size : _bytes_to_read;
+
+		if (!append_body(raw, body_size)) {
+			return body_size;
+		}
+		_bytes_to_read -= body_size;
+		if (_bytes_to_read == 0) {
+			_parse_state = PARSE_DONE;
 		}
+		return body_size;
+	}
 
+	/**
+	 * @brief Decode chunked body bytes as they arrive, data goes straight to the body
+	 * @return number of bytes used, stops after the last trailer line
+	 * @note Chunk extensions and trailer fields are skipped, a chunk size line
+	 * or trailer line is held to the header line limit and the trailer to the
+	 * header size limit. The decoded size is checked against
+	 * client_max_body_size when a chunk size is read, before any of its data
+	 * is kept.
+	 */
+	size_t Request::consume_chunked(const char *raw, size_t size) {
+		size_t consumed = 0;
+
+		while (consumed < size && _parse_state == PARSE_BODY) {
+			char c = raw[consumed];
+
+			switch (_chunk_state) {
+				case CHUNK_SIZE:
+					if (std::isxdigit(static_cast<unsigned char>(c))) {
+						if (_chunk_size > (max_body_size() >> 4)) {
+							_status_code = 413;
+							return consumed;
+						}
+						_chunk_size = (_chunk_size << 4) | (std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : (c | 0x20) - 'a' + 10);
+						++_chunk_line_length;
+						break;
+					}
+					if (_chunk_line_length == 0 || (c != ';' && c != ' ' && c != '\t' && c != '\r' && c != '\n')) {
+						_status_code = 400;
+						return consumed;
+					}
+					_chunk_state = CHUNK_EXTENSION;
+					continue;
+				case CHUNK_EXTENSION:
+					if (c != '\n') {
+						if (++_chunk_line_length > _header_line_limit) {
+							_status_code = 400;
+							return consumed;
+						}
+						break;
+					}
+					if (_chunk_size > max_body_size() - _body_size) {
+						_status_code = 413;
+						return consumed;
+					}
+					_chunk_line_length = 0;
+					_chunk_state = _chunk_size > 0 ? CHUNK_DATA : CHUNK_TRAILER;
+					break;
+				case CHUNK_DATA: {
+					size_t data_size = size - consumed < _chunk_size ? size - consumed : _chunk_size;
+					if (!append_body(raw + consumed, data_size)) {
+						return consumed + data_size;
+					}
+					_chunk_size -= data_size;
+					consumed += data_size;
+					if (_chunk_size == 0) {
+						_chunk_state = CHUNK_DATA_END;
+					}
+					continue;
+				}
+				case CHUNK_DATA_END:
+					if (c == '\r' && _chunk_line_length == 0) {
+						_chunk_line_length = 1;
+						break;
+					}
+					if (c != '\n') {
+						_status_code = 400;
+						return consumed;
+					}
+					_chunk_line_length = 0;
+					_chunk_state = CHUNK_SIZE;
+					break;
+				case CHUNK_TRAILER:
+					if (c == '\n') {
+						if (_chunk_line_length == 0) {
+							_parse_state = PARSE_DONE;
+						}
+						_chunk_line_length = 0;
+					} else if (c != '\r' && (++_chunk_line_length > _header_line_limit || ++_trailer_size > _header_size_limit)) {
+						_status_code = 400;
+						return consumed;
+					}
+					break;
+			}
+			++consumed;
+		}
+		return consumed;
+	}
+
+	/**
+	 * @brief Body sink, every decoded body byte goes through here
+	 * @note A body above client_body_buffer_size moves to a temporary file,
+	 * multipart uploads go to their files instead
+	 * @return false if the body couldn't be kept, with status code set
+	 */
+	bool Request::append_body(const char *data, size_t size) {
+		_body_size += size;
+		if (_multipart.is_started()) {
+			if (!_multipart.feed(data, size)) {
+				_status_code = _multipart.get_status_code();
+				return false;
+			}
+			return true;
+		}
+
+		if (_body_fd == -1 && _raw_body.size() + size > (size_t)_server_config->get_client_body_buffer_size() && !spool_body()) {
+			_status_code = 500;
+			return false;
+		}
+		if (_body_fd == -1) {
+			_raw_body.append(data, size);
+			return true;
+		}
+		if (!write_all(_body_fd, data, size)) {
+			LOG_E() << "Failed to write the request body to a temporary file: " << std::strerror(errno) << "\n";
+			_status_code = 500;
+			return false;
+		}
 		return true;
 	}
 
 	/**
-	 * @brief Parse all the header fields
+	 * @brief Move the body received so far to a temporary file in client_body_temp_path
 	 */
-	bool Request::parse_header() {
-		std::string headers = _raw_header.substr(_raw_header.find("\r\n") + 2);
-		try {
-			_headers = parse_header_fields(headers);
-		} catch (const std::logic_error& e) {
-			_status_code = 400;
+	bool Request::spool_body() {
+		_body_fd = open_temp_file(_server_config->get_client_body_temp_path());
+		if (_body_fd == -1 || !write_all(_body_fd, _raw_body.data(), _raw_body.size())) {
+			LOG_E() << "Failed to spool the request body in " << _server_config->get_client_body_temp_path() << ": " << std::strerror(errno) << "\n";
 			return false;
 		}
+		std::string().swap(_raw_body);
 		return true;
 	}
 
 	/**
-	 * @brief Set server config and server name accordingly with host header
+	 * @brief client_max_body_size of the server, unlimited when it isn't set
 	 */
-	bool Request::set_server_config(std::vector<ServerConfig> const &server_configs) {
-		std::vector<ServerConfig> possible_server_configs;
-		std::vector<ServerConfig>::const_iterator it = server_configs.begin();
-		for (; it != server_configs.end(); ++it) {
-			if (it->get_listens().count(_server_listen) > 0)
-				possible_server_configs.push_back(*it);
+	size_t Request::max_body_size() const {
+		if (_server_config->get_client_max_body_size() < 0) {
+			return static_cast<size_t>(-1);
 		}
+		return static_cast<size_t>(_server_config->get_client_max_body_size());
+	}
 
-		if (possible_server_configs.empty()) {
-			_status_code = 404;
-			return false;
+	/**
+	 * @brief Parse method from first line of header
+	 */
+	bool Request::parse_method(BufferView const &first_line) {
+		const char *line = view_data(first_line);
+		const char *space = static_cast<const char *>(std::memchr(line, ' ', first_line.length));
+		size_t method_length = space == NULL ? first_line.length : space - line;
+
+		_method = lookup_method(line, method_length);
+		if (_method != UNKNOWN) {
+			return true;
 		}
 
-		if (_headers.count("Host") == 0) {
+		_status_code = 400;
+		return false;
+	}
+
+	/**
+	 * @brief Parse path and query from first line of header, also ensure it's HTTP/1.1
+	 */
+	bool Request::parse_path(BufferView const &first_line) {
+		const char *line = view_data(first_line);
+		const char *line_end = line + first_line.length;
+		const char *space = static_cast<const char *>(std::memchr(line, ' ', first_line.length));
+		const char *path = space == NULL ? line_end : space + 1;
+		const char *path_end = static_cast<const char *>(std::memchr(path, ' ', line_end - path));
+		if (path_end == NULL || line_end - path_end != 9 || std::memcmp(path_end + 1, "HTTP/1.1", 8) != 0
+			|| path_end == path) {
 			_status_code = 400;
 			return false;
 		}
 
-		std::string host_name = _headers.at("Host");
-		host_name = host_name.substr(0, host_name.find_first_of(":"));
+		_path.offset = path - _raw_header.data();
+		_path.length = path_end - path;
 
-		std::vector<ServerConfig>::const_iterator s_it = possible_server_configs.begin();
-		for (; s_it != possible_server_configs.end(); ++s_it) {
-			if (s_it->get_server_names().count(host_name) > 0) {
-				_server_name = host_name;
-				_server_config = *s_it;
-				return true;
-			}
+		const char *query = static_cast<const char *>(std::memchr(path, '?', _path.length));
+		if (query != NULL) {
+			_path.length = query - path;
+			_query.offset = _path.offset + _path.length + 1;
+			_query.length = path_end - query - 1;
 		}
 
-		_server_name = *possible_server_configs.at(0).get_server_names().begin();
-		_server_config = possible_server_configs.at(0);
 		return true;
 	}
 
 	/**
-	 * @brief Parse body of request
+	 * @brief Parse one "Name: value" header field
+	 * @note Field names are case-insensitive tokens. Repeated fields are kept and
+	 * joined when read, except the ones that must be unique.
 	 */
-	bool Request::parse_body() {
-		// Set amount of bytes to read if there's "Content-Length"
-		if (_bytes_to_read == 0 && _headers.count("Content-Length") > 0) {
-			_bytes_to_read = static_cast<size_t>(std::atol(_headers["Content-Length"].c_str()));
+	bool Request::parse_header_field(BufferView const &line) {
+		const char *data = view_data(line);
+		const char *colon = internal::scan_token(data, line.length);
+		if (colon == data || colon == data + line.length || *colon != ':') {
+			_status_code = 400;
+			return false;
+		}
 
-			if (_bytes_to_read > (size_t)_server_config.get_client_max_body_size()) {
-				_status_code = 413;
-				return false;
-			}
+		HeaderField field;
+		field.name.offset = line.offset;
+		field.name.length = colon - data;
 
-			if (_bytes_to_read > 0 && !_raw_body.empty()) {
-				if (_bytes_to_read < _raw_body.size()) {
-					_status_code = 400;
-					return false;
-				}
-				_bytes_to_read -= _raw_body.size();
-			}
+		size_t value_start = field.name.length + 1;
+		size_t value_end = line.length;
+		while (value_start < value_end && (data[value_start] == ' ' || data[value_start] == '\t')) {
+			++value_start;
+		}
+		while (value_end > value_start && (data[value_end - 1] == ' ' || data[value_end - 1] == '\t')) {
+			--value_end;
+		}
+		field.value.offset = line.offset + value_start;
+		field.value.length = value_end - value_start;
+
+		field.id = lookup_header(data, field.name.length);
+		if ((field.id == HEADER_HOST || field.id == HEADER_CONTENT_LENGTH || field.id == HEADER_CONTENT_TYPE)
+			&& find_header(field.id) != NULL) {
+			_status_code = 400;
+			return false;
 		}
 
+		_headers.push_back(field);
 		return true;
 	}
 
+	const char *Request::view_data(BufferView const &view) const {
+		return _raw_header.data() + view.offset;
+	}
+
+	std::string Request::view_to_string(BufferView const &view) const {
+		return std::string(view_data(view), view.length);
+	}
+
 	/**
-	 * @brief Append raw buffer to body
-	 * @return boolean indicating if body is complete, not for error
-	 * @note In case of error, body is completed and status code is set
+	 * @brief Case-insensitive search of str in view
 	 */
-	bool Request::append_body(char const *raw, size_t size) {
-		if (_bytes_to_read < size) {
-			_status_code = 400;
-			return true;
+	bool Request::view_contains(BufferView const &view, const char *str) const {
+		size_t str_length = std::strlen(str);
+		const char *data = view_data(view);
+
+		for (size_t i = 0; i + str_length <= view.length; ++i) {
+			if (strncasecmp(data + i, str, str_length) == 0) {
+				return true;
+			}
 		}
+		return false;
+	}
 
-		_raw_body.append(raw, size);
-		_bytes_to_read -= size;
-		return _bytes_to_read == 0;
+	/**
+	 * @brief First header field with id following after if given
+	 * @return field or NULL if there's none
+	 */
+	const HeaderField *Request::find_header(HeaderId id, const HeaderField *after) const {
+		std::vector<HeaderField>::const_iterator it = _headers.begin();
+		if (after != NULL) {
+			it += after - &_headers[0] + 1;
+		}
+
+		for (; it != _headers.end(); ++it) {
+			if (it->id == id) {
+				return &*it;
+			}
+		}
+		return NULL;
 	}
 
 	/**
-	 * @brief Check if request has file upload
+	 * @brief First header field named name, case-insensitive, following after if given
+	 * @note Well-known names are compared by id
+	 * @return field or NULL if there's none
 	 */
-	bool Request::has_files() const {
-		return _headers.count("Content-Type") > 0 && _headers.at("Content-Type").find("multipart/form-data") != std::string::npos;
+	const HeaderField *Request::find_header(const char *name, const HeaderField *after) const {
+		size_t name_length = std::strlen(name);
+		HeaderId id = lookup_header(name, name_length);
+		if (id != HEADER_UNKNOWN) {
+			return find_header(id, after);
+		}
+
+		std::vector<HeaderField>::const_iterator it = _headers.begin();
+		if (after != NULL) {
+			it += after - &_headers[0] + 1;
+		}
+
+		for (; it != _headers.end(); ++it) {
+			if (it->id == HEADER_UNKNOWN && it->name.length == name_length
+				&& strncasecmp(view_data(it->name), name, name_length) == 0) {
+				return &*it;
+			}
+		}
+		return NULL;
+	}
+
+	bool Request::has_header(HeaderId id) const {
+		return find_header(id) != NULL;
+	}
+
+	bool Request::has_header(const char *name) const {
+		return find_header(name) != NULL;
 	}
 
 	/**
-	 * @brief Write all upload files
+	 * @brief Value of header field, repeated fields joined with ", "
+	 * @return value or empty string if there's none
 	 */
-	bool Request::write_files(std::string const &path) {
-		if (!has_files()) {
-			return false;
+	std::string Request::get_header(HeaderId id) const {
+		const HeaderField *field = find_header(id);
+		if (field == NULL) {
+			return "";
 		}
 
-		// Get boundary
-		std::string content_type = _headers.at("Content-Type");
-		if (content_type.find("boundary=") == std::string::npos) {
-			_status_code = 400;
-			return false;
+		std::string value = view_to_string(field->value);
+		while ((field = find_header(id, field)) != NULL) {
+			value += ", ";
+			value.append(view_data(field->value), field->value.length);
 		}
-		std::string boundary = content_type.substr(content_type.find("boundary=") + 9);
-		if (boundary.empty()) {
+		return value;
+	}
+
+	std::string Request::get_header(const char *name) const {
+		const HeaderField *field = find_header(name);
+		if (field == NULL) {
+			return "";
+		}
+
+		std::string value = view_to_string(field->value);
+		while ((field = find_header(name, field)) != NULL) {
+			value += ", ";
+			value.append(view_data(field->value), field->value.length);
+		}
+		return value;
+	}
+
+	/**
+	 * @brief Case of a header field name as usually written, "content-TYPE" gives "Content-Type"
+	 */
+	std::string Request::canonical_header_name(std::string const &name) {
+		std::string canonical = name;
+		bool word_start = true;
+
+		for (size_t i = 0; i < canonical.size(); ++i) {
+			canonical[i] = word_start ? std::toupper(canonical[i]) : std::tolower(canonical[i]);
+			word_start = canonical[i] == '-';
+		}
+		return canonical;
+	}
+
+	/**
+	 * @brief Set server config and server name accordingly with host header
+	 * @note A host no server of the listen is named after goes to the default server
+	 */
+	bool Request::set_server_config(HostIndex const &hosts) {
+		const HeaderField *host = find_header(HEADER_HOST);
+		if (host == NULL) {
 			_status_code = 400;
 			return false;
 		}
 
-		std::string body = _raw_body;
-		size_t pos = body.find("--" + boundary + "\r\n");
-		for (; !body.empty() && pos != std::string::npos; pos = body.find("--" + boundary + "\r\n")) {
-			std::string chunk = body.substr(pos + boundary.size() + 4);
+		const char *host_name = view_data(host->value);
+		const char *port = static_cast<const char *>(std::memchr(host_name, ':', host->value.length));
+		size_t host_length = port == NULL ? host->value.length : port - host_name;
 
-			// Get chunk header and file data
-			size_t file_data_pos = chunk.find("\r\n\r\n");
-			if (file_data_pos == std::string::npos) {
-				_status_code = 400;
-				return false;
+		const ServerConfig *server_config = hosts.find(host_name, host_length);
+		if (server_config != NULL) {
+			_server_name.assign(host_name, host_length);
+			for (size_t i = 0; i < _server_name.size(); ++i) {
+				_server_name[i] = std::tolower(_server_name[i]);
 			}
-			std::string chunk_header = chunk.substr(0, file_data_pos);
-			std::string file_data = chunk.substr(file_data_pos + 4);
-			size_t file_data_end_pos = file_data.find("\r\n--" + boundary);
-			if (file_data_end_pos == std::string::npos) {
-				_status_code = 400;
+			_server_config = server_config;
+			return true;
+		}
+
+		_server_name = *hosts.get_default().get_server_names().begin();
+		_server_config = &hosts.get_default();
+		return true;
+	}
+
+	/**
+	 * @brief Parse a Content-Length value, 1*DIGIT (RFC 7230 3.3.2)
+	 * @return false on anything else or if it overflows
+	 */
+	static bool parse_content_length(const char *value, size_t length, size_t &content_length) {
+		content_length = 0;
+		if (length == 0) {
+			return false;
+		}
+		for (size_t i = 0; i < length; ++i) {
+			if (value[i] < '0' || value[i] > '9') {
 				return false;
 			}
-			body = file_data.substr(file_data_end_pos + 2);
-			file_data = file_data.substr(0, file_data_end_pos);
-
-			// Check if end of boundary and set body
-			if (body.substr(0, boundary.size() + 6) == "--" + boundary + "--\r\n") {
-				if (body.substr(boundary.size() + 6).empty()) {
-					body.clear();
-				} else {
-					_status_code = 400;
-					return false;
-				}
-			}
-
-			std::map<std::string, std::string> chunk_headers;
-			try {
-				chunk_headers = parse_header_fields(chunk_header);
-			} catch (const std::logic_error &e) {
-				_status_code = 400;
+			size_t digit = value[i] - '0';
+			if (content_length > (std::numeric_limits<size_t>::max() - digit) / 10) {
 				return false;
 			}
+			content_length = content_length * 10 + digit;
+		}
+		return true;
+	}
 
-			// Validate Content-Disposition
-			if (chunk_headers.count("Content-Disposition") == 0) {
+	/**
+	 * @brief Parse body of request
+	 * @note Only "chunked" transfer coding is known, a message with both
+	 * Transfer-Encoding and Content-Length is rejected (RFC 7230 3.3.3)
+	 */
+	bool Request::parse_body() {
+		const HeaderField *content_length = find_header(HEADER_CONTENT_LENGTH);
+		const HeaderField *transfer_encoding = find_header(HEADER_TRANSFER_ENCODING);
+		if (transfer_encoding != NULL) {
+			if (content_length != NULL) {
 				_status_code = 400;
 				return false;
 			}
-			std::string content_disposition = chunk_headers.at("Content-Disposition");
-			if (content_disposition.find("form-data; name=\"") == std::string::npos) {
-				_status_code = 400;
+			if (find_header(HEADER_TRANSFER_ENCODING, transfer_encoding) != NULL || transfer_encoding->value.length != 7
+				|| strncasecmp(view_data(transfer_encoding->value), "chunked", 7) != 0) {
+				_status_code = 501;
 				return false;
 			}
+			_chunked = true;
+			return true;
+		}
 
-			// Get file name, if no file name, skip
-			if (content_disposition.find("; filename=\"") == std::string::npos) {
-				continue;
-			}
-			std::string file_name = content_disposition.substr(content_disposition.find("; filename=\"") + 12);
-			if (file_name.empty() || file_name.find("\"") == std::string::npos) {
+		// Set amount of bytes to read if there's "Content-Length"
+		if (_bytes_to_read == 0 && content_length != NULL) {
+			if (!parse_content_length(view_data(content_length->value), content_length->value.length, _bytes_to_read)) {
 				_status_code = 400;
 				return false;
 			}
-			file_name = file_name.substr(0, file_name.find("\""));
-			try {
-				string_to_file(path + file_name, file_data);
-				_file_names.push_back(file_name);
-			} catch (const std::runtime_error &e) {
-				_status_code = 500;
+			if (_bytes_to_read > max_body_size()) {
+				_status_code = 413;
 				return false;
 			}
 		}
+
+		return true;
+	}
+
+	/**
+	 * @brief Decide if connection can be reused after this request
+	 * @note HTTP/1.1 connections are persistent unless client sent "Connection: close"
+	 */
+	void Request::parse_connection() {
+		_keep_alive = _server_config->get_keepalive_timeout() > 0 && _server_config->get_keepalive_requests() > 0;
+
+		for (const HeaderField *field = find_header(HEADER_CONNECTION); field != NULL; field = find_header(HEADER_CONNECTION, field)) {
+			if (view_contains(field->value, "close")) {
+				_keep_alive = false;
+			}
+		}
+	}
+
+	/**
+	 * @brief Check if request has file upload
+	 */
+	bool Request::has_files() const {
+		const HeaderField *content_type = find_header(HEADER_CONTENT_TYPE);
+		return content_type != NULL && view_contains(content_type->value, "multipart/form-data");
+	}
+
+	/**
+	 * @brief Stream the files of a multipart POST to the upload directory while the body arrives
+	 * @note Only when the location takes the upload itself, a body for CGI or
+	 * for an error response is kept in memory as before
+	 */
+	bool Request::start_upload() {
+		if (_method != POST || !has_files()) {
+			return true;
+		}
+
+		std::string path = get_path();
+		const LocationConfig *location_config = _server_config->find_location(path);
+		if (location_config == NULL || location_config->get_allow_methods().count(HTTPMethodStrings[POST]) == 0
+			|| !location_config->get_cgi_path().empty() || !location_config->get_redirect().empty()) {
+			return true;
+		}
+
+		std::string content_type = get_header(HEADER_CONTENT_TYPE);
+		size_t boundary = content_type.find("boundary=");
+		if (boundary == std::string::npos) {
+			_status_code = 400;
+			return false;
+		}
+		boundary += 9;
+		size_t boundary_end = content_type.find(';', boundary);
+		std::string boundary_value = content_type.substr(boundary, boundary_end == std::string::npos ? std::string::npos : boundary_end - boundary);
+		if (boundary_value.size() >= 2 && boundary_value[0] == '"' && boundary_value[boundary_value.size() - 1] == '"') {
+			boundary_value = boundary_value.substr(1, boundary_value.size() - 2);
+		}
+
+		std::string root = location_config->get_root().empty() ? _server_config->get_root() : location_config->get_root();
+		if (path[path.size() - 1] != '/') {
+			path += "/";
+		}
+		if (!_multipart.start(boundary_value, root + path)) {
+			_status_code = 400;
+			return false;
+		}
 		return true;
 	}
 
+	/**
+	 * @brief Build all header fields, names as "Content-Length", repeated fields joined
+	 * @note Allocates every name and value, prefer get_header
+	 */
+	std::map<std::string, std::string> Request::get_headers() const {
+		std::map<std::string, std::string> headers;
+
+		std::vector<HeaderField>::const_iterator it = _headers.begin();
+		for (; it != _headers.end(); ++it) {
+			std::string name = canonical_header_name(view_to_string(it->name));
+			std::map<std::string, std::string>::iterator header = headers.find(name);
+			if (header == headers.end()) {
+				headers.insert(std::make_pair(name, view_to_string(it->value)));
+			} else {
+				header->second += ", " + view_to_string(it->value);
+			}
+		}
+		return headers;
+	}
+
+	void Request::set_keep_alive(bool keep_alive) {
+		_keep_alive = keep_alive;
+	}
+
 	// Getters
 	int const									&Request::get_status_code() const { return (_status_code); }
 	struct sockaddr_in const					&Request::get_client() const { return (_client); }
+	ParseState const							&Request::get_parse_state() const { return (_parse_state); }
 	int const									&Request::get_method() const { return (_method); }
-	std::string const							&Request::get_path() const { return (_path); }
-	std::string const							&Request::get_query() const { return (_query); }
-	std::map<std::string, std::string> const	&Request::get_headers() const { return (_headers); }
+	std::string									Request::get_path() const { return (view_to_string(_path)); }
+	std::string									Request::get_query() const { return (view_to_string(_query)); }
 	std::string const							&Request::get_body() const { return (_raw_body); }
 	size_t const								&Request::get_bytes_to_read() const { return (_bytes_to_read); }
-	std::vector<std::string> const				&Request::get_file_names() const { return (_file_names); }
+	size_t const								&Request::get_body_size() const { return (_body_size); }
+	int const									&Request::get_body_fd() const { return (_body_fd); }
+	bool const									&Request::is_chunked() const { return (_chunked); }
+	std::vector<std::string> const				&Request::get_file_names() const { return (_multipart.get_file_names()); }
 	Listen const								&Request::get_server_listen() const { return (_server_listen); }
 	std::string const							&Request::get_server_name() const { return (_server_name); }
-	ServerConfig const							&Request::get_server_config() const { return (_server_config); }
+	ServerConfig const							&Request::get_server_config() const {
+		static const ServerConfig	no_server_config;
+
+		return (_server_config == NULL ? no_server_config : *_server_config);
+	}
+	bool const									&Request::is_keep_alive() const { return (_keep_alive); }
 } /* namespace webserv */
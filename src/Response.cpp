@@ -1,16 +1,69 @@
 #include "Response.hpp"
 
 namespace webserv {
-	Response::Response(Request& request) :
+	/**
+	 * @brief Strong entity tag of a file, the hex mtime and size like nginx
+	 */
+	static std::string make_etag(const time_t& mtime, const off_t& size) {
+		std::stringstream ss;
+		ss << std::hex << '"' << mtime << '-' << size << '"';
+		return ss.str();
+	}
+
+	/**
+	 * @brief Whether the If-None-Match list has etag, comparing weakly, or is "*"
+	 */
+	static bool is_etag_listed(const std::string& list, const std::string& etag) {
+		size_t pos = 0;
+		while (pos < list.size()) {
+			size_t end = list.find(',', pos);
+			if (end == std::string::npos) {
+				end = list.size();
+			}
+
+			std::string tag = list.substr(pos, end - pos);
+			size_t first = tag.find_first_not_of(" \t");
+			if (first != std::string::npos) {
+				tag = tag.substr(first, tag.find_last_not_of(" \t") + 1 - first);
+				if (tag.compare(0, 2, "W/") == 0) {
+					tag.erase(0, 2);
+				}
+				if (tag == "*" || (!etag.empty() && tag == etag)) {
+					return true;
+				}
+			}
+			pos = end + 1;
+		}
+		return false;
+	}
+
+	Response::Response(Request& request, internal::OpenFileCache* open_file_cache, internal::ResponseCache* response_cache,
+		internal::BoundaryGenerator* boundaries) :
 		_request(request),
 		_status_code(request.get_status_code()),
 		_server_name(request.get_server_name()),
 		_server_config(request.get_server_config()),
 		_autoindex(false),
 		_is_custom_error_page(false),
-		_cgi_error(false) {}
-
-	Response::~Response() {}
+		_cgi_error(false),
+		_location_config(NULL),
+		_file_fd(-1),
+		_file_size(0),
+		_file_mtime(0),
+		_compress_file(false),
+		_open_file_cache(open_file_cache),
+		_response_cache(response_cache),
+		_boundaries(boundaries),
+		_cached() {}
+
+	Response::~Response() {
+		if (_file_fd != -1) {
+			close(_file_fd);
+		}
+		if (_cached.buffer != NULL) {
+			_cached.buffer->release();
+		}
+	}
 
 	/**
 	 * @brief Process the request and setup the response accordingly
@@ -26,9 +79,13 @@ namespace webserv {
 				return set_error_response();
 			}
 
-			if (!_location_config.get_redirect().empty()) {
+			if (!_location_config->get_redirect().empty()) {
 				_status_code = 302;
-				_redirect = rtrim(_location_config.get_redirect(), "/") + _target.substr(rtrim(_location_config.get_location(), "/").length());
+				// A prefix location keeps what follows its uri, the others redirect as is
+				_redirect = _location_config->get_redirect();
+				if (_location_config->is_prefix()) {
+					_redirect = rtrim(_redirect, "/") + _target.substr(rtrim(_location_config->get_location(), "/").length());
+				}
 				return set_redirect_response();
 			}
 
@@ -59,30 +116,23 @@ namespace webserv {
 	 * @return true on success otherwise false and set status code to 404
 	 */
 	bool Response::set_location_config() {
-		std::string location;
-		std::string path = _request.get_path();
-		if (path.at(path.size() - 1) != '/') {
-			path += "/";
-		}
-		size_t length = path.size();
-
-		for (; length > 0; --length) {
-			location = path.substr(0, length);
-			if (_server_config.get_locations().count(location)) {
-				_location_config = _server_config.get_locations().at(location);
-				_target = path;
-
-				if (_location_config.get_root().empty()) {
-					_root = _server_config.get_root();
-				} else {
-					_root = _location_config.get_root();
-				}
-				return true;
-			}
+		const LocationConfig* location_config = _server_config.find_location(_request.get_path());
+		if (location_config == NULL) {
+			_status_code = 404;
+			return false;
 		}
 
-		_status_code = 404;
-		return false;
+		_location_config = location_config;
+		_target = _request.get_path();
+		if (_target.empty() || _target[_target.size() - 1] != '/') {
+			_target += "/";
+		}
+		if (_location_config->get_root().empty()) {
+			_root = _server_config.get_root();
+		} else {
+			_root = _location_config->get_root();
+		}
+		return true;
 	}
 
 	/**
@@ -90,24 +140,24 @@ namespace webserv {
 	 * @return true on success otherwise 405 Method not allow or 404 CGI bin not found
 	 */
 	bool Response::set_method() {
-		if (_location_config.get_allow_methods().count(HTTPMethodStrings[_request.get_method()]) == 0) {
+		if (_location_config->get_allow_methods().count(HTTPMethodStrings[_request.get_method()]) == 0) {
 			_status_code = 405;
 			return false;
 		}
 
-		if (!_location_config.get_cgi_path().empty()) {
-			_cgi_path = _location_config.get_cgi_path();
+		if (!_location_config->get_cgi_path().empty()) {
+			_cgi_path = _location_config->get_cgi_path();
 			if (access(_cgi_path.c_str(), X_OK) == -1) {
 				_status_code = 404;
 				return false;
 			}
 
-			if (!is_extension(rtrim(_target, "/"), _location_config.get_cgi_extension())) {
+			if (!is_extension(rtrim(_target, "/"), _location_config->get_cgi_extension())) {
 				_status_code = 403;
 				return false;
 			}
 
-			if (!is_extension(rtrim(_target, "/"), _location_config.get_cgi_extension())) {
+			if (!is_extension(rtrim(_target, "/"), _location_config->get_cgi_extension())) {
 				_status_code = 403;
 				return false;
 			}
@@ -121,7 +171,7 @@ namespace webserv {
 	 */
 	void Response::process_cgi() {
 		setup_cgi_env();
-		std::string cgi_data = run_cgi_script(_cgi_env, _request.get_body());
+		std::string cgi_data = run_cgi_script(_cgi_env, _request.get_body(), _request.get_body_fd());
 
 		size_t pos = cgi_data.find("\r\n\r\n");
 		if (pos == std::string::npos) {
@@ -156,23 +206,35 @@ namespace webserv {
 	 * @brief Process GET method and setup response
 	 */
 	void Response::process_get() {
-		std::string file_content;
+		internal::OpenFileInfo file;
+		std::string path = find_precompressed(rtrim(_root + _target, "/"));
+		bool cacheable = is_cacheable_request();
+
+		if (cacheable && use_cached_response(path)) {
+			_status_code = 200;
+			return;
+		}
 
-		if (isPathFile(_root + _target)) {
-			try {
-				_body = file_to_string(rtrim(_root + _target, "/"));
-			} catch (const std::exception& e) {
+		if (open_path(path, file) && file.is_file()) {
+			if (file.fd == -1) {
 				_status_code = 403;
 			}
-		} else if (_location_config.get_autoindex() && rtrim(_location_config.get_location(), "/") == rtrim(_target, "/")) {
+			_file_fd = file.fd;
+			_file_size = file.size;
+			_file_mtime = file.mtime;
+		} else if (_location_config->get_autoindex()
+			&& (!_location_config->is_prefix() || rtrim(_location_config->get_location(), "/") == rtrim(_target, "/"))) {
 			_autoindex = true;
 			set_autoindex_body();
 		} else {
-			_target = _root + _target + (_location_config.get_index().empty() ? _server_config.get_index() : _location_config.get_index());
+			_target = _root + _target + (_location_config->get_index().empty() ? _server_config.get_index() : _location_config->get_index());
+			path = find_precompressed(_target);
 
-			try {
-				_body = file_to_string(_target);
-			} catch (const std::exception& e) {
+			if (cacheable && use_cached_response(path)) {
+				_status_code = 200;
+				return;
+			}
+			if (!open_file(path)) {
 				_status_code = 404;
 			}
 		}
@@ -182,23 +244,354 @@ namespace webserv {
 		}
 
 		_status_code = 200;
+		if (_file_fd != -1 && should_compress(get_mime_type(rtrim(_target, "/")), _file_size)) {
+			// Like nginx, a compressed body has no length to take ranges of
+			_content_encoding = "gzip";
+			_compress_file = true;
+		}
+		if (_file_fd != -1 && is_not_modified()) {
+			close(_file_fd);
+			_file_fd = -1;
+			_status_code = 304;
+			return set_not_modified_response();
+		}
+		if (_file_fd != -1 && !_compress_file && !set_ranges()) {
+			return set_error_response();
+		}
 		set_response();
 	}
 
+	/**
+	 * @brief Whether the cached full response of a file answers this GET
+	 * @note Not with a Range or validators of the client, they are handled on the fd
+	 */
+	bool Response::is_cacheable_request() const {
+		return _request.get_header(HEADER_RANGE).empty() && _request.get_header(HEADER_IF_NONE_MATCH).empty()
+			&& _request.get_header(HEADER_IF_MODIFIED_SINCE).empty();
+	}
+
+	/**
+	 * @brief Whether the validators of the request still match the file
+	 * @note If-None-Match takes precedence over If-Modified-Since, see RFC 9110 13.2.2
+	 */
+	bool Response::is_not_modified() const {
+		std::string if_none_match = _request.get_header(HEADER_IF_NONE_MATCH);
+		if (!if_none_match.empty()) {
+			return is_etag_listed(if_none_match, _location_config->get_etag() ? make_etag(_file_mtime, _file_size) : "");
+		}
+
+		std::string if_modified_since = _request.get_header(HEADER_IF_MODIFIED_SINCE);
+		if (if_modified_since.empty()) {
+			return false;
+		}
+		std::time_t since = parse_http_date(if_modified_since);
+		return since != -1 && _file_mtime <= since;
+	}
+
+	/**
+	 * @brief Serve the ranges of the file the Range field asks for, unless
+	 * If-Range names another version of the file
+	 * @note One range is sent as is, several as multipart/byteranges whose
+	 * part heads are built here. Either way the bytes come from the fd.
+	 * @return false if no range is satisfiable, the status is then 416
+	 */
+	bool Response::set_ranges() {
+		std::string field = _request.get_header(HEADER_RANGE);
+		if (field.empty() || !is_if_range_current()) {
+			return true;
+		}
+
+		switch (parse_byte_ranges(field, _file_size, _ranges)) {
+			case RANGES_IGNORED:
+				return true;
+			case RANGES_UNSATISFIABLE:
+				_status_code = 416;
+				_content_range = "bytes */" + to_string(_file_size);
+				return false;
+			default:
+				break;
+		}
+
+		_status_code = 206;
+		if (_ranges.size() == 1) {
+			_content_range = format_content_range(_ranges[0], _file_size);
+			return true;
+		}
+
+		_boundary = _boundaries == NULL ? internal::BoundaryGenerator().next() : _boundaries->next();
+		const std::string& mime_type = get_mime_type(rtrim(_target, "/"));
+		for (size_t i = 0; i < _ranges.size(); ++i) {
+			_range_heads.push_back(CRLF "--" + _boundary + CRLF "Content-Type: " + mime_type + CRLF
+				"Content-Range: " + format_content_range(_ranges[i], _file_size) + CRLF CRLF);
+		}
+		_range_heads.push_back(CRLF "--" + _boundary + "--" CRLF);
+		return true;
+	}
+
+	/**
+	 * @brief Whether the If-Range field, if any, still names the file
+	 * @note The ETag compares strongly, the date must be the Last-Modified one
+	 */
+	bool Response::is_if_range_current() const {
+		std::string if_range = _request.get_header(HEADER_IF_RANGE);
+		if (if_range.empty() || if_range == format_http_date(_file_mtime)) {
+			return true;
+		}
+		return _location_config->get_etag() && if_range == make_etag(_file_mtime, _file_size);
+	}
+
+	/**
+	 * @brief Bytes of the file body, the ranges and their part heads if ranged
+	 */
+	off_t Response::get_content_length() const {
+		if (_ranges.empty()) {
+			return _file_size;
+		}
+
+		off_t length = 0;
+		for (size_t i = 0; i < _ranges.size(); ++i) {
+			length += _ranges[i].end - _ranges[i].start;
+		}
+		for (size_t i = 0; i < _range_heads.size(); ++i) {
+			length += _range_heads[i].size();
+		}
+		return length;
+	}
+
+	/**
+	 * @brief Open and stat path, through the open file cache of the worker if any
+	 * @return true if path exists, info.fd is only open on a readable regular file
+	 */
+	bool Response::open_path(const std::string& path, internal::OpenFileInfo& info) {
+		if (_open_file_cache == NULL) {
+			return internal::OpenFileCache::open_uncached(path, info);
+		}
+		return _open_file_cache->open(path, info);
+	}
+
+	/**
+	 * @brief Stat path, through the open file cache of the worker if any
+	 * @return true if path exists, info.fd is never open
+	 */
+	bool Response::stat_path(const std::string& path, internal::OpenFileInfo& info) {
+		if (_open_file_cache != NULL) {
+			return _open_file_cache->lookup(path, info);
+		}
+		if (!internal::OpenFileCache::open_uncached(path, info)) {
+			return false;
+		}
+		if (info.fd != -1) {
+			close(info.fd);
+			info.fd = -1;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Path of the precompressed sibling of the regular file at path,
+	 * if the location serves them and the client accepts its coding
+	 * @note Like nginx gzip_static and brotli_static, path.br then path.gz
+	 * are tried and taken if at least as new as the file. The Content-Type
+	 * stays the one of the file, _content_encoding is set to the coding.
+	 * @return the sibling, or path if there is none to serve
+	 */
+	std::string Response::find_precompressed(const std::string& path) {
+		if (!has_static_encodings()) {
+			return path;
+		}
+
+		std::string accept_encoding = _request.get_header(HEADER_ACCEPT_ENCODING);
+		internal::OpenFileInfo file;
+		if (accept_encoding.empty() || !stat_path(path, file) || !file.is_file()) {
+			return path;
+		}
+
+		static const char* const codings[] = { "br", "gzip" };
+		static const char* const extensions[] = { ".br", ".gz" };
+		const bool enabled[] = { _location_config->get_brotli_static(), _location_config->get_gzip_static() };
+		for (size_t i = 0; i < sizeof(codings) / sizeof(*codings); ++i) {
+			internal::OpenFileInfo sibling;
+			if (enabled[i] && is_coding_accepted(accept_encoding, codings[i])
+				&& stat_path(path + extensions[i], sibling) && sibling.is_file() && sibling.mtime >= file.mtime) {
+				_content_encoding = codings[i];
+				return path + extensions[i];
+			}
+		}
+		return path;
+	}
+
+	/**
+	 * @brief Whether files of the location may be sent precompressed, they vary on Accept-Encoding
+	 */
+	bool Response::has_static_encodings() const {
+		return _location_config->get_gzip_static() || _location_config->get_brotli_static();
+	}
+
+	/**
+	 * @brief Whether responses of the location depend on Accept-Encoding
+	 */
+	bool Response::varies_on_encoding() const {
+		return _location_config != NULL && (has_static_encodings() || _location_config->get_gzip());
+	}
+
+	/**
+	 * @brief Whether a body of mime_type and length is gzip compressed on the fly
+	 * @note Needs gzip on in the location, a type of gzip_types or "*", at
+	 * least gzip_min_length bytes, a client accepting gzip and no other coding
+	 */
+	bool Response::should_compress(const std::string& mime_type, const off_t& length) const {
+		if (_location_config == NULL || !_location_config->get_gzip() || !_content_encoding.empty()
+			|| length < _location_config->get_gzip_min_length()) {
+			return false;
+		}
+
+		const std::set<std::string>& types = _location_config->get_gzip_types();
+		if (types.count(mime_type) == 0 && types.count("*") == 0) {
+			return false;
+		}
+		return is_coding_accepted(_request.get_header(HEADER_ACCEPT_ENCODING), "gzip");
+	}
+
+	/**
+	 * @brief Compress the body in memory with gzip, if it should be
+	 * @return true if the body is now compressed
+	 */
+	bool Response::compress_body(const std::string& mime_type) {
+		if (!should_compress(mime_type, _body.size())) {
+			return false;
+		}
+
+		if (!GzipStream::compress_string(_body, _location_config->get_gzip_comp_level())) {
+			return false;
+		}
+		_content_encoding = "gzip";
+		return true;
+	}
+
+	/**
+	 * @brief Open the regular file at path as the body, it is sent from the fd
+	 * @note The body never goes through memory, see Connection::queue_file
+	 */
+	bool Response::open_file(const std::string& path) {
+		internal::OpenFileInfo file;
+		if (!open_path(path, file) || file.fd == -1) {
+			return false;
+		}
+
+		_file_fd = file.fd;
+		_file_size = file.size;
+		_file_mtime = file.mtime;
+		return true;
+	}
+
+	/**
+	 * @brief Take the response of the small regular file at path from the
+	 * response cache, adding it on a miss
+	 * @note The status, configs and Content-Type are the ones this response
+	 * would be built with, the file version comes from the open file cache.
+	 * A precompressed sibling, or a file compressed on the fly, is cached
+	 * under its path, a NUL and its coding, apart from the file sent as is.
+	 * @return false if there is no cache, the file isn't a small regular file
+	 * or the response has a Content-Range
+	 */
+	bool Response::use_cached_response(const std::string& path) {
+		if (_response_cache == NULL || _open_file_cache == NULL || !_content_range.empty()) {
+			return false;
+		}
+
+		internal::OpenFileInfo file;
+		if (!_open_file_cache->lookup(path, file) || !file.is_file() || file.version == 0) {
+			return false;
+		}
+
+		int status = _status_code == 0 ? 200 : _status_code;
+		bool compress = status == 200 && should_compress(get_mime_type(rtrim(_target, "/")), file.size);
+		std::string coding = compress ? "gzip" : _content_encoding;
+		std::string key = coding.empty() ? path : path + '\0' + coding;
+		const internal::CachedResponse* cached = _response_cache->find(key, status, &_server_config, _location_config, file.version);
+		if (cached == NULL) {
+			const StatusLine* status_line = find_status_line(status);
+			std::string body;
+			if (status_line == NULL || static_cast<size_t>(file.size) > _response_cache->get_max_body()
+				|| !read_file(path, file, body)) {
+				return false;
+			}
+			if (compress && !GzipStream::compress_string(body, _location_config->get_gzip_comp_level())) {
+				return false;
+			}
+
+			std::string fields = "Content-Length: " + to_string(body.size()) + CRLF;
+			fields += "Content-Type: " + get_mime_type(rtrim(_target, "/")) + CRLF;
+			if (status == 200) {
+				fields += compress ? "" : "Accept-Ranges: bytes" CRLF;
+				fields += get_validator_fields(file.mtime, file.size, compress) + get_encoding_fields(coding);
+			}
+			std::string keep_alive_head = "Server: webserv/6.9" CRLF "Connection: keep-alive" CRLF "Keep-Alive: timeout=";
+			keep_alive_head += to_string(_server_config.get_keepalive_timeout()) + CRLF + fields;
+			std::string close_head = "Server: webserv/6.9" CRLF "Connection: close" CRLF + fields;
+
+			cached = _response_cache->insert(key, status, &_server_config, _location_config, file.version,
+				std::string(status_line->line, status_line->size), keep_alive_head, close_head, body);
+			if (cached == NULL) {
+				return false;
+			}
+		}
+
+		_cached = *cached;
+		_cached.buffer->retain();
+		return true;
+	}
+
+	/**
+	 * @brief Read the whole file at path, as long as it is the version lookup found
+	 */
+	bool Response::read_file(const std::string& path, const internal::OpenFileInfo& file, std::string& body) {
+		internal::OpenFileInfo opened;
+		if (!_open_file_cache->open(path, opened) || opened.fd == -1) {
+			return false;
+		}
+		if (opened.version != file.version) {
+			close(opened.fd);
+			return false;
+		}
+
+		body.resize(file.size);
+		size_t size = 0;
+		while (size < body.size()) {
+			ssize_t ret = pread(opened.fd, &body[size], body.size() - size, size);
+			if (ret <= 0) {
+				break;
+			}
+			size += ret;
+		}
+		close(opened.fd);
+		return size == body.size();
+	}
+
+	/**
+	 * @brief Process POST method, uploaded files were written while the body arrived
+	 */
 	void Response::process_post() {
-		if (_request.has_files() && !_request.write_files(_root + _target)) {
-			_status_code = _request.get_status_code();
-			return set_error_response();
+		if (_open_file_cache != NULL) {
+			std::string directory = rtrim(_root + _target, "/") + "/";
+			for (size_t i = 0; i < _request.get_file_names().size(); ++i) {
+				_open_file_cache->invalidate(directory + _request.get_file_names()[i]);
+			}
 		}
 		_status_code = 201;
 		set_response();
 	}
 
 	void Response::process_delete() {
-		if (remove(std::string(_root + rtrim(_target, "/")).c_str()) == -1) {
+		std::string path = _root + rtrim(_target, "/");
+
+		if (remove(path.c_str()) == -1) {
 			_status_code = 403;
 			return set_error_response();
 		}
+		if (_open_file_cache != NULL) {
+			_open_file_cache->invalidate(path);
+		}
 		_status_code = 204;
 		set_response();
 	}
@@ -208,10 +601,7 @@ namespace webserv {
 	 * @note Should only be call after process and set the response body
 	 */
 	void Response::set_response() {
-		_response = "HTTP/1.1 ";
-		_response += to_string(_status_code);
-		_response += " " + get_status_message(_status_code);
-		_response += CRLF;
+		set_status_line();
 
 		_response += "Date: ";
 		_response += get_current_time("%a, %d %b %Y %H:%M:%S %Z");
@@ -221,40 +611,59 @@ namespace webserv {
 		_response += "webserv/6.9";
 		_response += CRLF;
 
-		_response += "Connection: close";
-		_response += CRLF;
+		set_connection_header();
 
 		if (!_cgi_path.empty() && !_cgi_error) {
+			// The script may have encoded its output itself
+			bool compressed = _cgi_headers.count("Content-Encoding") == 0 && compress_body(get_cgi_mime_type());
 			std::map<std::string, std::string>::iterator it = _cgi_headers.begin();
 			for (; it != _cgi_headers.end(); ++it) {
-				if (it->first == "Status") {
+				if (it->first == "Status" || (compressed && strcasecmp(it->first.c_str(), "Content-Length") == 0)) {
 					continue;
 				}
 				_response += it->first + ": " + it->second + CRLF;
 			}
-			if (_cgi_headers.count("Content-Length") == 0) {
+			if (compressed || _cgi_headers.count("Content-Length") == 0) {
 				_response += "Content-Length: ";
 				_response += to_string(_body.size());
 				_response += CRLF;
 			}
+			if (compressed) {
+				_response += get_encoding_fields(_content_encoding);
+			}
 
 			_response += CRLF;
 			_response += _body;
 			return;
 		}
 
-		_response += "Content-Length: ";
-		_response += to_string(_body.size());
+		if (_file_fd == -1 && (_autoindex || _status_code >= 400)) {
+			compress_body("text/html");
+		}
+
+		if (_compress_file) {
+			_response += "Transfer-Encoding: chunked";
+		} else {
+			_response += "Content-Length: ";
+			_response += _file_fd == -1 ? to_string(_body.size()) : to_string(get_content_length());
+		}
 		_response += CRLF;
 
+		if (!_content_range.empty()) {
+			_response += "Content-Range: ";
+			_response += _content_range;
+			_response += CRLF;
+		}
+
 		if (_status_code >= 400 && _status_code < 600) {
 			_response += "Content-Type: ";
-			if (_is_custom_error_page && rtrim(_target, "/").find_last_of('.') != std::string::npos) {
-				_response += get_mime_type(rtrim(_target, "/").substr(rtrim(_target, "/").find_last_of('.')));
+			if (_is_custom_error_page) {
+				append_mime_type(rtrim(_target, "/"));
 			} else {
 				_response += "text/html";
 			}
 			_response += CRLF;
+			_response += get_encoding_fields(_content_encoding);
 
 			_response += CRLF;
 			_response += _body;
@@ -265,15 +674,24 @@ namespace webserv {
 			_response += "Content-Type: ";
 			if (_autoindex || !_cgi_path.empty()) {
 				_response += "text/html";
-			} else if (rtrim(_target, "/").find_last_of('.') != std::string::npos) {
-				_response += get_mime_type(rtrim(_target, "/").substr(rtrim(_target, "/").find_last_of('.')));
+			} else if (!_boundary.empty()) {
+				_response += "multipart/byteranges; boundary=" + _boundary;
 			} else {
-				_response += "text/plain";
+				append_mime_type(rtrim(_target, "/"));
 			}
 			_response += CRLF;
+
+			if (_file_fd != -1 && !_compress_file) {
+				_response += "Accept-Ranges: bytes";
+				_response += CRLF;
+			}
+			if (_file_fd != -1) {
+				_response += get_validator_fields(_file_mtime, _file_size, _compress_file);
+			}
+			_response += get_encoding_fields(_content_encoding);
 		}
 
-		if (_request.get_method() == POST && _request.has_files()) {
+		if (_request.get_method() == POST && !_request.get_file_names().empty()) {
 			_response += "Location: ";
 			std::string filename = _request.get_file_names().at(0);
 			_response += _target + filename;
@@ -287,34 +705,69 @@ namespace webserv {
 	}
 
 	void Response::get_cookies() {
-		if (_request.get_headers().count("Cookie") == 0 || (_request.get_headers().count("Cookie") > 0 && _request.get_headers().at("Cookie").find("timestamp=") == std::string::npos)) {
+		if (wants_cookie()) {
 			_response += "Set-Cookie: ";
 			_response += "timestamp=" + get_current_time("%H:%M:%S") + "; Max-Age=30";
 			_response += CRLF;
 		}
 	}
 
+	bool Response::wants_cookie() const {
+		return _request.get_header(HEADER_COOKIE).find("timestamp=") == std::string::npos;
+	}
+
+	/**
+	 * @brief Tell client if the connection stays open after this response
+	 */
+	void Response::set_connection_header() {
+		if (!_request.is_keep_alive()) {
+			_response += "Connection: close";
+			_response += CRLF;
+			return;
+		}
+
+		_response += "Connection: keep-alive";
+		_response += CRLF;
+
+		_response += "Keep-Alive: timeout=";
+		_response += to_string(_server_config.get_keepalive_timeout());
+		_response += CRLF;
+	}
+
 	/**
 	 * @brief Set the response body and header for error status code
 	 */
 	void Response::set_error_response() {
+		if (_file_fd != -1) {
+			close(_file_fd);
+			_file_fd = -1;
+		}
+		_content_encoding.clear();
+		_response.clear();
+
 		if (_server_config.get_error_pages().count(to_string(_status_code))) {
 			_target = _root + _server_config.get_error_pages().at(to_string(_status_code));
-			try {
-				_body = file_to_string(_target);
+			if (use_cached_response(rtrim(_target, "/"))) {
+				_is_custom_error_page = true;
+				return;
+			}
+			if (open_file(_target)) {
 				_is_custom_error_page = true;
 				return set_response();
-			} catch (const std::exception& e) { (void)e; }
+			}
 		}
 
 		_body = "<html>\n";
 
+		const StatusLine* status_line = find_status_line(_status_code);
+		const char* reason = status_line == NULL ? "Not Implemented" : status_line->reason;
+
 		_body += "<head><title>";
-		_body += get_status_message(_status_code);
+		_body += reason;
 		_body += "</title></head>\n";
 
 		_body += "<body><center><h1>";
-		_body += get_status_message(_status_code);
+		_body += reason;
 		_body += "</h1></center></body>\n";
 
 		_body += "</html>";
@@ -340,10 +793,11 @@ namespace webserv {
 		_body += "<body>\n";
 		_body += "<h1>index of " + path + "</h1>\n";
 
+		std::string host = _request.get_header(HEADER_HOST);
 		file = readdir(dir);
 		while (file != NULL) {
 			std::string file_name(file->d_name);
-			_body += "<p><a href=\"http://" + _request.get_headers().at("Host") + rtrim(_target, "/") + "/" + file_name + "\">" + file_name + "</a></p>";
+			_body += "<p><a href=\"http://" + host + rtrim(_target, "/") + "/" + file_name + "\">" + file_name + "</a></p>";
 			file = readdir(dir);
 		}
 
@@ -356,10 +810,7 @@ namespace webserv {
 	 * @brief Setup redirect response header
 	 */
 	void Response::set_redirect_response() {
-		_response = "HTTP/1.1 ";
-		_response += to_string(_status_code);
-		_response += " " + get_status_message(_status_code);
-		_response += CRLF;
+		set_status_line();
 
 		_response += "Date: ";
 		_response += get_current_time("%a, %d %b %Y %H:%M:%S %Z");
@@ -369,8 +820,7 @@ namespace webserv {
 		_response += "webserv/6.9";
 		_response += CRLF;
 
-		_response += "Connection: close";
-		_response += CRLF;
+		set_connection_header();
 
 		_response += "Location: ";
 		_response += _redirect;
@@ -381,6 +831,34 @@ namespace webserv {
 		_response += CRLF;
 	}
 
+	/**
+	 * @brief Setup 304 response header, the validators without body
+	 */
+	void Response::set_not_modified_response() {
+		set_status_line();
+
+		_response += "Date: ";
+		_response += get_current_time("%a, %d %b %Y %H:%M:%S %Z");
+		_response += CRLF;
+
+		_response += "Server: ";
+		_response += "webserv/6.9";
+		_response += CRLF;
+
+		set_connection_header();
+
+		_response += get_validator_fields(_file_mtime, _file_size, _compress_file);
+
+		if (varies_on_encoding()) {
+			_response += "Vary: Accept-Encoding";
+			_response += CRLF;
+		}
+
+		get_cookies();
+
+		_response += CRLF;
+	}
+
 	void Response::setup_cgi_env() {
 		_cgi_env["SERVER_SOFTWARE"] = "webserv/6.9";
 		_cgi_env["SERVER_NAME"] = _server_name;
@@ -395,14 +873,8 @@ namespace webserv {
 		_cgi_env["PATH_TRANSLATED"] = _root + rtrim(_target, "/");
 		_cgi_env["QUERY_STRING"] = _request.get_query();
 
-		if (_request.get_headers().count("Content-Type") > 0)
-			_cgi_env["CONTENT_TYPE"] = _request.get_headers().at("Content-Type");
-		else
-			_cgi_env["CONTENT_TYPE"] = "";
-		if (_request.get_headers().count("Content-Length") > 0)
-			_cgi_env["CONTENT_LENGTH"] = _request.get_headers().at("Content-Length");
-		else
-			_cgi_env["CONTENT_LENGTH"] = "";
+		_cgi_env["CONTENT_TYPE"] = _request.get_header(HEADER_CONTENT_TYPE);
+		_cgi_env["CONTENT_LENGTH"] = _request.is_chunked() ? to_string(_request.get_body_size()) : _request.get_header(HEADER_CONTENT_LENGTH);
 		_cgi_env["REDIRECT_STATUS"] = "1";
 
 		char client_address[69];
@@ -410,8 +882,9 @@ namespace webserv {
 		_cgi_env["REMOTE_ADDR"] = std::string(client_address);
 
 		// Request header HTTP
-		std::map<std::string, std::string>::const_iterator header_it = _request.get_headers().begin();
-		for (; header_it != _request.get_headers().end(); ++header_it) {
+		std::map<std::string, std::string> headers = _request.get_headers();
+		std::map<std::string, std::string>::const_iterator header_it = headers.begin();
+		for (; header_it != headers.end(); ++header_it) {
 			std::string header_name = header_it->first;
 			for (size_t i = 0; i < header_name.length(); ++i) {
 				header_name[i] = toupper(header_name[i]);
@@ -420,6 +893,133 @@ namespace webserv {
 		}
 	}
 
+	/**
+	 * @brief Start the response with the prebuilt status line of the status code
+	 */
+	void Response::set_status_line() {
+		const StatusLine* status_line = find_status_line(_status_code);
+
+		if (status_line != NULL) {
+			_response.assign(status_line->line, status_line->size);
+			return;
+		}
+
+		_response = "HTTP/1.1 ";
+		_response += to_string(_status_code);
+		_response += " " + get_status_message(_status_code);
+		_response += CRLF;
+	}
+
+	/**
+	 * @brief Append MIME type of path
+	 */
+	void Response::append_mime_type(const std::string& path) {
+		_response += get_mime_type(path);
+	}
+
+	/**
+	 * @brief Last-Modified and, unless etag is off in the location, ETag fields of a file
+	 * @note weak for a body compressed on the fly, its bytes depend on the level
+	 */
+	std::string Response::get_validator_fields(const time_t& mtime, const off_t& size, bool weak) const {
+		std::string fields = "Last-Modified: " + format_http_date(mtime) + CRLF;
+		if (_location_config->get_etag()) {
+			fields += "ETag: " + std::string(weak ? "W/" : "") + make_etag(mtime, size) + CRLF;
+		}
+		return fields;
+	}
+
+	/**
+	 * @brief Content-Encoding field of coding if any, and Vary if the location negotiates it
+	 */
+	std::string Response::get_encoding_fields(const std::string& coding) const {
+		std::string fields;
+		if (!coding.empty()) {
+			fields += "Content-Encoding: " + coding + CRLF;
+		}
+		if (varies_on_encoding()) {
+			fields += "Vary: Accept-Encoding" CRLF;
+		}
+		return fields;
+	}
+
+	/**
+	 * @brief MIME type of the CGI output, its Content-Type without parameters
+	 */
+	std::string Response::get_cgi_mime_type() const {
+		std::map<std::string, std::string>::const_iterator it = _cgi_headers.begin();
+		for (; it != _cgi_headers.end(); ++it) {
+			if (strcasecmp(it->first.c_str(), "Content-Type") == 0) {
+				std::string type = it->second.substr(0, it->second.find(';'));
+				return rtrim(type, " \t");
+			}
+		}
+		return "";
+	}
+
+	/**
+	 * @brief MIME type of path, from types of location, server or the default ones
+	 */
+	const std::string& Response::get_mime_type(const std::string& path) const {
+		static const std::string default_type("text/plain");
+		const MimeTypes* mime_types = &MimeTypes::get_default();
+		if (_location_config != NULL && !_location_config->get_types().empty()) {
+			mime_types = &_location_config->get_types();
+		} else if (!_server_config.get_types().empty()) {
+			mime_types = &_server_config.get_types();
+		}
+
+		const std::string* mime_type = mime_types->find_for_path(path);
+		return mime_type == NULL ? default_type : *mime_type;
+	}
+
+	/**
+	 * @brief Queue the response on connection, the cached one or the header and file
+	 * @note The parts of a multipart/byteranges body share the fd, the last one
+	 * takes it, so nothing can fail once the header is queued
+	 */
+	void Response::queue_to(Connection& connection) {
+		if (_cached.buffer != NULL) {
+			return _response_cache->queue(connection, _cached, _request.is_keep_alive(), _status_code < 400 && wants_cookie());
+		}
+
+		connection.queue_output(_response);
+		int file_fd = take_file_fd();
+		if (file_fd == -1) {
+			return;
+		}
+		if (_compress_file) {
+			return connection.queue_compressed_file(file_fd, 0, _file_size, _location_config->get_gzip_comp_level());
+		}
+		if (_ranges.empty()) {
+			return connection.queue_file(file_fd, 0, _file_size);
+		}
+		if (_range_heads.empty()) {
+			return connection.queue_file(file_fd, _ranges[0].start, _ranges[0].end);
+		}
+
+		for (size_t i = 0; i < _ranges.size(); ++i) {
+			connection.queue_output(_range_heads[i]);
+			if (i + 1 == _ranges.size()) {
+				connection.queue_file(file_fd, _ranges[i].start, _ranges[i].end);
+			} else {
+				connection.queue_file_part(file_fd, _ranges[i].start, _ranges[i].end);
+			}
+		}
+		connection.queue_output(_range_heads.back());
+	}
+
 	/* Getter */
 	const std::string& Response::get_raw_data() const { return _response; }
+	const off_t& Response::get_file_size() const { return _file_size; }
+
+	/**
+	 * @brief Hand the file of the body over, the caller closes it
+	 * @return fd or -1 if the body isn't a file
+	 */
+	int Response::take_file_fd() {
+		int fd = _file_fd;
+		_file_fd = -1;
+		return fd;
+	}
 } /* namespace webserv */
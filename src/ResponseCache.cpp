@@ -0,0 +1,219 @@
+#include "ResponseCache.hpp"
+
+#define RESPONSE_CACHE_MIN_BUCKETS 8
+#define RESPONSE_CACHE_BUCKET_BYTES 4096 /* budget per bucket, about one small file */
+
+namespace webserv {
+	namespace internal {
+		ResponseCache::ResponseCache(size_t budget, size_t max_body) :
+			_entries(),
+			_buckets(),
+			_mask(0),
+			_free(-1),
+			_hand(0),
+			_budget(budget),
+			_max_body(max_body),
+			_size(0),
+			_clock(NULL),
+			_date_end(0),
+			_clock_time(0) {
+			size_t bucket_count = RESPONSE_CACHE_MIN_BUCKETS;
+			while (bucket_count < _budget / RESPONSE_CACHE_BUCKET_BYTES) {
+				bucket_count *= 2;
+			}
+			_buckets.assign(bucket_count, -1);
+			_mask = bucket_count - 1;
+		}
+
+		ResponseCache::~ResponseCache() {
+			clear();
+			if (_clock != NULL) {
+				_clock->release();
+			}
+		}
+
+		/**
+		 * @brief Response of path with status for these configs, if still valid
+		 * @note An entry built from another version of the file is dropped
+		 * @return response or NULL, valid until the next insert
+		 */
+		const CachedResponse* ResponseCache::find(const std::string& path, const int& status, const ServerConfig* server_config,
+			const LocationConfig* location_config, const unsigned long& version) {
+			for (int index = _buckets[bucket_of(path)]; index != -1; index = _entries[index].next) {
+				Entry& entry = _entries[index];
+				if (entry.status != status || entry.server_config != server_config
+					|| entry.location_config != location_config || entry.path != path) {
+					continue;
+				}
+
+				if (entry.version != version) {
+					remove(index);
+					return NULL;
+				}
+				entry.referenced = true;
+				return &entry.response;
+			}
+			return NULL;
+		}
+
+		/**
+		 * @brief Build the response of path from its parts, see CachedResponse
+		 * @return response or NULL if it doesn't fit, valid until the next insert
+		 */
+		const CachedResponse* ResponseCache::insert(const std::string& path, const int& status, const ServerConfig* server_config,
+			const LocationConfig* location_config, const unsigned long& version, const std::string& status_line,
+			const std::string& keep_alive_head, const std::string& close_head, const std::string& body) {
+			size_t size = status_line.size() + keep_alive_head.size() + close_head.size() + 2 + body.size();
+			size_t cost = sizeof(Entry) + path.size() + size;
+			if (body.size() > _max_body || !make_room(cost)) {
+				return NULL;
+			}
+
+			std::string data;
+			data.reserve(size);
+			data += status_line;
+			data += keep_alive_head;
+			data += close_head;
+			data += CRLF;
+			data += body;
+
+			int index = _free;
+			if (index != -1) {
+				_free = _entries[index].next;
+			} else {
+				_entries.push_back(Entry());
+				index = _entries.size() - 1;
+			}
+
+			Entry& entry = _entries[index];
+			size_t bucket = bucket_of(path);
+			entry.path = path;
+			entry.status = status;
+			entry.server_config = server_config;
+			entry.location_config = location_config;
+			entry.version = version;
+			entry.used = true;
+			entry.referenced = false;
+			entry.cost = cost;
+			entry.response.buffer = SharedBuffer::create(data);
+			entry.response.status_end = status_line.size();
+			entry.response.keep_alive_end = entry.response.status_end + keep_alive_head.size();
+			entry.response.close_end = entry.response.keep_alive_end + close_head.size();
+
+			entry.next = _buckets[bucket];
+			_buckets[bucket] = index;
+			_size += cost;
+			return &entry.response;
+		}
+
+		/**
+		 * @brief Queue cached on connection, with the Set-Cookie of get_cookies if cookie
+		 * @note Nothing is copied, the slices hold references to the buffers
+		 */
+		void ResponseCache::queue(Connection& connection, const CachedResponse& cached, bool keep_alive, bool cookie) {
+			update_clock();
+
+			const std::string& data = cached.buffer->get_data();
+			connection.queue_shared(cached.buffer, 0, cached.status_end);
+			connection.queue_shared(_clock, 0, _date_end);
+			if (keep_alive) {
+				connection.queue_shared(cached.buffer, cached.status_end, cached.keep_alive_end);
+			} else {
+				connection.queue_shared(cached.buffer, cached.keep_alive_end, cached.close_end);
+			}
+			if (cookie) {
+				connection.queue_shared(_clock, _date_end, _clock->get_data().size());
+			}
+			connection.queue_shared(cached.buffer, cached.close_end, data.size());
+		}
+
+		void ResponseCache::clear() {
+			for (size_t i = 0; i < _entries.size(); ++i) {
+				if (_entries[i].used) {
+					remove(i);
+				}
+			}
+		}
+
+		/**
+		 * @brief Evict entries until cost fits in the budget
+		 * @return false if cost is larger than the whole budget
+		 */
+		bool ResponseCache::make_room(const size_t& cost) {
+			if (cost > _budget) {
+				return false;
+			}
+
+			while (_size + cost > _budget) {
+				if (_hand >= _entries.size()) {
+					_hand = 0;
+				}
+
+				Entry& entry = _entries[_hand];
+				if (entry.used && entry.referenced) {
+					entry.referenced = false;
+				} else if (entry.used) {
+					remove(_hand);
+				}
+				++_hand;
+			}
+			return true;
+		}
+
+		void ResponseCache::remove(int index) {
+			Entry& entry = _entries[index];
+
+			int* link = &_buckets[bucket_of(entry.path)];
+			while (*link != index) {
+				link = &_entries[*link].next;
+			}
+			*link = entry.next;
+
+			entry.response.buffer->release();
+			entry.response.buffer = NULL;
+			entry.used = false;
+			_size -= entry.cost;
+
+			entry.next = _free;
+			_free = index;
+		}
+
+		/**
+		 * @brief Rebuild the Date and Set-Cookie lines once a second
+		 * @note Responses still queued keep the old buffer alive
+		 */
+		void ResponseCache::update_clock() {
+			std::time_t now = std::time(0);
+			if (_clock != NULL && now == _clock_time) {
+				return;
+			}
+
+			std::string clock = "Date: " + get_current_time("%a, %d %b %Y %H:%M:%S %Z") + CRLF;
+			_date_end = clock.size();
+			clock += "Set-Cookie: timestamp=" + get_current_time("%H:%M:%S") + "; Max-Age=30" + CRLF;
+
+			if (_clock != NULL) {
+				_clock->release();
+			}
+			_clock = SharedBuffer::create(clock);
+			_clock_time = now;
+		}
+
+		/**
+		 * @brief FNV-1a of the path, folded on the bucket count
+		 */
+		size_t ResponseCache::bucket_of(const std::string& path) const {
+			unsigned hash = 2166136261u;
+
+			for (size_t i = 0; i < path.size(); ++i) {
+				hash ^= static_cast<unsigned char>(path[i]);
+				hash *= 16777619u;
+			}
+			return (hash ^ (hash >> 16)) & _mask;
+		}
+
+		/* Getters */
+		const size_t& ResponseCache::get_size() const { return _size; }
+		const size_t& ResponseCache::get_max_body() const { return _max_body; }
+	} /* namespace internal */
+} /* namespace webserv */
@@ -0,0 +1,341 @@
+#include "Scanner.hpp"
+
+#ifdef WEBSERV_SCAN_X86
+#include <immintrin.h>
+#endif
+
+namespace webserv {
+	namespace internal {
+		/* Scalar kernels, also used for the tail shorter than a vector */
+
+		static bool is_ctl(unsigned char c) {
+			return (c < 0x20 && c != '\t' && c != '\r') || c == 0x7F;
+		}
+
+		static const char* scan_line_scalar(const char* data, size_t size, bool& has_ctl) {
+			for (size_t i = 0; i < size; ++i) {
+				if (data[i] == '\n') {
+					return data + i;
+				}
+				if (is_ctl(data[i])) {
+					has_ctl = true;
+				}
+			}
+			return NULL;
+		}
+
+		static const char* scan_token_scalar(const char* data, size_t size) {
+			for (size_t i = 0; i < size; ++i) {
+				if (!is_token_char(data[i])) {
+					return data + i;
+				}
+			}
+			return data + size;
+		}
+
+		static const char* scan_bytes_scalar(const char* data, size_t size, const char* pattern, size_t pattern_size) {
+			if (pattern_size == 0) {
+				return data;
+			}
+
+			const char* end = data + size;
+			while (static_cast<size_t>(end - data) >= pattern_size) {
+				data = static_cast<const char*>(std::memchr(data, pattern[0], end - data - pattern_size + 1));
+				if (data == NULL) {
+					return NULL;
+				}
+				if (std::memcmp(data + 1, pattern + 1, pattern_size - 1) == 0) {
+					return data;
+				}
+				++data;
+			}
+			return NULL;
+		}
+
+#ifdef WEBSERV_SCAN_X86
+		/* SSE2 kernels, 16 bytes per step */
+
+		__attribute__((target("sse2")))
+		static const char* scan_line_sse2(const char* data, size_t size, bool& has_ctl) {
+			const __m128i lf = _mm_set1_epi8('\n');
+			const __m128i tab = _mm_set1_epi8('\t');
+			const __m128i cr = _mm_set1_epi8('\r');
+			const __m128i del = _mm_set1_epi8(0x7F);
+			const __m128i ctl_max = _mm_set1_epi8(0x1F);
+			size_t i = 0;
+
+			for (; i + 16 <= size; i += 16) {
+				__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				/* unsigned block <= 0x1F, then drop HT and CR, add DEL */
+				__m128i ctl = _mm_cmpeq_epi8(_mm_subs_epu8(block, ctl_max), _mm_setzero_si128());
+				ctl = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi8(block, tab), _mm_cmpeq_epi8(block, cr)), ctl);
+				ctl = _mm_or_si128(ctl, _mm_cmpeq_epi8(block, del));
+
+				unsigned lf_mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, lf));
+				unsigned ctl_mask = _mm_movemask_epi8(ctl);
+				if (lf_mask != 0) {
+					unsigned pos = __builtin_ctz(lf_mask);
+					if ((ctl_mask & ((1u << pos) - 1)) != 0) {
+						has_ctl = true;
+					}
+					return data + i + pos;
+				}
+				if (ctl_mask != 0) {
+					has_ctl = true;
+				}
+			}
+			return scan_line_scalar(data + i, size - i, has_ctl);
+		}
+
+		__attribute__((target("sse2")))
+		static const char* scan_token_sse2(const char* data, size_t size) {
+			const __m128i case_bit = _mm_set1_epi8(0x20);
+			const __m128i alpha_offset = _mm_set1_epi8(static_cast<char>(0x80 - 'a'));
+			const __m128i alpha_limit = _mm_set1_epi8(static_cast<char>(0x80 + 26));
+			const __m128i digit_offset = _mm_set1_epi8(static_cast<char>(0x80 - '0'));
+			const __m128i digit_limit = _mm_set1_epi8(static_cast<char>(0x80 + 10));
+			const __m128i dash = _mm_set1_epi8('-');
+			size_t i = 0;
+
+			/* letters, digits and '-' are checked in the vector, anything else by the table */
+			while (i + 16 <= size) {
+				__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				__m128i alpha = _mm_cmpgt_epi8(alpha_limit, _mm_add_epi8(_mm_or_si128(block, case_bit), alpha_offset));
+				__m128i digit = _mm_cmpgt_epi8(digit_limit, _mm_add_epi8(block, digit_offset));
+				__m128i fast = _mm_or_si128(_mm_or_si128(alpha, digit), _mm_cmpeq_epi8(block, dash));
+
+				unsigned mask = _mm_movemask_epi8(fast);
+				if (mask == 0xFFFF) {
+					i += 16;
+					continue;
+				}
+				i += __builtin_ctz(~mask);
+				if (!is_token_char(data[i])) {
+					return data + i;
+				}
+				++i;
+			}
+			return scan_token_scalar(data + i, size - i);
+		}
+
+		__attribute__((target("sse2")))
+		static const char* scan_bytes_sse2(const char* data, size_t size, const char* pattern, size_t pattern_size) {
+			if (pattern_size < 2 || pattern_size > size) {
+				return scan_bytes_scalar(data, size, pattern, pattern_size);
+			}
+
+			/* candidates match first and last byte of pattern, then memcmp the middle */
+			const __m128i first = _mm_set1_epi8(pattern[0]);
+			const __m128i last = _mm_set1_epi8(pattern[pattern_size - 1]);
+			size_t i = 0;
+
+			for (; i + pattern_size - 1 + 16 <= size; i += 16) {
+				__m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				__m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + pattern_size - 1));
+				unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+
+				while (mask != 0) {
+					unsigned pos = __builtin_ctz(mask);
+					if (std::memcmp(data + i + pos + 1, pattern + 1, pattern_size - 2) == 0) {
+						return data + i + pos;
+					}
+					mask &= mask - 1;
+				}
+			}
+			return scan_bytes_scalar(data + i, size - i, pattern, pattern_size);
+		}
+
+		/* AVX2 kernels, same algorithms 32 bytes per step */
+
+		__attribute__((target("avx2")))
+		static const char* scan_line_avx2(const char* data, size_t size, bool& has_ctl) {
+			const __m256i lf = _mm256_set1_epi8('\n');
+			const __m256i tab = _mm256_set1_epi8('\t');
+			const __m256i cr = _mm256_set1_epi8('\r');
+			const __m256i del = _mm256_set1_epi8(0x7F);
+			const __m256i ctl_max = _mm256_set1_epi8(0x1F);
+			size_t i = 0;
+
+			for (; i + 32 <= size; i += 32) {
+				__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				__m256i ctl = _mm256_cmpeq_epi8(_mm256_subs_epu8(block, ctl_max), _mm256_setzero_si256());
+				ctl = _mm256_andnot_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, tab), _mm256_cmpeq_epi8(block, cr)), ctl);
+				ctl = _mm256_or_si256(ctl, _mm256_cmpeq_epi8(block, del));
+
+				unsigned lf_mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, lf));
+				unsigned ctl_mask = _mm256_movemask_epi8(ctl);
+				if (lf_mask != 0) {
+					unsigned pos = __builtin_ctz(lf_mask);
+					if ((ctl_mask & ((1u << pos) - 1)) != 0) {
+						has_ctl = true;
+					}
+					return data + i + pos;
+				}
+				if (ctl_mask != 0) {
+					has_ctl = true;
+				}
+			}
+			return scan_line_sse2(data + i, size - i, has_ctl);
+		}
+
+		__attribute__((target("avx2")))
+		static const char* scan_token_avx2(const char* data, size_t size) {
+			const __m256i case_bit = _mm256_set1_epi8(0x20);
+			const __m256i alpha_offset = _mm256_set1_epi8(static_cast<char>(0x80 - 'a'));
+			const __m256i alpha_limit = _mm256_set1_epi8(static_cast<char>(0x80 + 26));
+			const __m256i digit_offset = _mm256_set1_epi8(static_cast<char>(0x80 - '0'));
+			const __m256i digit_limit = _mm256_set1_epi8(static_cast<char>(0x80 + 10));
+			const __m256i dash = _mm256_set1_epi8('-');
+			size_t i = 0;
+
+			while (i + 32 <= size) {
+				__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				__m256i alpha = _mm256_cmpgt_epi8(alpha_limit, _mm256_add_epi8(_mm256_or_si256(block, case_bit), alpha_offset));
+				__m256i digit = _mm256_cmpgt_epi8(digit_limit, _mm256_add_epi8(block, digit_offset));
+				__m256i fast = _mm256_or_si256(_mm256_or_si256(alpha, digit), _mm256_cmpeq_epi8(block, dash));
+
+				unsigned mask = _mm256_movemask_epi8(fast);
+				if (mask == 0xFFFFFFFF) {
+					i += 32;
+					continue;
+				}
+				i += __builtin_ctz(~mask);
+				if (!is_token_char(data[i])) {
+					return data + i;
+				}
+				++i;
+			}
+			return scan_token_sse2(data + i, size - i);
+		}
+
+		__attribute__((target("avx2")))
+		static const char* scan_bytes_avx2(const char* data, size_t size, const char* pattern, size_t pattern_size) {
+			if (pattern_size < 2 || pattern_size > size) {
+				return scan_bytes_scalar(data, size, pattern, pattern_size);
+			}
+
+			const __m256i first = _mm256_set1_epi8(pattern[0]);
+			const __m256i last = _mm256_set1_epi8(pattern[pattern_size - 1]);
+			size_t i = 0;
+
+			for (; i + pattern_size - 1 + 32 <= size; i += 32) {
+				__m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				__m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + pattern_size - 1));
+				unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last)));
+
+				while (mask != 0) {
+					unsigned pos = __builtin_ctz(mask);
+					if (std::memcmp(data + i + pos + 1, pattern + 1, pattern_size - 2) == 0) {
+						return data + i + pos;
+					}
+					mask &= mask - 1;
+				}
+			}
+			return scan_bytes_sse2(data + i, size - i, pattern, pattern_size);
+		}
+#endif
+
+		/* Runtime dispatch */
+
+		struct ScanKernels {
+			ScanLevel	level;
+			const char*	(*line)(const char*, size_t, bool&);
+			const char*	(*token)(const char*, size_t);
+			const char*	(*bytes)(const char*, size_t, const char*, size_t);
+		};
+
+		static ScanLevel best_scan_level() {
+#ifdef WEBSERV_SCAN_X86
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx2")) {
+				return SCAN_AVX2;
+			}
+			if (__builtin_cpu_supports("sse2")) {
+				return SCAN_SSE2;
+			}
+#endif
+			return SCAN_SCALAR;
+		}
+
+		static ScanKernels scan_kernels_of(ScanLevel level) {
+			ScanKernels kernels = { SCAN_SCALAR, scan_line_scalar, scan_token_scalar, scan_bytes_scalar };
+#ifdef WEBSERV_SCAN_X86
+			if (level == SCAN_AVX2) {
+				ScanKernels avx2 = { SCAN_AVX2, scan_line_avx2, scan_token_avx2, scan_bytes_avx2 };
+				kernels = avx2;
+			} else if (level == SCAN_SSE2) {
+				ScanKernels sse2 = { SCAN_SSE2, scan_line_sse2, scan_token_sse2, scan_bytes_sse2 };
+				kernels = sse2;
+			}
+#else
+			(void)level;
+#endif
+			return kernels;
+		}
+
+		/* picked during static initialization, before any worker thread exists */
+		static const ScanLevel g_best_scan_level = best_scan_level();
+		static ScanKernels g_scan_kernels = scan_kernels_of(g_best_scan_level);
+
+		/**
+		 * @brief Find the LF ending a line
+		 * @param has_ctl set to true if a control byte other than HT and CR is before the LF
+		 * @return LF or NULL if data has none
+		 */
+		const char* scan_line(const char* data, size_t size, bool& has_ctl) {
+			return g_scan_kernels.line(data, size, has_ctl);
+		}
+
+		/**
+		 * @brief Find the end of a token (RFC 7230 3.2.6), as in a header field name
+		 * @return first byte that isn't a token character or data + size
+		 */
+		const char* scan_token(const char* data, size_t size) {
+			return g_scan_kernels.token(data, size);
+		}
+
+		/**
+		 * @brief Find pattern in data, like memmem
+		 * @return start of the first match or NULL
+		 */
+		const char* scan_bytes(const char* data, size_t size, const char* pattern, size_t pattern_size) {
+			return g_scan_kernels.bytes(data, size, pattern, pattern_size);
+		}
+
+		/**
+		 * @brief Find pattern in str from pos, like std::string::find
+		 */
+		size_t find_bytes(const std::string& str, const char* pattern, size_t pattern_size, size_t pos) {
+			if (pos > str.size()) {
+				return std::string::npos;
+			}
+
+			const char* found = scan_bytes(str.data() + pos, str.size() - pos, pattern, pattern_size);
+			return found == NULL ? std::string::npos : found - str.data();
+		}
+
+		bool is_token_char(unsigned char c) {
+			if ((c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z')) {
+				return true;
+			}
+			return c != '\0' && std::strchr("!#$%&'*+-.^_`|~", c) != NULL;
+		}
+
+		ScanLevel get_scan_level() {
+			return g_scan_kernels.level;
+		}
+
+		/**
+		 * @brief Force the kernels of level, for tests and benchmarks
+		 * @return false if the CPU doesn't support level
+		 * @note Not thread safe, call it before starting workers
+		 */
+		bool set_scan_level(ScanLevel level) {
+			if (level > g_best_scan_level) {
+				return false;
+			}
+			g_scan_kernels = scan_kernels_of(level);
+			return true;
+		}
+	} /* namespace internal */
+} /* namespace webserv */
@@ -1,11 +1,16 @@
 #include "Server.hpp"
 
 namespace webserv {
-	bool internal::g_shutdown = false;
+	volatile sig_atomic_t internal::g_shutdown = 0;
 
-	Server::Server(const std::vector<ServerConfig>& server_configs) : _server_configs(server_configs), _iohandler() {
-		std::vector<ServerConfig>::const_iterator s_it = _server_configs.begin();
-		std::vector<ServerConfig>::const_iterator s_ite = _server_configs.end();
+	Server::Server(const ConfigRef& config, const GlobalConfig& global_config, bool reuse_port, unsigned long worker_id) :
+		_config(config), _iohandler(), _reuse_port(reuse_port), _timers(), _now_ms(internal::TimerWheel::now_ms()),
+		_open_file_cache(global_config.get_open_file_cache(), global_config.get_open_file_cache_valid() * 1000UL,
+			global_config.get_open_file_cache_errors()),
+		_response_cache(global_config.get_response_cache(), global_config.get_response_cache_max_file()),
+		_boundaries(worker_id) {
+		std::vector<ServerConfig>::const_iterator s_it = _config->get_server_configs().begin();
+		std::vector<ServerConfig>::const_iterator s_ite = _config->get_server_configs().end();
 
 		for (; s_it != s_ite; ++s_it) {
 			_listens.insert(s_it->get_listens().begin(), s_it->get_listens().end());
@@ -22,10 +27,10 @@ namespace webserv {
 			}
 		}
 
-		std::map<int, Request>::iterator client_it = _clients.begin();
-		for (; client_it != _clients.end(); ++client_it) {
-			if (client_it->first > 0) {
-				close(client_it->first);
+		for (size_t fd = 0; fd < _connections.get_capacity(); ++fd) {
+			ConnectionEntry* entry = _connections.get(fd);
+			if (entry != NULL && entry->type == ENTRY_CLIENT) {
+				close(fd);
 			}
 		}
 	}
@@ -44,15 +49,37 @@ namespace webserv {
 		for (; l_it != _listens.end(); ++l_it) {
 			socket_fd = create_socket();
 
-			bind_socket(socket_fd, l_it->address, l_it->port);
+			bind_socket(socket_fd, l_it->address, l_it->port, _reuse_port);
 
-			_iohandler.add_fd(socket_fd);
+			ConnectionEntry* entry = _connections.add_listener(socket_fd, *l_it);
+			if (entry == NULL) {
+				close(socket_fd);
+				throw std::runtime_error("Fail to register socket fd " + to_string(socket_fd) + " in connection table\n");
+			}
+			entry->hosts = _config->get_virtual_hosts().find(*l_it);
+			_iohandler.add_listen_fd(socket_fd, entry);
 			LOG_D() << "Add socket fd: " << socket_fd << " to kevent\n";
 
 			_socket_fds.insert(std::make_pair(socket_fd, *l_it));
 		}
 	}
 
+	/**
+	 * @brief Give a forked worker its own poll watching the inherited listen sockets
+	 * @note Listen sockets are shared by all worker processes, each accept wakes one worker,
+	 * the inotify instance of the open file cache must not be. The pid tells the
+	 * multipart boundaries of workers apart.
+	 */
+	void Server::init_forked_worker() {
+		_iohandler.reset();
+		_open_file_cache.reset();
+		_boundaries = internal::BoundaryGenerator(getpid());
+
+		for (socket_it = _socket_fds.begin(); socket_it != _socket_fds.end(); ++socket_it) {
+			_iohandler.add_listen_fd(socket_it->first, _connections.get(socket_it->first), true);
+		}
+	}
+
 	/**
 	 * @brief Create a socket
 	 * @throw runtime_error in case fail to create
@@ -62,6 +89,10 @@ namespace webserv {
 		if (socket_fd == -1) {
 			throw std::runtime_error("Fail to create socket: " + std::string(std::strerror(errno)) + "\n");
 		}
+		if (!set_non_blocking(socket_fd)) {
+			close(socket_fd);
+			throw std::runtime_error("Fail to set socket non-blocking: " + std::string(std::strerror(errno)) + "\n");
+		}
 		LOG_D() << "Create a socket, fd: " << socket_fd << "\n";
 
 		return socket_fd;
@@ -69,13 +100,19 @@ namespace webserv {
 
 	/**
 	 * @brief Setup socket option and bind it to host:port
+	 * @note With reuse_port every worker binds its own socket to the same address
+	 * and the kernel load-balances new connections between them
 	 */
-	void Server::bind_socket(const int& socket_fd, const std::string& host, const int& port) {
+	void Server::bind_socket(const int& socket_fd, const std::string& host, const int& port, const bool& reuse_port) {
 		int _ = 1;
 		if (setsockopt(socket_fd, SOL_SOCKET, SO_REUSEADDR, &_, sizeof(_)) == -1) {
 			close(socket_fd);
 			throw std::runtime_error("Fail to set socket option: " + std::string(std::strerror(errno)) + "\n");
 		}
+		if (reuse_port && setsockopt(socket_fd, SOL_SOCKET, SO_REUSEPORT, &_, sizeof(_)) == -1) {
+			close(socket_fd);
+			throw std::runtime_error("Fail to set socket option: " + std::string(std::strerror(errno)) + "\n");
+		}
 		LOG_D() << "Set options for socket fd: " << socket_fd << "\n";
 
 		sockaddr_in sock_addr;
@@ -97,6 +134,13 @@ namespace webserv {
 		LOG_D() << "Bind socket fd: " << socket_fd << " to " << host << ":" << port << "\n";
 	}
 
+	/**
+	 * @brief Set O_NONBLOCK on fd so no socket call can stall the event loop
+	 */
+	bool Server::set_non_blocking(const int& fd) {
+		return fcntl(fd, F_SETFL, O_NONBLOCK) != -1;
+	}
+
 	/**
 	 * @brief listen for connections
 	 */
@@ -109,60 +153,101 @@ namespace webserv {
 		}
 
 		int new_event_size;
-		int triggered_fd;
+		ConnectionEntry* entry;
+		int timeout;
 		while (!internal::g_shutdown) {
-			new_event_size = _iohandler.wait_for_new_event();
+			timeout = _timers.get_next_timeout(_now_ms);
+			if (timeout == -1 || timeout > SHUTDOWN_CHECK_INTERVAL) {
+				timeout = SHUTDOWN_CHECK_INTERVAL;
+			}
+
+			new_event_size = _iohandler.wait_for_new_event(timeout);
+			_now_ms = internal::TimerWheel::now_ms();
+			_open_file_cache.set_now(_now_ms);
 
 			for (int i = 0; i < new_event_size; ++i) {
-				triggered_fd = _iohandler.get_triggered_fd(i);
-				if (_iohandler.is_error(i)) {
-					handle_fail_event(triggered_fd);
+				entry = static_cast<ConnectionEntry*>(_iohandler.get_triggered_data(i));
+				if (entry->type == ENTRY_FREE) {
+					continue;
+				} else if (_iohandler.is_error(i)) {
+					handle_fail_event(*entry);
 				} else if (_iohandler.is_eof(i)) {
-					remove_client(triggered_fd);
-				} else if (_socket_fds.count(triggered_fd) != 0) {
-					handle_accept_client(triggered_fd);
+					remove_client(*entry);
+				} else if (entry->type == ENTRY_LISTENER) {
+					handle_accept_client(i, *entry);
 				} else if (_iohandler.is_read_ready(i)) {
-					handle_read_event(triggered_fd);
+					handle_read_event(i, *entry);
 				} else if (_iohandler.is_write_ready(i)) {
-					handle_write_event(triggered_fd);
+					handle_write_event(*entry);
 				} else {
 					LOG_E() << "Unknown poll event\n";
-					remove_client(triggered_fd);
+					remove_client(*entry);
 				}
 			}
+
+			remove_timed_out_clients();
 		}
 	}
 
 	/**
 	 * @brief Remove client from server
 	 */
-	void Server::remove_client(const int& client_fd) {
+	void Server::remove_client(ConnectionEntry& entry) {
+		int client_fd = entry.fd;
 		LOG_D() << "Removed client fd: " << client_fd << "\n";
 
 		_iohandler.remove_fd(client_fd);
-
-		if (_clients.count(client_fd) > 0) {
-			_clients.erase(client_fd);
-		}
+		_connections.remove(client_fd);
 
 		if (client_fd > 0) {
 			close(client_fd);
 		}
 	}
 
+	/**
+	 * @brief Close connections whose header, body, send or keep-alive timer expired
+	 */
+	void Server::remove_timed_out_clients() {
+		std::vector<int> expired_fds;
+		_timers.expire(_now_ms, expired_fds);
+
+		for (size_t i = 0; i < expired_fds.size(); ++i) {
+			ConnectionEntry* entry = _connections.get(expired_fds[i]);
+			if (entry == NULL || entry->type != ENTRY_CLIENT) {
+				continue;
+			}
+			LOG_D() << "Timed out, client fd: " << expired_fds[i] << "\n";
+			remove_client(*entry);
+		}
+	}
+
+	/**
+	 * @brief (Re)arm the timer of connection to expire in timeout seconds
+	 * @note A timeout of 0 disarms the timer
+	 */
+	void Server::set_timeout(ConnectionEntry& entry, const int& timeout) {
+		internal::Timer& timer = entry.get_connection().get_timer();
+
+		if (timeout <= 0) {
+			return _timers.cancel(timer);
+		}
+		timer.fd = entry.fd;
+		_timers.schedule(timer, _now_ms + static_cast<unsigned long>(timeout) * 1000);
+	}
+
 	/**
 	 * @brief Handle fail poll event
 	 */
-	void Server::handle_fail_event(const int& triggered_fd) {
+	void Server::handle_fail_event(ConnectionEntry& entry) {
+		int triggered_fd = entry.fd;
 		LOG_E() << "Poll failed: " << std::string(std::strerror(errno)) << "\n";
 
 		_iohandler.remove_fd(triggered_fd);
 
-		if (_socket_fds.count(triggered_fd) > 0) {
+		if (entry.type == ENTRY_LISTENER) {
 			_socket_fds.erase(triggered_fd);
-		} else if (_clients.count(triggered_fd) > 0) {
-			_clients.erase(triggered_fd);
 		}
+		_connections.remove(triggered_fd);
 
 		if (triggered_fd > 0) {
 			close(triggered_fd);
@@ -171,91 +256,131 @@ namespace webserv {
 
 	/**
 	 * @brief Handle socket accept connection from client
+	 * @note Accept every pending connection until the listen socket would block
 	 */
-	void Server::handle_accept_client(const int& socket_fd) {
-		struct sockaddr_in	client_address;
-		bzero(&client_address, sizeof(client_address));
-		socklen_t address_len= sizeof(client_address);
+	void Server::handle_accept_client(const int& i, ConnectionEntry& listener) {
+		int socket_fd = listener.fd;
 
-		int client_fd = accept(socket_fd, (struct sockaddr*)&client_address, &address_len);
+		while (true) {
+			struct sockaddr_in	client_address;
+			bzero(&client_address, sizeof(client_address));
 
-		if (client_fd == -1) {
-			LOG_E() << "Failed to accept connection: " << std::strerror(errno) << "\n";
-			return;
-		}
+			int client_fd = _iohandler.accept_client(i, socket_fd, &client_address);
 
-		LOG_I() << "Accepted a connection, client fd: " << client_fd << "\n";
+			if (client_fd == -1) {
+				if (errno != EAGAIN && errno != EWOULDBLOCK) {
+					LOG_E() << "Failed to accept connection: " << std::strerror(errno) << "\n";
+				}
+				return;
+			}
 
-		_iohandler.add_fd(client_fd);
+			LOG_I() << "Accepted a connection, client fd: " << client_fd << "\n";
 
-		if (_socket_fds.count(socket_fd) == 0) {
-			LOG_E() << "Socket fd :" << socket_fd << "somehow not in server list\n";
-			return;
-		}
+			ConnectionEntry* entry = _connections.add_client(client_fd, client_address, listener.listen);
+			if (entry == NULL) {
+				LOG_E() << "Client fd: " << client_fd << " already connected or above the open file limit\n";
+				close(client_fd);
+				continue;
+			}
 
-		if (_clients.count(client_fd) == 0) {
-			_clients.insert(std::make_pair(client_fd, Request(client_address, _socket_fds.find(socket_fd)->second)));
-		} else {
-			LOG_E() << "Client fd: " << client_fd << " somehow already connected server\n";
+			entry->hosts = listener.hosts;
+			_iohandler.add_fd(client_fd, entry);
+			set_timeout(*entry, entry->hosts->get_default().get_client_header_timeout());
 		}
 	}
 
 	/**
 	 * @brief Handle read from client
 	 */
-	void Server::handle_read_event(const int& client_fd) {
+	void Server::handle_read_event(const int& i, ConnectionEntry& entry) {
+		int client_fd = entry.fd;
 		char buffer[READ_BUFFER + 1];
-		ssize_t bytesRead = recv(client_fd, buffer, READ_BUFFER, 0);
+		ssize_t bytesRead = _iohandler.receive(i, client_fd, buffer, READ_BUFFER);
+
+		if (bytesRead == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+			return;
+		}
 
 		if (bytesRead == -1 || bytesRead == 0) {
 			LOG_E() << "Failed to read data from client fd: " << client_fd << "\n";
-			return remove_client(client_fd);
+			return remove_client(entry);
 		}
 
 		buffer[bytesRead] = '\0';
 		LOG_I() << "Received a message from client fd: " << client_fd << ", size: " << bytesRead << ", message: " << buffer << "\n";
 
-		if (_clients.count(client_fd) == 0) {
-			LOG_E() << "Client fd: " << client_fd << " somehow not added into client list\n";
-			return;
-		}
+		handle_input(entry, buffer, bytesRead);
+	}
 
-		Request& req = _clients.at(client_fd);
+	/**
+	 * @brief Feed received bytes to the current request, respond once it's complete
+	 * @note Bytes after a complete request are kept for the next pipelined request
+	 */
+	void Server::handle_input(ConnectionEntry& entry, const char* data, const size_t& size) {
+		Connection& connection = entry.get_connection();
+		Request& req = connection.get_request();
+		bool was_started = req.has_started();
 
-		if (req.get_method() == -1) {
-			req.init(buffer, bytesRead, _server_configs);
+		size_t consumed = req.feed(data, size, *entry.hosts);
 
-			if (req.get_status_code() != 0 || req.get_bytes_to_read() == 0) {
-				_iohandler.set_write_ready(client_fd);
-			}
-			return;
+		if (req.is_complete()) {
+			connection.keep_pending_input(data + consumed, size - consumed);
+			return process_request(entry);
 		}
 
-		if (req.append_body(buffer, bytesRead)) {
-			_iohandler.set_write_ready(client_fd);
+		int timeout = connection.get_input_timeout(was_started);
+		if (timeout != -1) {
+			set_timeout(entry, timeout);
 		}
 	}
 
 	/**
-	 * @brief Handle write to client
+	 * @brief Build the response of a complete request and queue it for write
 	 */
-	void Server::handle_write_event(const int& client_fd) {
-		if (_clients.count(client_fd) == 0) {
-			LOG_E() << "Client fd: " << client_fd << " somehow not added into client list\n";
-			return;
+	void Server::process_request(ConnectionEntry& entry) {
+		Connection& connection = entry.get_connection();
+		Request& req = connection.get_request();
+
+		if (req.is_keep_alive() && connection.get_request_count() + 1 >= (size_t)req.get_server_config().get_keepalive_requests()) {
+			req.set_keep_alive(false);
 		}
 
-		Response response(_clients.at(client_fd));
+		Response response(req, &_open_file_cache, &_response_cache, &_boundaries);
 		response.process();
+		response.queue_to(connection);
+		_iohandler.set_write_ready(entry.fd, &entry);
+		set_timeout(entry, req.get_server_config().get_send_timeout());
+	}
 
-		int ret = send(client_fd, response.get_raw_data().c_str(), response.get_raw_data().size(), 0);
+	/**
+	 * @brief Handle write to client
+	 */
+	void Server::handle_write_event(ConnectionEntry& entry) {
+		int client_fd = entry.fd;
+		Connection& connection = entry.get_connection();
 
-		if (ret == -1 || ret == 0) {
+		if (!connection.flush_output(client_fd)) {
 			LOG_E() << "Failed to send the response to client fd: " << client_fd << "\n";
-		} else {
-			LOG_I() << "Send a response to client fd: " << client_fd << "\n";
+			return remove_client(entry);
+		}
+
+		if (connection.has_pending_output()) {
+			return set_timeout(entry, connection.get_request().get_server_config().get_send_timeout());
+		}
+		LOG_I() << "Send a response to client fd: " << client_fd << "\n";
+
+		if (!connection.get_request().is_keep_alive()) {
+			return remove_client(entry);
 		}
 
-		remove_client(client_fd);
+		connection.finish_request();
+
+		std::string input;
+		connection.take_pending_input(input);
+		handle_input(entry, input.data(), input.size());
+
+		if (!connection.get_request().is_complete()) {
+			_iohandler.set_read_ready(client_fd, &entry);
+		}
 	}
 } /* namespace webserv */
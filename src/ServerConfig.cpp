@@ -24,8 +24,21 @@ namespace webserv {
 		_index(),
 		_allow_methods(),
 		_locations(),
+		_pattern_locations(),
+		_location_router(),
+		_routes(),
 		_client_max_body_size(-1),
-		_error_pages() {}
+		_error_pages(),
+		_keepalive_timeout(-1),
+		_keepalive_requests(-1),
+		_client_header_timeout(-1),
+		_client_body_timeout(-1),
+		_send_timeout(-1),
+		_large_header_buffers_number(-1),
+		_large_header_buffers_size(-1),
+		_client_body_buffer_size(-1),
+		_client_body_temp_path(),
+		_types() {}
 
 	ServerConfig::ServerConfig(const ServerConfig& copy) :
 		_server_names(copy._server_names),
@@ -34,8 +47,23 @@ namespace webserv {
 		_index(copy._index),
 		_allow_methods(copy._allow_methods),
 		_locations(copy._locations),
+		_pattern_locations(copy._pattern_locations),
+		_location_router(copy._location_router),
+		_routes(),
 		_client_max_body_size(copy._client_max_body_size),
-		_error_pages(copy._error_pages) {}
+		_error_pages(copy._error_pages),
+		_keepalive_timeout(copy._keepalive_timeout),
+		_keepalive_requests(copy._keepalive_requests),
+		_client_header_timeout(copy._client_header_timeout),
+		_client_body_timeout(copy._client_body_timeout),
+		_send_timeout(copy._send_timeout),
+		_large_header_buffers_number(copy._large_header_buffers_number),
+		_large_header_buffers_size(copy._large_header_buffers_size),
+		_client_body_buffer_size(copy._client_body_buffer_size),
+		_client_body_temp_path(copy._client_body_temp_path),
+		_types(copy._types) {
+		list_routes();
+	}
 
 	ServerConfig& ServerConfig::operator=(const ServerConfig& other) {
 		if (this == &other) { return *this; }
@@ -45,8 +73,21 @@ namespace webserv {
 		_index = other._index;
 		_allow_methods = other._allow_methods;
 		_locations = other._locations;
+		_pattern_locations = other._pattern_locations;
+		_location_router = other._location_router;
 		_client_max_body_size = other._client_max_body_size;
 		_error_pages = other._error_pages;
+		_keepalive_timeout = other._keepalive_timeout;
+		_keepalive_requests = other._keepalive_requests;
+		_client_header_timeout = other._client_header_timeout;
+		_client_body_timeout = other._client_body_timeout;
+		_send_timeout = other._send_timeout;
+		_large_header_buffers_number = other._large_header_buffers_number;
+		_large_header_buffers_size = other._large_header_buffers_size;
+		_client_body_buffer_size = other._client_body_buffer_size;
+		_client_body_temp_path = other._client_body_temp_path;
+		_types = other._types;
+		list_routes();
 		return *this;
 	}
 
@@ -64,6 +105,15 @@ namespace webserv {
 		types.insert("location");
 		types.insert("client_max_body_size");
 		types.insert("error_page");
+		types.insert("keepalive_timeout");
+		types.insert("keepalive_requests");
+		types.insert("client_header_timeout");
+		types.insert("client_body_timeout");
+		types.insert("send_timeout");
+		types.insert("large_client_header_buffers");
+		types.insert("client_body_buffer_size");
+		types.insert("client_body_temp_path");
+		types.insert("types");
 	}
 
 	/**
@@ -86,6 +136,22 @@ namespace webserv {
 			_client_max_body_size = std::atoi(value.c_str());
 		} else if (type == "error_page") {
 			return add_error_page(value);
+		} else if (type == "keepalive_timeout" && _keepalive_timeout == -1 && is_digits(value) && value[0] != '-') {
+			_keepalive_timeout = std::atoi(value.c_str());
+		} else if (type == "keepalive_requests" && _keepalive_requests == -1 && is_digits(value) && value[0] != '-') {
+			_keepalive_requests = std::atoi(value.c_str());
+		} else if (type == "client_header_timeout" && _client_header_timeout == -1 && is_digits(value) && value[0] != '-') {
+			_client_header_timeout = std::atoi(value.c_str());
+		} else if (type == "client_body_timeout" && _client_body_timeout == -1 && is_digits(value) && value[0] != '-') {
+			_client_body_timeout = std::atoi(value.c_str());
+		} else if (type == "send_timeout" && _send_timeout == -1 && is_digits(value) && value[0] != '-') {
+			_send_timeout = std::atoi(value.c_str());
+		} else if (type == "large_client_header_buffers") {
+			return add_large_header_buffers(value);
+		} else if (type == "client_body_buffer_size" && _client_body_buffer_size == -1 && parse_size(value) >= 0) {
+			_client_body_buffer_size = parse_size(value);
+		} else if (type == "client_body_temp_path" && _client_body_temp_path.empty()) {
+			_client_body_temp_path = value;
 		} else {
 			return false;
 		}
@@ -95,10 +161,34 @@ namespace webserv {
 
 	/**
 	 * @brief Add location to server config
+	 * @note Prefix and glob locations are keyed by uri, the others by modifier and uri
 	 * @return true if sucessfully add the location, otherwise false
 	 */
 	bool ServerConfig::add_location(LocationConfig location_config) {
-		return _locations.insert(std::make_pair(location_config.get_location(), location_config)).second;
+		std::string key = location_config.get_location();
+		if (!location_config.is_prefix() && location_config.get_match() != LOCATION_GLOB) {
+			key = std::string(LocationModifierStrings[location_config.get_match()]) + " " + key;
+		}
+
+		if (!_locations.insert(std::make_pair(key, location_config)).second) {
+			return false;
+		}
+		if (location_config.is_pattern()) {
+			_pattern_locations.push_back(key);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Set types block of server config
+	 * @return false if types were already set
+	 */
+	bool ServerConfig::set_types(const MimeTypes& types) {
+		if (!_types.empty()) {
+			return false;
+		}
+		_types = types;
+		return true;
 	}
 
 	/**
@@ -135,6 +225,41 @@ namespace webserv {
 			}
 		}
 
+		if (_keepalive_timeout == -1) {
+			_keepalive_timeout = 75;
+		}
+
+		if (_keepalive_requests == -1) {
+			_keepalive_requests = 100;
+		}
+
+		if (_client_header_timeout == -1) {
+			_client_header_timeout = 60;
+		}
+
+		if (_client_body_timeout == -1) {
+			_client_body_timeout = 60;
+		}
+
+		if (_send_timeout == -1) {
+			_send_timeout = 60;
+		}
+
+		if (_client_body_buffer_size == -1) {
+			_client_body_buffer_size = 16384;
+		}
+
+		if (_client_body_temp_path.empty()) {
+			_client_body_temp_path = "/tmp";
+		}
+
+		if (_large_header_buffers_number == -1) {
+			_large_header_buffers_number = 4;
+			_large_header_buffers_size = 8192;
+		} else if (_large_header_buffers_size == -1) {
+			return false;
+		}
+
 		if (_locations.empty()) {
 			return false;
 		}
@@ -143,6 +268,7 @@ namespace webserv {
 			return false;
 		}
 
+		route_locations();
 		return true;
 	}
 
@@ -229,6 +355,87 @@ namespace webserv {
 		return true;
 	}
 
+	/**
+	 * @brief Set number then size of buffers a request header must fit in
+	 * @note A request line or header field longer than one buffer is rejected
+	 */
+	bool ServerConfig::add_large_header_buffers(const std::string& value) {
+		if (_large_header_buffers_number == -1) {
+			if (!is_digits(value) || value[0] == '-' || std::atoi(value.c_str()) <= 0) {
+				return false;
+			}
+			_large_header_buffers_number = std::atoi(value.c_str());
+			return true;
+		}
+
+		if (_large_header_buffers_size != -1) {
+			return false;
+		}
+
+		long size = parse_size(value);
+		if (size <= 0) {
+			return false;
+		}
+		_large_header_buffers_size = size;
+		return true;
+	}
+
+	/**
+	 * @brief Location of path, with the precedence of nginx
+	 * @return location or NULL if none matches
+	 */
+	const LocationConfig* ServerConfig::find_location(const std::string& path) const {
+		int id = _location_router.find(path.data(), path.size());
+		return id == -1 ? NULL : _routes[id];
+	}
+
+	/**
+	 * @brief Compile the locations into the router, a location's id is its rank in _locations
+	 * @note Patterns are added in configuration order, which is the order they're tried in
+	 * @exception Throw runtime_error if the patterns are too complex
+	 */
+	void ServerConfig::route_locations() {
+		std::map<std::string, int> ids;
+		int id = 0;
+
+		_location_router.clear();
+		std::map<std::string, LocationConfig>::const_iterator it = _locations.begin();
+		for (; it != _locations.end(); ++it, ++id) {
+			if (it->second.is_prefix()) {
+				_location_router.add_prefix(it->first, id, it->second.get_match() == LOCATION_PREFIX_NO_PATTERNS);
+			} else if (it->second.get_match() == LOCATION_EXACT) {
+				_location_router.add_exact(it->second.get_location(), id);
+			}
+			ids[it->first] = id;
+		}
+
+		std::vector<std::string>::const_iterator p_it = _pattern_locations.begin();
+		for (; p_it != _pattern_locations.end(); ++p_it) {
+			const LocationConfig& location_config = _locations.at(*p_it);
+			PatternSyntax syntax = PATTERN_GLOB;
+			if (location_config.get_match() == LOCATION_REGEX) {
+				syntax = PATTERN_REGEX;
+			} else if (location_config.get_match() == LOCATION_REGEX_CASELESS) {
+				syntax = PATTERN_REGEX_CASELESS;
+			}
+			_location_router.add_pattern(location_config.get_location(), syntax, ids[*p_it]);
+		}
+		_location_router.compile();
+		list_routes();
+	}
+
+	/**
+	 * @brief Point the ids of the router to the locations of this config
+	 */
+	void ServerConfig::list_routes() {
+		_routes.clear();
+
+		std::map<std::string, LocationConfig>::const_iterator it = _locations.begin();
+		for (; it != _locations.end(); ++it) {
+			_routes.push_back(&it->second);
+		}
+	}
+
 	/* Getters */
 	const std::set<std::string>& ServerConfig::get_server_names() const { return _server_names; }
 	const std::set<Listen>& ServerConfig::get_listens() const { return _listens; }
@@ -238,6 +445,16 @@ namespace webserv {
 	const std::map<std::string, LocationConfig>& ServerConfig::get_locations() const { return _locations; }
 	const int& ServerConfig::get_client_max_body_size() const { return _client_max_body_size; }
 	const std::map<std::string, std::string>& ServerConfig::get_error_pages() const { return _error_pages; }
+	const int& ServerConfig::get_keepalive_timeout() const { return _keepalive_timeout; }
+	const int& ServerConfig::get_keepalive_requests() const { return _keepalive_requests; }
+	const int& ServerConfig::get_client_header_timeout() const { return _client_header_timeout; }
+	const int& ServerConfig::get_client_body_timeout() const { return _client_body_timeout; }
+	const int& ServerConfig::get_send_timeout() const { return _send_timeout; }
+	const int& ServerConfig::get_large_header_buffers_number() const { return _large_header_buffers_number; }
+	const int& ServerConfig::get_large_header_buffers_size() const { return _large_header_buffers_size; }
+	const int& ServerConfig::get_client_body_buffer_size() const { return _client_body_buffer_size; }
+	const std::string& ServerConfig::get_client_body_temp_path() const { return _client_body_temp_path; }
+	const MimeTypes& ServerConfig::get_types() const { return _types; }
 
 #ifdef PARSER_DEBUG
 	std::ostream& operator<<(std::ostream& os, const ServerConfig& server_config) {
@@ -257,6 +474,15 @@ namespace webserv {
 
 		os << "\troot " << server_config.get_root() << ";\n";
 		os << "\tindex " << server_config.get_index() << ";\n";
+		os << "\tkeepalive_timeout " << server_config.get_keepalive_timeout() << ";\n";
+		os << "\tkeepalive_requests " << server_config.get_keepalive_requests() << ";\n";
+		os << "\tclient_header_timeout " << server_config.get_client_header_timeout() << ";\n";
+		os << "\tclient_body_timeout " << server_config.get_client_body_timeout() << ";\n";
+		os << "\tsend_timeout " << server_config.get_send_timeout() << ";\n";
+		os << "\tlarge_client_header_buffers " << server_config.get_large_header_buffers_number()
+			<< " " << server_config.get_large_header_buffers_size() << ";\n";
+		os << "\tclient_body_buffer_size " << server_config.get_client_body_buffer_size() << ";\n";
+		os << "\tclient_body_temp_path " << server_config.get_client_body_temp_path() << ";\n";
 
 		os << "\tallow_methods";
 		for (std::set<std::string>::const_iterator _it = server_config.get_allow_methods().begin();
@@ -264,6 +490,10 @@ namespace webserv {
 			os << " " << *_it;
 		os << ";\n";
 
+		if (!server_config.get_types().empty()) {
+			os << server_config.get_types();
+		}
+
 		std::map<std::string, LocationConfig>::const_iterator lit = server_config.get_locations().begin();
 		std::map<std::string, LocationConfig>::const_iterator lite = server_config.get_locations().end();
 
@@ -0,0 +1,30 @@
+#include "SharedBuffer.hpp"
+
+namespace webserv {
+	SharedBuffer::SharedBuffer(const std::string& data) :
+		_data(data),
+		_references(1) {}
+
+	SharedBuffer::~SharedBuffer() {}
+
+	/**
+	 * @brief Copy data into a new buffer, the caller holds the first reference
+	 */
+	SharedBuffer* SharedBuffer::create(const std::string& data) {
+		return new SharedBuffer(data);
+	}
+
+	void SharedBuffer::retain() const {
+		++_references;
+	}
+
+	void SharedBuffer::release() const {
+		if (--_references == 0) {
+			delete this;
+		}
+	}
+
+	/* Getters */
+	const std::string& SharedBuffer::get_data() const { return _data; }
+
+} /* namespace webserv */
@@ -0,0 +1,189 @@
+#include "TimerWheel.hpp"
+
+namespace webserv {
+	namespace internal {
+		/* Struct Timer */
+
+		Timer::Timer() : prev(NULL), next(NULL), expires(0), fd(-1) {}
+
+		Timer::Timer(const Timer& copy) : prev(NULL), next(NULL), expires(0), fd(copy.fd) {}
+
+		Timer& Timer::operator=(const Timer& other) {
+			if (this == &other) { return *this; }
+			fd = other.fd;
+			return *this;
+		}
+
+		Timer::~Timer() {
+			unlink();
+		}
+
+		bool Timer::is_armed() const {
+			return prev != NULL;
+		}
+
+		void Timer::unlink() {
+			if (prev == NULL) {
+				return;
+			}
+			prev->next = next;
+			next->prev = prev;
+			prev = NULL;
+			next = NULL;
+		}
+
+		/* Class TimerWheel */
+
+		TimerWheel::TimerWheel() : _current(now_ms() / TIMER_WHEEL_RESOLUTION) {
+			for (int level = 0; level < TIMER_WHEEL_LEVELS; ++level) {
+				for (int slot = 0; slot < TIMER_WHEEL_SLOTS; ++slot) {
+					_slots[level][slot].prev = &_slots[level][slot];
+					_slots[level][slot].next = &_slots[level][slot];
+				}
+			}
+		}
+
+		/**
+		 * @brief Disarm every timer left so none points into the wheel anymore
+		 */
+		TimerWheel::~TimerWheel() {
+			for (int level = 0; level < TIMER_WHEEL_LEVELS; ++level) {
+				for (int slot = 0; slot < TIMER_WHEEL_SLOTS; ++slot) {
+					Timer& head = _slots[level][slot];
+					while (head.next != &head) {
+						head.next->unlink();
+					}
+					head.prev = NULL;
+					head.next = NULL;
+				}
+			}
+		}
+
+		/**
+		 * @brief Milliseconds of the monotonic clock, unaffected by wall clock changes
+		 */
+		unsigned long TimerWheel::now_ms() {
+			struct timespec now;
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			return static_cast<unsigned long>(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+		}
+
+		/**
+		 * @brief Arm timer to expire at expires_ms, rearming an armed timer moves it
+		 * @note Deadlines are rounded up to the next tick, a timer never fires early
+		 */
+		void TimerWheel::schedule(Timer& timer, const unsigned long& expires_ms) {
+			timer.unlink();
+			timer.expires = (expires_ms + TIMER_WHEEL_RESOLUTION - 1) / TIMER_WHEEL_RESOLUTION;
+			if (timer.expires <= _current) {
+				timer.expires = _current + 1;
+			}
+			add(timer);
+		}
+
+		void TimerWheel::cancel(Timer& timer) {
+			timer.unlink();
+		}
+
+		/**
+		 * @brief Put timer in the slot of the lowest level its deadline fits in
+		 * @note A cascaded timer may be due on the current tick, its level 0 slot
+		 * is expired right after the cascade
+		 */
+		void TimerWheel::add(Timer& timer) {
+			unsigned long max_delta = (1UL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1;
+
+			if (timer.expires - _current > max_delta) {
+				timer.expires = _current + max_delta;
+			}
+
+			unsigned long delta = timer.expires - _current;
+			int level = 0;
+			while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1UL << (TIMER_WHEEL_SLOT_BITS * (level + 1)))) {
+				++level;
+			}
+
+			Timer& head = _slots[level][(timer.expires >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK];
+			timer.prev = head.prev;
+			timer.next = &head;
+			head.prev->next = &timer;
+			head.prev = &timer;
+		}
+
+		/**
+		 * @brief Move every timer of a higher level slot down to where it now fits
+		 */
+		void TimerWheel::cascade(const int& level, const unsigned long& index) {
+			Timer& head = _slots[level][index];
+
+			while (head.next != &head) {
+				Timer* timer = head.next;
+				timer->unlink();
+				add(*timer);
+			}
+		}
+
+		/**
+		 * @brief Advance the wheel to now_ms and collect the fds of expired timers
+		 * @note Expired timers are disarmed before their fd is reported
+		 */
+		void TimerWheel::expire(const unsigned long& now_ms, std::vector<int>& expired_fds) {
+			unsigned long target = now_ms / TIMER_WHEEL_RESOLUTION;
+
+			while (_current < target) {
+				++_current;
+
+				for (int level = 1; level < TIMER_WHEEL_LEVELS; ++level) {
+					if ((_current & ((1UL << (TIMER_WHEEL_SLOT_BITS * level)) - 1)) != 0) {
+						break;
+					}
+					cascade(level, (_current >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK);
+				}
+
+				Timer& head = _slots[0][_current & TIMER_WHEEL_SLOT_MASK];
+				while (head.next != &head) {
+					Timer* timer = head.next;
+					timer->unlink();
+					expired_fds.push_back(timer->fd);
+				}
+			}
+		}
+
+		/**
+		 * @brief Milliseconds until the wheel may have to expire a timer
+		 * @return -1 if no timer is armed
+		 * @note Timers in higher levels report the time they cascade, which is
+		 * never later than their deadline
+		 */
+		int TimerWheel::get_next_timeout(const unsigned long& now_ms) const {
+			unsigned long next = 0;
+
+			for (int level = 0; level < TIMER_WHEEL_LEVELS; ++level) {
+				unsigned long base = _current >> (TIMER_WHEEL_SLOT_BITS * level);
+
+				for (unsigned long k = 1; k <= TIMER_WHEEL_SLOTS; ++k) {
+					const Timer& head = _slots[level][(base + k) & TIMER_WHEEL_SLOT_MASK];
+					if (head.next == &head) {
+						continue;
+					}
+
+					unsigned long tick = (base + k) << (TIMER_WHEEL_SLOT_BITS * level);
+					if (tick <= _current) {
+						tick = _current + 1;
+					}
+					if (next == 0 || tick < next) {
+						next = tick;
+					}
+					break;
+				}
+			}
+
+			if (next == 0) {
+				return -1;
+			}
+
+			unsigned long next_ms = next * TIMER_WHEEL_RESOLUTION;
+			return next_ms > now_ms ? static_cast<int>(next_ms - now_ms) : 0;
+		}
+	} /* namespace internal */
+} /* namespace webserv */
@@ -51,6 +51,14 @@ namespace webserv {
 							_current_token.text.append(1, current_char);
 						}
 						break;
+					case '"':
+					case '\'':
+						if (_current_token.type == WHITESPACE) {
+							add_quoted_token(current_char);
+							break;
+						}
+						_current_token.text.append(1, current_char);
+						break;
 					default:
 						if (_current_token.type == WHITESPACE) {
 							add_current_token();
@@ -76,6 +84,29 @@ namespace webserv {
 			_current_token.type = WHITESPACE;
 		}
 
+		/**
+		 * @brief Add a value quoted with quote, like nginx it can hold spaces,
+		 * '{', '}', ';' and '#', as regexes of locations need
+		 * @note An unterminated quote runs to the end of the string
+		 */
+		void Tokenizer::add_quoted_token(char quote) {
+			size_t line_number = _current_token.line_number;
+			size_t end = _str.find(quote, _cursor + 1);
+			if (end == std::string::npos) {
+				end = _str.length();
+			}
+
+			_current_token.type = IDENTIFIER;
+			_current_token.text = _str.substr(_cursor + 1, end - _cursor - 1);
+			add_current_token();
+			for (; _cursor < end; ++_cursor) {
+				if (_str[_cursor] == '\n') {
+					++line_number;
+				}
+			}
+			_current_token.line_number = line_number;
+		}
+
 #ifdef PARSER_DEBUG
 		std::ostream& operator<<(std::ostream& os, const Token& token) {
 			os << "[line " << token.line_number << "]";
@@ -0,0 +1,165 @@
+#include "VirtualHosts.hpp"
+
+#include <cctype>
+#include <strings.h>
+
+#define HOST_INDEX_MIN_SLOTS 8
+
+namespace webserv {
+	/* Class HostIndex */
+
+	HostIndex::HostIndex() :
+		_entries(),
+		_slots(),
+		_mask(0),
+		_default(NULL) {}
+
+	HostIndex::HostIndex(const HostIndex& copy) :
+		_entries(copy._entries),
+		_slots(copy._slots),
+		_mask(copy._mask),
+		_default(copy._default) {}
+
+	HostIndex& HostIndex::operator=(const HostIndex& other) {
+		if (this == &other) { return *this; }
+		_entries = other._entries;
+		_slots = other._slots;
+		_mask = other._mask;
+		_default = other._default;
+		return *this;
+	}
+
+	HostIndex::~HostIndex() {}
+
+	/**
+	 * @brief Add the names of server_config, call build once all servers are added
+	 * @note Like nginx the first server of a listen is its default and a name
+	 * already taken on the listen keeps its first server
+	 */
+	void HostIndex::add(const ServerConfig& server_config) {
+		if (_default == NULL) {
+			_default = &server_config;
+		}
+
+		std::set<std::string>::const_iterator it = server_config.get_server_names().begin();
+		for (; it != server_config.get_server_names().end(); ++it) {
+			std::string name = *it;
+			for (size_t i = 0; i < name.size(); ++i) {
+				name[i] = std::tolower(name[i]);
+			}
+
+			bool taken = false;
+			for (size_t i = 0; i < _entries.size() && !taken; ++i) {
+				taken = _entries[i].first == name;
+			}
+			if (!taken) {
+				_entries.push_back(std::make_pair(name, &server_config));
+			}
+		}
+	}
+
+	/**
+	 * @brief Build the slot table, at least twice the names
+	 */
+	void HostIndex::build() {
+		size_t slot_count = HOST_INDEX_MIN_SLOTS;
+		while (slot_count < _entries.size() * 2) {
+			slot_count *= 2;
+		}
+
+		_slots.assign(slot_count, -1);
+		_mask = slot_count - 1;
+		for (size_t i = 0; i < _entries.size(); ++i) {
+			size_t slot = slot_of(_entries[i].first.data(), _entries[i].first.size());
+			while (_slots[slot] != -1) {
+				slot = (slot + 1) & _mask;
+			}
+			_slots[slot] = i;
+		}
+	}
+
+	/**
+	 * @brief Server named host, case-insensitive and without port
+	 * @return server or NULL if no server has that name
+	 */
+	const ServerConfig* HostIndex::find(const char* host, size_t size) const {
+		if (_slots.empty()) {
+			return NULL;
+		}
+
+		// "example.com." is the same host as "example.com"
+		if (size > 0 && host[size - 1] == '.') {
+			--size;
+		}
+
+		for (size_t slot = slot_of(host, size); _slots[slot] != -1; slot = (slot + 1) & _mask) {
+			const std::pair<std::string, const ServerConfig*>& entry = _entries[_slots[slot]];
+			if (entry.first.size() == size && strncasecmp(entry.first.data(), host, size) == 0) {
+				return entry.second;
+			}
+		}
+		return NULL;
+	}
+
+	/**
+	 * @brief FNV-1a of the lowercase host, folded on the table size
+	 */
+	size_t HostIndex::slot_of(const char* host, size_t size) const {
+		unsigned hash = 2166136261u;
+
+		for (size_t i = 0; i < size; ++i) {
+			hash ^= static_cast<unsigned char>(std::tolower(host[i]));
+			hash *= 16777619u;
+		}
+		return (hash ^ (hash >> 16)) & _mask;
+	}
+
+	/* Getters */
+	const ServerConfig& HostIndex::get_default() const { return *_default; }
+
+	/* Class VirtualHosts */
+
+	VirtualHosts::VirtualHosts() :
+		_indexes() {}
+
+	VirtualHosts::VirtualHosts(const VirtualHosts& copy) :
+		_indexes(copy._indexes) {}
+
+	VirtualHosts& VirtualHosts::operator=(const VirtualHosts& other) {
+		if (this == &other) { return *this; }
+		_indexes = other._indexes;
+		return *this;
+	}
+
+	VirtualHosts::~VirtualHosts() {}
+
+	/**
+	 * @brief Index the servers of every listen, in configuration order
+	 */
+	void VirtualHosts::build(const std::vector<ServerConfig>& server_configs) {
+		_indexes.clear();
+
+		std::vector<ServerConfig>::const_iterator s_it = server_configs.begin();
+		for (; s_it != server_configs.end(); ++s_it) {
+			std::set<Listen>::const_iterator l_it = s_it->get_listens().begin();
+			for (; l_it != s_it->get_listens().end(); ++l_it) {
+				_indexes[*l_it].add(*s_it);
+			}
+		}
+
+		std::map<Listen, HostIndex>::iterator it = _indexes.begin();
+		for (; it != _indexes.end(); ++it) {
+			it->second.build();
+		}
+	}
+
+	/**
+	 * @brief Host index of listen
+	 * @return index or NULL if no server listens on it
+	 */
+	const HostIndex* VirtualHosts::find(const Listen& listen) const {
+		std::map<Listen, HostIndex>::const_iterator it = _indexes.find(listen);
+		return it == _indexes.end() ? NULL : &it->second;
+	}
+
+} /* namespace webserv */
@@ -25,7 +25,7 @@ the '&' character inside of the actual data gets translated to "%26"
 	- also translated: ' '(space), '=', '%'?
 */
 std::string run_cgi_script(std::map<std::string, std::string> envp_map,
-	std::string request_body)
+	std::string const &request_body, int body_fd)
 {
 	const char *bin_file;
 	const char *script_name;
@@ -66,7 +66,12 @@ std::string run_cgi_script(std::map<std::string, std::string> envp_map,
 	{
 		method = envp_map.find("REQUEST_METHOD")->second.c_str();
 		// LOG_D() << "REQUEST_METHOD=" << method << '\n';
-		if (std::strcmp(method, "POST") == 0 && request_body.length() > 0)
+		if (body_fd != -1) // body spooled to a temporary file
+		{
+			lseek(body_fd, 0, SEEK_SET);
+			dup2(body_fd, STDIN_FILENO);
+		}
+		else if (std::strcmp(method, "POST") == 0 && request_body.length() > 0)
 		{
 			FILE *file = std::fopen("tempfile_", "w");
 			if (file == NULL)
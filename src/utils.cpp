@@ -1,4 +1,10 @@
 #include "utils.hpp"
+#include "HttpTables.hpp"
+
+#include <vector>
+#include <cctype>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace webserv {
 	/**
@@ -26,13 +32,42 @@ namespace webserv {
 	 */
 	std::string get_current_time(const char* format) {
 		std::time_t time_epoch = std::time(0);
+		struct tm time_info;
 		char buffer[69];
 
-		std::strftime(buffer, sizeof(buffer), format, std::localtime(&time_epoch));
+		std::strftime(buffer, sizeof(buffer), format, localtime_r(&time_epoch, &time_info));
+
+		return std::string(buffer);
+	}
+
+	/**
+	 * @brief HTTP-date of time, "Sun, 06 Nov 1994 08:49:37 GMT"
+	 */
+	std::string format_http_date(const std::time_t& time) {
+		struct tm time_info;
+		char buffer[32];
+
+		std::strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", gmtime_r(&time, &time_info));
 
 		return std::string(buffer);
 	}
 
+	/**
+	 * @brief Time of an HTTP-date in the preferred format of format_http_date
+	 * @note The obsolete RFC 850 and asctime formats aren't accepted
+	 * @return time or -1 if date isn't valid
+	 */
+	std::time_t parse_http_date(const std::string& date) {
+		struct tm time_info;
+
+		std::memset(&time_info, 0, sizeof(time_info));
+		const char* end = strptime(date.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &time_info);
+		if (end == NULL || *end != '\0') {
+			return -1;
+		}
+		return timegm(&time_info);
+	}
+
 	/**
 	 * @brief Check if file has correct extension
 	 */
@@ -59,6 +94,35 @@ namespace webserv {
 		return str_to_check.find_first_not_of("0123456789") == std::string::npos;
 	}
 
+	/**
+	 * @brief Parse a size like nginx does, "512", "8k" or "1m"
+	 * @return size in bytes, -1 if invalid or too big for an int
+	 */
+	long parse_size(const std::string& str) {
+		if (str.empty() || str.find_first_not_of("0123456789") == 0) {
+			return -1;
+		}
+
+		size_t digits_end = str.find_first_not_of("0123456789");
+		std::string digits = str.substr(0, digits_end);
+		std::string unit = digits_end == std::string::npos ? "" : str.substr(digits_end);
+
+		long multiplier = 1;
+		if (unit == "k" || unit == "K") {
+			multiplier = 1024;
+		} else if (unit == "m" || unit == "M") {
+			multiplier = 1024 * 1024;
+		} else if (!unit.empty() || digits.size() > 10) {
+			return -1;
+		}
+
+		long size = std::atol(digits.c_str());
+		if (size > 2147483647L / multiplier) {
+			return -1;
+		}
+		return size * multiplier;
+	}
+
 	/**
 	 * @brief Check if ip4 string is valid
 	 * @note In case of fatal error which should never happen, program will exit
@@ -158,35 +222,76 @@ namespace webserv {
 		return (end == std::string::npos) ? s : s.substr(0, end + 1);
 	}
 
+	/**
+	 * @brief Whether the Accept-Encoding field accepts coding
+	 * @note A coding with q=0 is refused, "*" stands for the codings not listed
+	 */
+	bool is_coding_accepted(const std::string& accept_encoding, const std::string& coding) {
+		int wildcard = -1;
+		size_t pos = 0;
+
+		while (pos < accept_encoding.size()) {
+			size_t end = accept_encoding.find(',', pos);
+			if (end == std::string::npos) {
+				end = accept_encoding.size();
+			}
+			std::string item = accept_encoding.substr(pos, end - pos);
+			pos = end + 1;
+
+			size_t params = item.find(';');
+			std::string name = item.substr(0, params);
+			size_t first = name.find_first_not_of(" \t");
+			if (first == std::string::npos) {
+				continue;
+			}
+			name = name.substr(first, name.find_last_not_of(" \t") + 1 - first);
+
+			bool accepted = true;
+			if (params != std::string::npos) {
+				for (size_t i = params; i < item.size(); ++i) {
+					item[i] = std::tolower(item[i]);
+				}
+				size_t q = item.find("q=", params);
+				accepted = q == std::string::npos || std::strtod(item.c_str() + q + 2, NULL) > 0;
+			}
+
+			if (strcasecmp(name.c_str(), coding.c_str()) == 0) {
+				return accepted;
+			}
+			if (name == "*") {
+				wildcard = accepted;
+			}
+		}
+		return wildcard == 1;
+	}
+
 	/**
 	 * @brief Parse header fields
+	 * @note Every line is scanned once, only names and values are copied
 	 * @throw std::logic_error if header is invalid
 	 */
-	std::map<std::string, std::string> parse_header_fields(const std::string& raw) {
-		std::string headers = raw;
+	std::map<std::string, std::string> parse_header_fields(const std::string& headers) {
 		std::map<std::string, std::string> header_list;
-		size_t pos = headers.find("\r\n");
-
-		for (; !headers.empty(); pos = headers.find("\r\n")) {
-			std::string possible_header = headers.substr(0, pos);
-			if (pos == std::string::npos) {
-				headers.clear();
-			} else {
-				headers = headers.substr(pos + 2);
-			}
+		size_t line_start = 0;
 
-			size_t header_pos = possible_header.find(": ");
-			if (header_pos == std::string::npos) {
-				throw new std::logic_error("Invalid header field");
+		while (line_start < headers.size()) {
+			size_t line_end = internal::find_bytes(headers, CRLF, 2, line_start);
+			if (line_end == std::string::npos) {
+				line_end = headers.size();
 			}
 
-			std::string key = possible_header.substr(0, header_pos);
-			std::string value = possible_header.substr(header_pos + 2);
+			size_t header_pos = internal::find_bytes(headers, ": ", 2, line_start);
+			if (header_pos == std::string::npos || header_pos >= line_end) {
+				throw std::logic_error("Invalid header field");
+			}
 
+			std::string key(headers, line_start, header_pos - line_start);
 			if (header_list.count(key) > 0) {
-				throw new std::logic_error("Duplicate header field");
+				throw std::logic_error("Duplicate header field");
 			}
-			header_list[key] = value;
+			header_list[key].assign(headers, header_pos + 2, line_end - header_pos - 2);
+
+			line_start = line_end + 2;
 		}
 
 		return header_list;
@@ -207,185 +312,56 @@ namespace webserv {
 	}
 
 	/**
-	 * @brief Get the HTTP Message of status code
+	 * @brief Open an anonymous read-write file in directory, gone once closed
+	 * @note O_TMPFILE where the system and file system have it, otherwise a
+	 * unique file is created and unlinked right away
+	 * @return file descriptor or -1 on error
 	 */
-	std::string get_status_message(const int& status_code) {
-		switch(status_code) {
-			case 200:
-				return "OK";
-			case 201:
-				return "Created";
-			case 202:
-				return "Accepted";
-			case 204:
-				return "No Content";
-			case 300:
-				return "Multiple Choices";
-			case 301:
-				return "Moved Permanently";
-			case 302:
-				return "Found";
-			case 303:
-				return "See Other";
-			case 400:
-				return "Bad Request";
-			case 401:
-				return "Unauthorized";
-			case 403:
-				return "Forbidden";
-			case 404:
-				return "Not Found";
-			case 405:
-				return "Method Not Allowed";
-			case 413:
-				return "Request Too Large";
-			case 418:
-				return "I'm a teapot";
-			case 500:
-				return "Internal Server Error";
-			case 501:
-				return "Not Implemented";
-			case 502:
-				return "Bad Gateway";
-			case 503:
-				return "Service Unavailable";
-			case 505:
-				return "HTTP Version Not Supported";
-			default:
-				return "Not Implemented";
+	int open_temp_file(const std::string& directory) {
+		int fd = -1;
+#ifdef O_TMPFILE
+		fd = open(directory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+		if (fd != -1) {
+			return fd;
 		}
-		return "Not Implemented";
+#endif
+		std::string path = directory + "/webserv_XXXXXX";
+		std::vector<char> path_template(path.begin(), path.end());
+		path_template.push_back('\0');
+
+		fd = mkstemp(&path_template[0]);
+		if (fd == -1) {
+			return -1;
+		}
+		unlink(&path_template[0]);
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+		return fd;
 	}
 
 	/**
-	 * @brief Get correct mime type from extension
+	 * @brief Write all of data to a blocking fd, like a regular file
+	 * @return false on error
 	 */
-	std::string get_mime_type(const std::string& type) {
-		if (type == ".aac")
-			return "audio/aac";
-		else if (type == ".abw")
-			return "application/x-abiword";
-		else if (type == ".arc")
-			return "application/octet-stream";
-		else if (type == ".avi")
-			return "video/x-msvideo";
-		else if (type == "avif")
-			return "image/avif";
-		else if (type == ".azw")
-			return "application/vnd.amazon.ebook";
-		else if (type == ".bin")
-			return "application/octet-stream";
-		else if (type == ".bmp")
-			return "image/bmp";
-		else if (type == ".bz")
-			return "application/x-bzip";
-		else if (type == ".bz2")
-			return "application/x-bzip2";
-		else if (type == ".cda")
-			return "application/x-cdf";
-		else if (type == ".csh")
-			return "application/x-csh";
-		else if (type == ".css")
-			return "text/css";
-		else if (type == ".csv")
-			return "text/csv";
-		else if (type == ".doc")
-			return "application/msword";
-		else if (type == ".epub")
-			return "application/epub+zip";
-		else if (type == ".gif")
-			return "image/gif";
-		else if (type == ".htm")
-			return "text/html";
-		else if (type == ".html")
-			return "text/html";
-		else if (type == ".ico")
-			return "image/x-icon";
-		else if (type == ".ics")
-			return "text/calendar";
-		else if (type == ".jar")
-			return "application/java-archive";
-		else if (type == ".jpeg")
-			return "image/jpeg";
-		else if (type == ".jpg")
-			return "image/jpeg";
-		else if (type == ".js")
-			return "application/js";
-		else if (type == ".json")
-			return "application/json";
-		else if (type == ".mid")
-			return "audio/midi";
-		else if (type == ".midi")
-			return "audio/midi";
-		else if (type == ".mpeg")
-			return "video/mpeg";
-		else if (type == ".mpkg")
-			return "application/vnd.apple.installer+xml";
-		else if (type == ".odp")
-			return "application/vnd.oasis.opendocument.presentation";
-		else if (type == ".ods")
-			return "application/vnd.oasis.opendocument.spreadsheet";
-		else if (type == ".odt")
-			return "application/vnd.oasis.opendocument.text";
-		else if (type == ".oga")
-			return "audio/ogg";
-		else if (type == ".ogv")
-			return "video/ogg";
-		else if (type == ".ogx")
-			return "application/ogg";
-		else if (type == ".pdf")
-			return "application/pdf";
-		else if (type == ".png")
-			return "image/png";
-		else if (type == ".ppt")
-			return "application/vnd.ms-powerpoint";
-		else if (type == ".rar")
-			return "application/x-rar-compressed";
-		else if (type == ".rtf")
-			return "application/rtf";
-		else if (type == ".sh")
-			return "application/x-sh";
-		else if (type == ".svg")
-			return "image/svg+xml";
-		else if (type == ".swf")
-			return "application/x-shockwave-flash";
-		else if (type == ".tar")
-			return "application/x-tar";
-		else if (type == ".tif")
-			return "image/tiff";
-		else if (type == ".tiff")
-			return "image/tiff";
-		else if (type == ".ttf")
-			return "application/x-font-ttf";
-		else if (type == ".vsd")
-			return "application/vnd.visio";
-		else if (type == ".wav")
-			return "audio/x-wav";
-		else if (type == ".weba")
-			return "audio/webm";
-		else if (type == ".webm")
-			return "video/webm";
-		else if (type == ".webp")
-			return "image/webp";
-		else if (type == ".woff")
-			return "application/x-font-woff";
-		else if (type == ".xhtml")
-			return "application/xhtml+xml";
-		else if (type == ".xls")
-			return "application/vnd.ms-excel";
-		else if (type == ".xml")
-			return "application/xml";
-		else if (type == ".xul")
-			return "application/vnd.mozilla.xul+xml";
-		else if (type == ".zip")
-			return "application/zip";
-		else if (type == ".3gp")
-			return "video/3gpp audio/3gpp";
-		else if (type == ".3g2")
-			return "video/3gpp2 audio/3gpp2";
-		else if (type == ".7z")
-			return "application/x-7z-compressed";
-
-		return "text/plain";
+	bool write_all(int fd, const char* data, size_t size) {
+		while (size > 0) {
+			ssize_t written = write(fd, data, size);
+			if (written == -1) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return false;
+			}
+			data += written;
+			size -= written;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Get the HTTP Message of status code
+	 */
+	std::string get_status_message(const int& status_code) {
+		const StatusLine* status_line = find_status_line(status_code);
+		return status_line == NULL ? "Not Implemented" : status_line->reason;
 	}
 } /* namespace webserv */
@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+#include <vector>
+#include <string>
+
+#include "ByteRanges.hpp"
+#include "utils.hpp"
+
+namespace webserv { namespace internal {
+
+TEST(ByteRangesTest, ParseTest) {
+	std::vector<ByteRange> ranges;
+
+	EXPECT_EQ(parse_byte_ranges("bytes=0-499", 1000, ranges), RANGES_SATISFIABLE);
+	ASSERT_EQ(ranges.size(), 1u);
+	EXPECT_EQ(ranges[0].start, 0);
+	EXPECT_EQ(ranges[0].end, 500);
+	EXPECT_EQ(format_content_range(ranges[0], 1000), "bytes 0-499/1000");
+
+	// Open ends, suffixes and last positions past the end are clamped
+	EXPECT_EQ(parse_byte_ranges("Bytes=900-, -50 ,\t200-299", 1000, ranges), RANGES_SATISFIABLE);
+	ASSERT_EQ(ranges.size(), 3u);
+	EXPECT_EQ(ranges[0].start, 900);
+	EXPECT_EQ(ranges[0].end, 1000);
+	EXPECT_EQ(ranges[1].start, 950);
+	EXPECT_EQ(ranges[1].end, 1000);
+	EXPECT_EQ(ranges[2].start, 200);
+	EXPECT_EQ(ranges[2].end, 300);
+	EXPECT_EQ(parse_byte_ranges("bytes=-5000", 1000, ranges), RANGES_SATISFIABLE);
+	EXPECT_EQ(ranges[0].start, 0);
+	EXPECT_EQ(ranges[0].end, 1000);
+	EXPECT_EQ(parse_byte_ranges("bytes=990-5000", 1000, ranges), RANGES_SATISFIABLE);
+	EXPECT_EQ(ranges[0].end, 1000);
+
+	// Unsatisfiable specs are dropped
+	EXPECT_EQ(parse_byte_ranges("bytes=1000-,0-0", 1000, ranges), RANGES_SATISFIABLE);
+	EXPECT_EQ(ranges.size(), 1u);
+	EXPECT_EQ(parse_byte_ranges("bytes=1000-1999", 1000, ranges), RANGES_UNSATISFIABLE);
+	EXPECT_TRUE(ranges.empty());
+	EXPECT_EQ(parse_byte_ranges("bytes=-0", 1000, ranges), RANGES_UNSATISFIABLE);
+	EXPECT_EQ(parse_byte_ranges("bytes=0-", 0, ranges), RANGES_UNSATISFIABLE);
+};
+
+TEST(ByteRangesTest, IgnoreTest) {
+	std::vector<ByteRange> ranges;
+	const char* fields[] = {
+		"", "bytes", "bytes=", "bytes= , ", "items=0-1", "bytes 0-1", "bytes=a-1", "bytes=5-1",
+		"bytes=0-1,5x", "bytes=0-1;", "bytes=--1", "bytes=0-1-2", "bytes=99999999999999999999-"
+	};
+
+	for (size_t i = 0; i < sizeof(fields) / sizeof(*fields); ++i) {
+		EXPECT_EQ(parse_byte_ranges(fields[i], 1000, ranges), RANGES_IGNORED) << fields[i];
+		EXPECT_TRUE(ranges.empty()) << fields[i];
+	}
+
+	// Too many ranges, or more bytes than the whole representation
+	std::string field = "bytes=0-0";
+	for (int i = 1; i <= BYTE_RANGES_MAX; ++i) {
+		field += "," + to_string(i) + "-" + to_string(i);
+	}
+	EXPECT_EQ(parse_byte_ranges(field, 1000, ranges), RANGES_IGNORED);
+	EXPECT_EQ(parse_byte_ranges("bytes=0-599,400-999", 1000, ranges), RANGES_IGNORED);
+	EXPECT_EQ(parse_byte_ranges("bytes=0-499,500-999", 1000, ranges), RANGES_SATISFIABLE);
+};
+
+TEST(ByteRangesTest, BoundaryGeneratorTest) {
+	BoundaryGenerator first(1);
+	BoundaryGenerator second(2);
+
+	// Boundaries of one worker never repeat, and workers never share one
+	std::string boundary = first.next();
+	EXPECT_NE(first.next(), boundary);
+	EXPECT_NE(second.next(), boundary);
+	EXPECT_EQ(boundary.find_first_not_of("0123456789-"), std::string::npos);
+}
+
+}} /* namespace webserv::internal */
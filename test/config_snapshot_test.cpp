@@ -0,0 +1,44 @@
+#include "gtest/gtest.h"
+#include <vector>
+#include <string>
+#include <strings.h>
+
+#include "Parser.hpp"
+#include "ConfigSnapshot.hpp"
+#include "Request.hpp"
+
+namespace webserv { namespace internal {
+
+TEST(ConfigSnapshotTest, ShareTest) {
+	Parser parser;
+	std::vector<ServerConfig> server_configs = parser.parse(
+		"server {\n\tlisten 127.0.0.1:8080;\n\tserver_name a.example.com;\n\tlocation / {\n\t}\n}\n"
+		"server {\n\tlisten 127.0.0.1:8080;\n\tserver_name b.example.com;\n\tlocation / {\n\t}\n}\n");
+
+	ConfigRef config(ConfigSnapshot::create(server_configs));
+	ConfigRef copy(config);
+	ConfigRef other;
+	other = copy;
+	EXPECT_EQ(config.get(), copy.get());
+	EXPECT_EQ(config.get(), other.get());
+
+	Listen listen;
+	listen.address = "127.0.0.1";
+	listen.port = 8080;
+	const HostIndex* hosts = copy->get_virtual_hosts().find(listen);
+	ASSERT_TRUE(hosts != NULL);
+	EXPECT_EQ(&hosts->get_default(), &config->get_server_configs()[0]);
+
+	struct sockaddr_in client_address;
+	bzero(&client_address, sizeof(client_address));
+	Request req(client_address, listen);
+	std::string raw = "GET / HTTP/1.1\r\nHost: b.example.com\r\n\r\n";
+	req.feed(raw.data(), raw.size(), *hosts);
+	EXPECT_EQ(req.get_status_code(), 0);
+	EXPECT_EQ(&req.get_server_config(), &config->get_server_configs()[1]);
+
+	Request copied_req(req);
+	EXPECT_EQ(&copied_req.get_server_config(), &config->get_server_configs()[1]);
+};
+
+}} /* namespace webserv::internal */
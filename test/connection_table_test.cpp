@@ -0,0 +1,42 @@
+#include "gtest/gtest.h"
+#include <cstring>
+
+#include "ConnectionTable.hpp"
+
+namespace webserv { namespace internal {
+
+TEST(ConnectionTableTest, AddGetRemoveTest) {
+	ConnectionTable table;
+	Listen listen;
+	listen.address = "127.0.0.1";
+	listen.port = 8080;
+	struct sockaddr_in client_address;
+	bzero(&client_address, sizeof(client_address));
+
+	EXPECT_GT(table.get_capacity(), 200);
+	EXPECT_TRUE(table.get(5) == NULL);
+
+	ConnectionEntry* listener = table.add_listener(5, listen);
+	ASSERT_TRUE(listener != NULL);
+	EXPECT_EQ(listener->type, ENTRY_LISTENER);
+	EXPECT_EQ(listener->fd, 5);
+	EXPECT_EQ(listener->listen.port, 8080);
+	EXPECT_TRUE(table.add_client(5, client_address, listen) == NULL);
+
+	ConnectionEntry* client = table.add_client(150, client_address, listen);
+	ASSERT_TRUE(client != NULL);
+	EXPECT_EQ(client->type, ENTRY_CLIENT);
+	EXPECT_EQ(client->fd, 150);
+	EXPECT_EQ(client->get_connection().get_request_count(), 0);
+	EXPECT_EQ(table.get(150), client);
+	EXPECT_EQ(table.get(5), listener);
+
+	table.remove(150);
+	EXPECT_EQ(client->type, ENTRY_FREE);
+	EXPECT_EQ(table.add_client(150, client_address, listen), client);
+
+	EXPECT_TRUE(table.get(-1) == NULL);
+	EXPECT_TRUE(table.add_client(table.get_capacity(), client_address, listen) == NULL);
+};
+
+}} /* namespace webserv::internal */
@@ -0,0 +1,115 @@
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <fcntl.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "Connection.hpp"
+#include "Parser.hpp"
+#include "VirtualHosts.hpp"
+#include "utils.hpp"
+
+namespace webserv { namespace internal {
+
+TEST(ConnectionTest, FlushFileTest) {
+	std::string content;
+	for (int i = 0; i < 300000; ++i) {
+		content += static_cast<char>('a' + std::rand() % 26);
+	}
+	int file_fd = open_temp_file("/tmp");
+	ASSERT_NE(file_fd, -1);
+	ASSERT_TRUE(write_all(file_fd, content.data(), content.size()));
+
+	int sockets[2];
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+	fcntl(sockets[0], F_SETFL, O_NONBLOCK);
+	int buffer_size = 4096;
+	setsockopt(sockets[0], SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+
+	struct sockaddr_in client_address;
+	bzero(&client_address, sizeof(client_address));
+	Listen listen;
+	listen.address = "127.0.0.1";
+	listen.port = 8080;
+	Connection connection(client_address, listen);
+	connection.queue_output("header\r\n\r\n");
+	connection.queue_file_part(file_fd, 0, 10);
+	connection.queue_output("--");
+	connection.queue_file(file_fd, 100, content.size() - 100);
+	connection.queue_output("next");
+
+	// The socket takes a few KB at a time, every flush resumes where the last stopped
+	std::string received;
+	char buffer[8192];
+	int flushes = 0;
+	while (connection.has_pending_output()) {
+		ASSERT_TRUE(connection.flush_output(sockets[0]));
+		++flushes;
+		ssize_t size = recv(sockets[1], buffer, sizeof(buffer), MSG_DONTWAIT);
+		if (size > 0) {
+			received.append(buffer, size);
+		}
+	}
+	ssize_t size;
+	while ((size = recv(sockets[1], buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+		received.append(buffer, size);
+	}
+
+	EXPECT_GT(flushes, 1);
+	EXPECT_EQ(received, "header\r\n\r\n" + content.substr(0, 10) + "--" + content.substr(100, content.size() - 200) + "next");
+	EXPECT_EQ(fcntl(file_fd, F_GETFD), -1);
+	close(sockets[0]);
+	close(sockets[1]);
+}
+
+TEST(ConnectionTest, HeaderTimeoutTest) {
+	Parser parser;
+	std::vector<ServerConfig> server_configs = parser.parse("server {\n\tlisten 127.0.0.1:8080;\n\tclient_header_timeout 2;\n\tkeepalive_timeout 5;\n\tclient_body_timeout 3;\n\tlocation / {\n\t}\n}\n");
+	const Listen& listen = *server_configs.front().get_listens().begin();
+	VirtualHosts virtual_hosts;
+	virtual_hosts.build(server_configs);
+	const HostIndex& hosts = *virtual_hosts.find(listen);
+
+	struct sockaddr_in client_address;
+	bzero(&client_address, sizeof(client_address));
+	Connection connection(client_address, listen);
+	TimerWheel wheel;
+	unsigned long now = TimerWheel::now_ms();
+	std::vector<int> expired;
+	connection.get_timer().fd = 3;
+
+	// Armed at accept, a header byte every 100ms never pushes the deadline back
+	wheel.schedule(connection.get_timer(), now + 2000);
+	std::string raw = "GET / HTTP/1.1\r\nHost: a\r\nX-Slow: abc";
+	for (size_t i = 0; i < 20; ++i) {
+		wheel.expire(now + i * 100, expired);
+		ASSERT_TRUE(expired.empty());
+		bool was_started = connection.get_request().has_started();
+		connection.get_request().feed(raw.data() + i, 1, hosts);
+		EXPECT_EQ(connection.get_input_timeout(was_started), -1);
+	}
+	wheel.expire(now + 2010, expired);
+	ASSERT_EQ(expired.size(), 1);
+	EXPECT_EQ(expired[0], 3);
+
+	// On keep-alive, idle waits keepalive_timeout and the first byte arms the header deadline once
+	raw += "\r\n\r\n";
+	connection.get_request().feed(raw.data() + 20, raw.size() - 20, hosts);
+	ASSERT_TRUE(connection.get_request().is_complete());
+	EXPECT_EQ(connection.get_request().get_status_code(), 0);
+	connection.finish_request();
+	connection.get_request().feed("", 0, hosts);
+	EXPECT_EQ(connection.get_input_timeout(false), 5);
+	connection.get_request().feed("\r\n", 2, hosts);
+	EXPECT_EQ(connection.get_input_timeout(false), 2);
+	connection.get_request().feed("POST / HTTP/1.1\r\nHost: a\r\n", 26, hosts);
+	EXPECT_EQ(connection.get_input_timeout(true), -1);
+	connection.get_request().feed("Content-Length: 4\r\n\r\nab", 23, hosts);
+	ASSERT_EQ(connection.get_request().get_parse_state(), PARSE_BODY);
+	EXPECT_EQ(connection.get_input_timeout(true), 3);
+}
+
+}} /* namespace webserv::internal */
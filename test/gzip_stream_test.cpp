@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+#include <string>
+#include <cstdlib>
+#include <fcntl.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <zlib.h>
+
+#include "GzipStream.hpp"
+#include "Connection.hpp"
+#include "utils.hpp"
+
+namespace webserv { namespace internal {
+
+/**
+ * @brief Decompress a whole gzip stream
+ */
+static std::string gzip_stream_test_inflate(const std::string& compressed) {
+	z_stream stream;
+	bzero(&stream, sizeof(stream));
+	EXPECT_EQ(inflateInit2(&stream, 15 + 16), Z_OK);
+
+	std::string output;
+	char buffer[4096];
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+	stream.avail_in = compressed.size();
+	int ret;
+	do {
+		stream.next_out = reinterpret_cast<Bytef*>(buffer);
+		stream.avail_out = sizeof(buffer);
+		ret = inflate(&stream, Z_NO_FLUSH);
+		output.append(buffer, sizeof(buffer) - stream.avail_out);
+	} while (ret == Z_OK);
+	EXPECT_EQ(ret, Z_STREAM_END);
+	inflateEnd(&stream);
+	return output;
+}
+
+static std::string gzip_stream_test_content(size_t size) {
+	std::string content;
+	for (size_t i = 0; i < size; ++i) {
+		content += "<p>" + to_string(std::rand() % 1000) + "</p>\n";
+	}
+	return content;
+}
+
+TEST(GzipStreamTest, CompressTest) {
+	std::string content = gzip_stream_test_content(20000);
+	std::string half = content.substr(0, content.size() / 2);
+
+	GzipStream gzip(6, content.size());
+	std::string compressed;
+	ASSERT_TRUE(gzip.compress(half.data(), half.size(), false, compressed));
+
+	// A copy goes on from the same state
+	GzipStream copy(gzip);
+	std::string copy_compressed = compressed;
+	ASSERT_TRUE(gzip.compress(content.data() + half.size(), content.size() - half.size(), true, compressed));
+	ASSERT_TRUE(copy.compress(content.data() + half.size(), content.size() - half.size(), true, copy_compressed));
+	EXPECT_FALSE(gzip.compress("x", 1, true, compressed));
+
+	EXPECT_LT(compressed.size(), content.size() / 2);
+	EXPECT_EQ(gzip_stream_test_inflate(compressed), content);
+	EXPECT_EQ(copy_compressed, compressed);
+
+	std::string data = content;
+	ASSERT_TRUE(GzipStream::compress_string(data, 1));
+	EXPECT_EQ(gzip_stream_test_inflate(data), content);
+	data.clear();
+	ASSERT_TRUE(GzipStream::compress_string(data, 1));
+	EXPECT_EQ(gzip_stream_test_inflate(data), "");
+};
+
+TEST(GzipStreamTest, QueueCompressedFileTest) {
+	std::string content = gzip_stream_test_content(30000);
+	int file_fd = open_temp_file("/tmp");
+	ASSERT_NE(file_fd, -1);
+	ASSERT_TRUE(write_all(file_fd, content.data(), content.size()));
+
+	int sockets[2];
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+	fcntl(sockets[0], F_SETFL, O_NONBLOCK);
+	int buffer_size = 4096;
+	setsockopt(sockets[0], SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+
+	struct sockaddr_in client_address;
+	bzero(&client_address, sizeof(client_address));
+	Listen listen;
+	Connection connection(client_address, listen);
+	connection.queue_output("header\r\n\r\n");
+	connection.queue_compressed_file(file_fd, 10, content.size(), 1);
+	connection.queue_output("next");
+
+	std::string received;
+	char buffer[8192];
+	while (connection.has_pending_output()) {
+		ASSERT_TRUE(connection.flush_output(sockets[0]));
+		ssize_t size = recv(sockets[1], buffer, sizeof(buffer), MSG_DONTWAIT);
+		if (size > 0) {
+			received.append(buffer, size);
+		}
+	}
+	ssize_t size;
+	while ((size = recv(sockets[1], buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+		received.append(buffer, size);
+	}
+	close(sockets[0]);
+	close(sockets[1]);
+
+	// Several chunked frames, then the last chunk and the next output
+	ASSERT_EQ(received.compare(0, 10, "header\r\n\r\n"), 0);
+	size_t pos = 10;
+	std::string compressed;
+	int frames = 0;
+	while (true) {
+		size_t line_end = received.find("\r\n", pos);
+		ASSERT_NE(line_end, std::string::npos);
+		size_t frame_size = std::strtoul(received.c_str() + pos, NULL, 16);
+		pos = line_end + 2;
+		if (frame_size == 0) {
+			break;
+		}
+		compressed += received.substr(pos, frame_size);
+		pos += frame_size + 2;
+		++frames;
+	}
+	EXPECT_GT(frames, 1);
+	EXPECT_EQ(received.substr(pos), "\r\nnext");
+	EXPECT_EQ(gzip_stream_test_inflate(compressed), content.substr(10));
+};
+
+}} /* namespace webserv::internal */
@@ -0,0 +1,82 @@
+#include "gtest/gtest.h"
+#include <string>
+#include <cstring>
+
+#include "HttpTables.hpp"
+#include "MimeTypes.hpp"
+
+namespace webserv { namespace internal {
+
+TEST(HttpTablesTest, LookupMethodTest) {
+	for (int method = GET; method < UNKNOWN; ++method) {
+		EXPECT_EQ(lookup_method(HTTPMethodStrings[method], std::strlen(HTTPMethodStrings[method])), method);
+	}
+
+	EXPECT_EQ(lookup_method("get", 3), UNKNOWN);
+	EXPECT_EQ(lookup_method("PATCH", 5), UNKNOWN);
+	EXPECT_EQ(lookup_method("GETS", 4), UNKNOWN);
+	EXPECT_EQ(lookup_method("", 0), UNKNOWN);
+};
+
+TEST(HttpTablesTest, LookupHeaderTest) {
+	for (int id = HEADER_HOST; id < HEADER_COUNT; ++id) {
+		std::string name = get_header_name(static_cast<HeaderId>(id));
+		EXPECT_EQ(lookup_header(name.data(), name.size()), id);
+
+		for (size_t i = 0; i < name.size(); ++i) {
+			name[i] = std::toupper(name[i]);
+		}
+		EXPECT_EQ(lookup_header(name.data(), name.size()), id);
+	}
+
+	EXPECT_EQ(lookup_header("Hose", 4), HEADER_UNKNOWN);
+	EXPECT_EQ(lookup_header("Accept-Language", 15), HEADER_UNKNOWN);
+	EXPECT_EQ(lookup_header("X-Custom", 8), HEADER_UNKNOWN);
+	EXPECT_EQ(lookup_header("", 0), HEADER_UNKNOWN);
+};
+
+TEST(HttpTablesTest, StatusLineTest) {
+	const StatusLine* not_found = find_status_line(404);
+	ASSERT_NE(not_found, (const StatusLine*)NULL);
+	EXPECT_EQ(std::string(not_found->line, not_found->size), "HTTP/1.1 404 Not Found\r\n");
+	EXPECT_STREQ(not_found->reason, "Not Found");
+
+	EXPECT_EQ(find_status_line(299), (const StatusLine*)NULL);
+	EXPECT_EQ(find_status_line(-1), (const StatusLine*)NULL);
+	EXPECT_EQ(find_status_line(600), (const StatusLine*)NULL);
+	EXPECT_EQ(get_status_message(200), "OK");
+	EXPECT_EQ(get_status_message(299), "Not Implemented");
+};
+
+TEST(HttpTablesTest, MimeTypesTest) {
+	const MimeTypes& default_types = MimeTypes::get_default();
+	ASSERT_NE(default_types.find_for_path("/a/index.HTML"), (const std::string*)NULL);
+	EXPECT_EQ(*default_types.find_for_path("/a/index.HTML"), "text/html");
+	EXPECT_EQ(*default_types.find_for_path("logo.avif"), "image/avif");
+	EXPECT_EQ(default_types.find_for_path("/dir.d/file"), (const std::string*)NULL);
+	EXPECT_EQ(default_types.find_for_path("/file."), (const std::string*)NULL);
+	EXPECT_EQ(default_types.find("unknown", 7), (const std::string*)NULL);
+
+	MimeTypes types;
+	EXPECT_TRUE(types.empty());
+	EXPECT_EQ(types.find("html", 4), (const std::string*)NULL);
+	EXPECT_FALSE(types.add("text/html", ""));
+	EXPECT_FALSE(types.add("text/html", ".html"));
+
+	for (int i = 0; i < 500; ++i) {
+		EXPECT_TRUE(types.add("type/" + to_string(i), "ext" + to_string(i)));
+	}
+	EXPECT_TRUE(types.add("type/last", "ext0"));
+	types.build();
+
+	EXPECT_EQ(types.get_entries().size(), 500);
+	EXPECT_EQ(*types.find("EXT0", 4), "type/last");
+	for (int i = 1; i < 500; ++i) {
+		std::string extension = "ext" + to_string(i);
+		ASSERT_NE(types.find(extension.data(), extension.size()), (const std::string*)NULL);
+		EXPECT_EQ(*types.find(extension.data(), extension.size()), "type/" + to_string(i));
+	}
+	EXPECT_EQ(types.find("ext500", 6), (const std::string*)NULL);
+};
+
+}} /* namespace webserv::internal */
@@ -0,0 +1,191 @@
+#include "gtest/gtest.h"
+#include <vector>
+#include <string>
+#include <map>
+#include <cstdlib>
+
+#include "Parser.hpp"
+#include "LocationRouter.hpp"
+
+namespace webserv { namespace internal {
+
+/**
+ * @brief Longest prefix by trying every length, as find_location used to
+ */
+static const LocationConfig* location_router_test_scan(const std::map<std::string, LocationConfig>& locations, std::string path) {
+	if (path.empty() || path[path.size() - 1] != '/') {
+		path += "/";
+	}
+	for (size_t length = path.size(); length > 0; --length) {
+		std::map<std::string, LocationConfig>::const_iterator it = locations.find(path.substr(0, length));
+		if (it != locations.end()) {
+			return &it->second;
+		}
+	}
+	return NULL;
+}
+
+TEST(LocationRouterTest, FindTest) {
+	Parser parser;
+	std::vector<ServerConfig> server_configs = parser.parse(
+		"server {\n\tlisten 8080;\n"
+		"\tlocation / {\n\t}\n"
+		"\tlocation /images/ {\n\t}\n"
+		"\tlocation /images/icons {\n\t}\n"
+		"\tlocation /im {\n\t}\n"
+		"\tlocation /api/v1/ {\n\t}\n"
+		"}\n");
+	const ServerConfig& server_config = server_configs.front();
+	const std::map<std::string, LocationConfig>& locations = server_config.get_locations();
+
+	EXPECT_EQ(server_config.find_location("/"), &locations.at("/"));
+	EXPECT_EQ(server_config.find_location(""), &locations.at("/"));
+	EXPECT_EQ(server_config.find_location("/index.html"), &locations.at("/"));
+	EXPECT_EQ(server_config.find_location("/images"), &locations.at("/images/"));
+	EXPECT_EQ(server_config.find_location("/images/logo.png"), &locations.at("/images/"));
+	EXPECT_EQ(server_config.find_location("/images/icons"), &locations.at("/images/icons"));
+	EXPECT_EQ(server_config.find_location("/images/icons/a.png"), &locations.at("/images/icons"));
+	EXPECT_EQ(server_config.find_location("/images/ic"), &locations.at("/images/"));
+	EXPECT_EQ(server_config.find_location("/img/a.png"), &locations.at("/im"));
+	EXPECT_EQ(server_config.find_location("/api/v1"), &locations.at("/api/v1/"));
+	EXPECT_EQ(server_config.find_location("/api/v2"), &locations.at("/"));
+
+	ServerConfig copy(server_config);
+	EXPECT_EQ(copy.find_location("/images/logo.png"), &copy.get_locations().at("/images/"));
+}
+
+TEST(LocationRouterTest, NoRootTest) {
+	LocationRouter router;
+	router.add_prefix("/a/", 0, false);
+	router.add_prefix("/a/b/c/", 1, false);
+	router.compile();
+
+	EXPECT_EQ(router.find("/", 1), -1);
+	EXPECT_EQ(router.find("/b", 2), -1);
+	EXPECT_EQ(router.find("/a", 2), 0);
+	EXPECT_EQ(router.find("/a/b/c", 6), 1);
+	EXPECT_EQ(router.find("/a/b/cd", 7), 0);
+}
+
+TEST(LocationRouterTest, MatchesScanTest) {
+	const char* const segments[] = { "a", "b", "ab", "img", "images", "api", "v1", "x.html" };
+	const size_t segment_count = sizeof(segments) / sizeof(segments[0]);
+	std::srand(42);
+
+	std::map<std::string, LocationConfig> locations;
+	for (int i = 0; i < 300; ++i) {
+		std::string prefix;
+		for (int depth = std::rand() % 4; depth >= 0; --depth) {
+			prefix += "/" + std::string(segments[std::rand() % segment_count]);
+		}
+		if (std::rand() % 2) {
+			prefix += "/";
+		}
+		locations[prefix] = LocationConfig();
+	}
+
+	LocationRouter router;
+	std::vector<const LocationConfig*> routes;
+	std::map<std::string, LocationConfig>::const_iterator it = locations.begin();
+	for (; it != locations.end(); ++it) {
+		router.add_prefix(it->first, routes.size(), false);
+		routes.push_back(&it->second);
+	}
+	router.compile();
+
+	for (int i = 0; i < 3000; ++i) {
+		std::string path;
+		for (int depth = std::rand() % 6; depth >= 0; --depth) {
+			path += "/" + std::string(segments[std::rand() % segment_count]).substr(0, 1 + std::rand() % 6);
+		}
+		if (std::rand() % 3 == 0) {
+			path += "/";
+		}
+		int id = router.find(path.data(), path.size());
+		EXPECT_EQ(id == -1 ? NULL : routes[id], location_router_test_scan(locations, path)) << path;
+	}
+}
+
+TEST(LocationRouterTest, PrecedenceTest) {
+	Parser parser;
+	std::vector<ServerConfig> server_configs = parser.parse(
+		"server {\n\tlisten 8080;\n"
+		"\tlocation / {\n\t}\n"
+		"\tlocation = /exact {\n\t}\n"
+		"\tlocation /exact {\n\t}\n"
+		"\tlocation ^~ /static/ {\n\t}\n"
+		"\tlocation /images/ {\n\t}\n"
+		"\tlocation ~ \\.(png|jpe?g)$ {\n\t}\n"
+		"\tlocation ~* \\.PHP$ {\n\t}\n"
+		"\tlocation ~ \"^/api/v[0-9]{1,2}/\" {\n\t}\n"
+		"\tlocation ~ /images/.*\\.png$ {\n\t}\n"
+		"\tlocation *.txt {\n\t}\n"
+		"}\n");
+	const ServerConfig& server_config = server_configs.front();
+	const std::map<std::string, LocationConfig>& locations = server_config.get_locations();
+	ASSERT_EQ(locations.size(), 10);
+	EXPECT_EQ(locations.at("~ \\.(png|jpe?g)$").get_match(), LOCATION_REGEX);
+	EXPECT_EQ(locations.at("~ ^/api/v[0-9]{1,2}/").get_match(), LOCATION_REGEX);
+	EXPECT_EQ(locations.at("/static/").get_match(), LOCATION_PREFIX_NO_PATTERNS);
+
+	// Exact wins, then a ^~ prefix, then the first regex, then the longest prefix
+	EXPECT_EQ(server_config.find_location("/exact"), &locations.at("= /exact"));
+	EXPECT_EQ(server_config.find_location("/exact/a"), &locations.at("/exact"));
+	EXPECT_EQ(server_config.find_location("/static/a.png"), &locations.at("/static/"));
+	EXPECT_EQ(server_config.find_location("/images/a.png"), &locations.at("~ \\.(png|jpe?g)$"));
+	EXPECT_EQ(server_config.find_location("/images/a.gif"), &locations.at("/images/"));
+	EXPECT_EQ(server_config.find_location("/a.jpeg"), &locations.at("~ \\.(png|jpe?g)$"));
+	EXPECT_EQ(server_config.find_location("/a.png.bak"), &locations.at("/"));
+	EXPECT_EQ(server_config.find_location("/index.Php"), &locations.at("~* \\.PHP$"));
+	EXPECT_EQ(server_config.find_location("/api/v12/users"), &locations.at("~ ^/api/v[0-9]{1,2}/"));
+	EXPECT_EQ(server_config.find_location("/api/v123/users"), &locations.at("/"));
+	EXPECT_EQ(server_config.find_location("/x/api/v1/"), &locations.at("/"));
+	EXPECT_EQ(server_config.find_location("/docs/a.txt"), &locations.at("*.txt"));
+	EXPECT_EQ(server_config.find_location("/docs/a.txt/b"), &locations.at("/"));
+
+	ServerConfig copy(server_config);
+	EXPECT_EQ(copy.find_location("/index.php"), &copy.get_locations().at("~* \\.PHP$"));
+}
+
+TEST(LocationRouterTest, InvalidPatternTest) {
+	const char* const invalid[] = { "(a", "a)", "[a", "*a", "a**", "a{2,1}", "a{256}", "\\1", "(?=a)", "[[:alpha:]]", "[z-a]" };
+
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+		Parser parser;
+		std::string config = std::string("server {\n\tlisten 8080;\n\tlocation ~ \"") + invalid[i] + "\" {\n\t}\n}\n";
+		EXPECT_THROW(parser.parse(config), ParserException) << invalid[i];
+	}
+}
+
+TEST(LocationPatternsTest, MatchTest) {
+	LocationPatterns patterns;
+	patterns.add("^/a(b|c)*d$", PATTERN_REGEX);
+	patterns.add("x[^/]+y", PATTERN_REGEX);
+	patterns.add("\\d{3}", PATTERN_REGEX);
+	patterns.add("/*/?.html", PATTERN_GLOB);
+	patterns.add("caf[e-f]", PATTERN_REGEX_CASELESS);
+	patterns.compile();
+
+	EXPECT_EQ(patterns.match("/abcbd", 6), 0);
+	EXPECT_EQ(patterns.match("/ad", 3), 0);
+	EXPECT_EQ(patterns.match("/abd/", 5), -1);
+	EXPECT_EQ(patterns.match("/xay", 4), 1);
+	EXPECT_EQ(patterns.match("/x/y", 4), -1);
+	EXPECT_EQ(patterns.match("/a12b", 5), -1);
+	EXPECT_EQ(patterns.match("/a123b", 6), 2);
+	EXPECT_EQ(patterns.match("/dir/a.html", 11), 3);
+	EXPECT_EQ(patterns.match("/dir/ab.html", 12), -1);
+	EXPECT_EQ(patterns.match("/CAFE", 5), 4);
+	EXPECT_EQ(patterns.match("/xay/123/CAFE", 13), 1);
+
+	// Patterns that make a backtracking matcher exponential stay linear
+	LocationPatterns nested;
+	nested.add("^(a|aa)*(a|aa)*(a|aa)*b$", PATTERN_REGEX);
+	nested.compile();
+	std::string path(10000, 'a');
+	EXPECT_EQ(nested.match(path.data(), path.size()), -1);
+	path += "b";
+	EXPECT_EQ(nested.match(path.data(), path.size()), 0);
+}
+
+}} /* namespace webserv::internal */
@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <unistd.h>
+
+#include "MultipartParser.hpp"
+
+namespace webserv { namespace internal {
+
+static std::string multipart_test_directory() {
+	char directory[] = "/tmp/webserv_multipart_XXXXXX";
+	return std::string(mkdtemp(directory)) + "/";
+}
+
+static std::string multipart_test_read(const std::string& path) {
+	std::ifstream file(path.c_str(), std::ios::binary);
+	std::stringstream content;
+	content << file.rdbuf();
+	return content.str();
+}
+
+static std::string multipart_test_body(const std::string& first, const std::string& second) {
+	return "preamble\r\n"
+		"--XyZ\r\n"
+		"Content-Disposition: form-data; name=\"field\"\r\n"
+		"\r\n"
+		"value\r\n"
+		"--XyZ  \r\n"
+		"content-disposition: form-data; name=\"a\"; filename=\"a.txt\"\r\n"
+		"Content-Type: text/plain\r\n"
+		"\r\n" + first + "\r\n"
+		"--XyZ\r\n"
+		"Content-Disposition: form-data; name=\"b\"; filename=\"b.bin\"\r\n"
+		"\r\n" + second + "\r\n"
+		"--XyZ--\r\n"
+		"epilogue";
+}
+
+TEST(MultipartTest, SplitFeedTest) {
+	std::string directory = multipart_test_directory();
+	std::string first = "hello\r\n--Xy-not-a-delimiter\r\n-";
+	std::string second = std::string("\0\r\n--Xy\r\n-XyZ\r", 15) + std::string(5000, 'b');
+	std::string body = multipart_test_body(first, second);
+
+	for (size_t split = 1; split < 40; ++split) {
+		MultipartParser parser;
+		ASSERT_TRUE(parser.start("XyZ", directory));
+		for (size_t pos = 0; pos < body.size(); pos += split) {
+			ASSERT_TRUE(parser.feed(body.data() + pos, std::min(split, body.size() - pos)));
+		}
+		ASSERT_TRUE(parser.finish());
+		ASSERT_EQ(parser.get_file_names().size(), 2);
+		EXPECT_EQ(parser.get_file_names()[0], "a.txt");
+		EXPECT_EQ(parser.get_file_names()[1], "b.bin");
+		EXPECT_EQ(multipart_test_read(directory + "a.txt"), first);
+		EXPECT_EQ(multipart_test_read(directory + "b.bin"), second);
+	}
+
+	unlink((directory + "a.txt").c_str());
+	unlink((directory + "b.bin").c_str());
+	rmdir(directory.c_str());
+};
+
+TEST(MultipartTest, InvalidBodyTest) {
+	std::string directory = multipart_test_directory();
+
+	MultipartParser truncated;
+	ASSERT_TRUE(truncated.start("XyZ", directory));
+	std::string body = multipart_test_body("abc", "def");
+	body = body.substr(0, body.find("def") + 2);
+	EXPECT_TRUE(truncated.feed(body.data(), body.size()));
+	EXPECT_FALSE(truncated.finish());
+	EXPECT_EQ(truncated.get_status_code(), 400);
+	EXPECT_EQ(multipart_test_read(directory + "a.txt"), "abc");
+	EXPECT_NE(access((directory + "b.bin").c_str(), F_OK), 0);
+	unlink((directory + "a.txt").c_str());
+
+	MultipartParser no_disposition;
+	ASSERT_TRUE(no_disposition.start("XyZ", directory));
+	body = "--XyZ\r\nContent-Type: text/plain\r\n\r\nabc\r\n--XyZ--\r\n";
+	EXPECT_FALSE(no_disposition.feed(body.data(), body.size()));
+	EXPECT_EQ(no_disposition.get_status_code(), 400);
+
+	MultipartParser traversal;
+	ASSERT_TRUE(traversal.start("XyZ", directory));
+	body = "--XyZ\r\nContent-Disposition: form-data; name=\"a\"; filename=\"../a\"\r\n\r\nabc\r\n--XyZ--\r\n";
+	EXPECT_FALSE(traversal.feed(body.data(), body.size()));
+	EXPECT_EQ(traversal.get_status_code(), 400);
+
+	MultipartParser long_header;
+	ASSERT_TRUE(long_header.start("XyZ", directory));
+	body = "--XyZ\r\nX: " + std::string(MULTIPART_HEADER_LIMIT, 'x');
+	EXPECT_FALSE(long_header.feed(body.data(), body.size()));
+
+	MultipartParser parser;
+	EXPECT_FALSE(parser.start("", directory));
+	EXPECT_FALSE(parser.start(std::string(MULTIPART_BOUNDARY_LIMIT + 1, 'b'), directory));
+	EXPECT_FALSE(parser.is_started());
+
+	rmdir(directory.c_str());
+};
+
+}} /* namespace webserv::internal */
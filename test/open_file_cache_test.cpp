@@ -0,0 +1,130 @@
+#include "gtest/gtest.h"
+#include <string>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "OpenFileCache.hpp"
+#include "utils.hpp"
+
+namespace webserv { namespace internal {
+
+static void open_file_cache_test_write(const std::string& path, const std::string& content) {
+	int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	ASSERT_NE(fd, -1);
+	ASSERT_TRUE(write_all(fd, content.data(), content.size()));
+	close(fd);
+}
+
+TEST(OpenFileCacheTest, HitTest) {
+	char directory_template[] = "/tmp/open_file_cache_XXXXXX";
+	ASSERT_NE(mkdtemp(directory_template), static_cast<char*>(NULL));
+	std::string directory(directory_template);
+	open_file_cache_test_write(directory + "/a.html", "hello");
+
+	OpenFileCache cache(16, 60000, true);
+	cache.set_now(1000);
+	OpenFileInfo info;
+	ASSERT_TRUE(cache.open(directory + "/a.html", info));
+	EXPECT_TRUE(info.is_file());
+	EXPECT_EQ(info.size, 5);
+	ASSERT_NE(info.fd, -1);
+	close(info.fd);
+
+	ASSERT_TRUE(cache.open(directory, info));
+	EXPECT_TRUE(info.is_directory());
+	EXPECT_EQ(info.fd, -1);
+
+	EXPECT_FALSE(cache.open(directory + "/missing", info));
+	EXPECT_EQ(info.error, ENOENT);
+	EXPECT_EQ(cache.get_size(), 3);
+
+	// Within one wake up a hit touches no syscall but a dup, the cached fd still reads the old file
+	unlink((directory + "/a.html").c_str());
+	ASSERT_TRUE(cache.open(directory + "/a.html", info));
+	char buffer[8];
+	EXPECT_EQ(pread(info.fd, buffer, sizeof(buffer), 0), 5);
+	close(info.fd);
+
+	cache.clear();
+	EXPECT_EQ(cache.get_size(), 0);
+	EXPECT_FALSE(cache.open(directory + "/a.html", info));
+	rmdir(directory.c_str());
+}
+
+TEST(OpenFileCacheTest, InvalidateTest) {
+	char directory_template[] = "/tmp/open_file_cache_XXXXXX";
+	ASSERT_NE(mkdtemp(directory_template), static_cast<char*>(NULL));
+	std::string directory(directory_template);
+	std::string path = directory + "/a.txt";
+
+	// Changes are seen from inotify events, or without them from a stat once valid_ms passed
+#ifdef __linux__
+	for (int valid_ms = 0; valid_ms <= 60000; valid_ms += 60000) {
+#else
+	for (int valid_ms = 0; valid_ms == 0; ++valid_ms) {
+#endif
+		OpenFileCache cache(16, valid_ms, true);
+		unsigned long now_ms = 1000;
+		cache.set_now(now_ms);
+		OpenFileInfo info;
+		EXPECT_FALSE(cache.open(path, info));
+
+		open_file_cache_test_write(path, "abc");
+		cache.set_now(++now_ms);
+		ASSERT_TRUE(cache.open(path, info)) << valid_ms;
+		EXPECT_EQ(info.size, 3);
+		close(info.fd);
+
+		open_file_cache_test_write(path, "abcdef");
+		cache.set_now(++now_ms);
+		ASSERT_TRUE(cache.open(path, info)) << valid_ms;
+		EXPECT_EQ(info.size, 6);
+		close(info.fd);
+
+		unlink(path.c_str());
+		cache.invalidate(path);
+		EXPECT_FALSE(cache.open(path, info));
+	}
+	rmdir(directory.c_str());
+}
+
+TEST(OpenFileCacheTest, EvictTest) {
+	char directory_template[] = "/tmp/open_file_cache_XXXXXX";
+	ASSERT_NE(mkdtemp(directory_template), static_cast<char*>(NULL));
+	std::string directory(directory_template);
+	for (int i = 0; i < 4; ++i) {
+		open_file_cache_test_write(directory + "/" + to_string(i), std::string(i, 'x'));
+	}
+
+	OpenFileCache cache(2, 60000, false);
+	cache.set_now(1000);
+	OpenFileInfo info;
+	for (int round = 0; round < 3; ++round) {
+		for (int i = 0; i < 4; ++i) {
+			ASSERT_TRUE(cache.open(directory + "/" + to_string(i), info));
+			EXPECT_EQ(info.size, i);
+			close(info.fd);
+		}
+		EXPECT_EQ(cache.get_size(), 2);
+	}
+
+	// Misses aren't cached with errors off
+	EXPECT_FALSE(cache.open(directory + "/missing", info));
+	EXPECT_EQ(cache.get_size(), 2);
+
+	OpenFileCache off(0, 60000, true);
+	ASSERT_TRUE(off.open(directory + "/3", info));
+	EXPECT_EQ(info.size, 3);
+	close(info.fd);
+	EXPECT_EQ(off.get_size(), 0);
+
+	for (int i = 0; i < 4; ++i) {
+		unlink((directory + "/" + to_string(i)).c_str());
+	}
+	rmdir(directory.c_str());
+}
+
+}} /* namespace webserv::internal */
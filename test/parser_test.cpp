@@ -29,6 +29,12 @@ TEST(ParserTest, FullServerParseTest) {
 	ASSERT_EQ(server_config.get_allow_methods().size(), 1);
 	EXPECT_EQ(*server_config.get_allow_methods().begin(), "GET");
 
+	EXPECT_EQ(server_config.get_keepalive_timeout(), 30);
+	EXPECT_EQ(server_config.get_keepalive_requests(), 500);
+	EXPECT_EQ(server_config.get_client_header_timeout(), 10);
+	EXPECT_EQ(server_config.get_client_body_timeout(), 20);
+	EXPECT_EQ(server_config.get_send_timeout(), 0);
+
 	// Check location data
 	ASSERT_EQ(server_config.get_locations().size(), 1);
 	const LocationConfig location_config = server_config.get_locations().begin()->second;
@@ -42,6 +48,18 @@ TEST(ParserTest, FullServerParseTest) {
 	EXPECT_EQ(*(++location_config.get_allow_methods().begin()), "PUT");
 
 	EXPECT_EQ(location_config.get_cgi_path(), "script.js");
+	EXPECT_FALSE(location_config.get_etag());
+	EXPECT_TRUE(location_config.get_gzip_static());
+	EXPECT_FALSE(location_config.get_brotli_static());
+	EXPECT_TRUE(location_config.get_gzip());
+	EXPECT_EQ(location_config.get_gzip_types().size(), 3);
+	EXPECT_EQ(location_config.get_gzip_types().count("text/html"), 1);
+	EXPECT_EQ(location_config.get_gzip_types().count("application/javascript"), 1);
+	EXPECT_EQ(location_config.get_gzip_min_length(), 20);
+	EXPECT_EQ(location_config.get_gzip_comp_level(), 6);
+
+	Parser fail_parser;
+	EXPECT_ANY_THROW(fail_parser.parse("server {\n\tlocation / {\n\t\tgzip_comp_level 10;\n\t}\n}\n"));
 };
 
 TEST(ParserTest, DefaultServerParseTest) {
@@ -60,6 +78,12 @@ TEST(ParserTest, DefaultServerParseTest) {
 	EXPECT_EQ(server_config.get_listens().begin()->address, "");
 	EXPECT_EQ(server_config.get_listens().begin()->port, 80);
 
+	EXPECT_EQ(server_config.get_keepalive_timeout(), 75);
+	EXPECT_EQ(server_config.get_keepalive_requests(), 100);
+	EXPECT_EQ(server_config.get_client_header_timeout(), 60);
+	EXPECT_EQ(server_config.get_client_body_timeout(), 60);
+	EXPECT_EQ(server_config.get_send_timeout(), 60);
+
 	EXPECT_EQ(server_config.get_root(), "html");
 	EXPECT_EQ(server_config.get_index(), "index.html");
 
@@ -92,6 +116,63 @@ TEST(ParserTest, DefaultServerParseTest) {
 	EXPECT_TRUE(location_config.get_allow_methods().find("TRACE") != location_config.get_allow_methods().end());
 
 	EXPECT_EQ(location_config.get_cgi_path(), "");
+	EXPECT_TRUE(location_config.get_etag());
+};
+
+TEST(ParserTest, GlobalConfigParseTest) {
+	Parser parser;
+	std::vector<ServerConfig> server_configs;
+
+	ASSERT_NO_THROW(server_configs = parser.parse(file_to_string("test/config/parser_test_4.conf")));
+	ASSERT_EQ(server_configs.size(), 1);
+	EXPECT_EQ(parser.get_global_config().get_worker_threads(), 4);
+	EXPECT_EQ(parser.get_global_config().get_open_file_cache(), 1000);
+	EXPECT_EQ(parser.get_global_config().get_open_file_cache_valid(), 60);
+	EXPECT_FALSE(parser.get_global_config().get_open_file_cache_errors());
+	EXPECT_EQ(parser.get_global_config().get_response_cache(), 256 * 1024);
+	EXPECT_EQ(parser.get_global_config().get_response_cache_max_file(), 64 * 1024);
+
+	Parser default_parser;
+	ASSERT_NO_THROW(server_configs = default_parser.parse(file_to_string("test/config/parser_test_2.conf")));
+	EXPECT_EQ(default_parser.get_global_config().get_worker_threads(), 1);
+	EXPECT_EQ(default_parser.get_global_config().get_worker_processes(), 1);
+	EXPECT_EQ(default_parser.get_global_config().get_open_file_cache(), 256);
+	EXPECT_TRUE(default_parser.get_global_config().get_open_file_cache_errors());
+	EXPECT_EQ(default_parser.get_global_config().get_response_cache(), 1024 * 1024);
+
+	Parser fail_parser;
+	EXPECT_ANY_THROW(fail_parser.parse("worker_threads 0;\nserver {\n\tlocation / {\n\t}\n}\n"));
+	EXPECT_ANY_THROW(fail_parser.parse("open_file_cache -1;\nserver {\n\tlocation / {\n\t}\n}\n"));
+
+	Parser conflict_parser;
+	EXPECT_ANY_THROW(conflict_parser.parse("worker_threads 2;\nworker_processes 2;\nserver {\n\tlocation / {\n\t}\n}\n"));
+};
+
+TEST(ParserTest, TypesParseTest) {
+	Parser parser;
+	std::vector<ServerConfig> server_configs;
+
+	ASSERT_NO_THROW(server_configs = parser.parse(
+		"types {\n\ttext/html html htm;\n}\n"
+		"server {\n\tlisten 80;\n\tlocation / {\n\t\ttypes {\n\t\t\tapplication/octet-stream html;\n\t\t}\n\t}\n}\n"
+		"server {\n\tlisten 81;\n\ttypes {\n\t\timage/png PNG;\n\t}\n\tlocation / {\n\t}\n}\n"));
+	ASSERT_EQ(server_configs.size(), 2);
+
+	const MimeTypes& inherited = server_configs.at(0).get_types();
+	ASSERT_NE(inherited.find("htm", 3), (const std::string*)NULL);
+	EXPECT_EQ(*inherited.find("htm", 3), "text/html");
+	EXPECT_EQ(*server_configs.at(0).get_locations().at("/").get_types().find("html", 4), "application/octet-stream");
+
+	const MimeTypes& own = server_configs.at(1).get_types();
+	ASSERT_NE(own.find("png", 3), (const std::string*)NULL);
+	EXPECT_EQ(own.find("html", 4), (const std::string*)NULL);
+	EXPECT_TRUE(server_configs.at(1).get_locations().at("/").get_types().empty());
+
+	Parser no_extension_parser;
+	EXPECT_ANY_THROW(no_extension_parser.parse("server {\n\ttypes {\n\t\ttext/html;\n\t}\n\tlocation / {\n\t}\n}\n"));
+
+	Parser twice_parser;
+	EXPECT_ANY_THROW(twice_parser.parse("server {\n\ttypes {\n\t\ttext/html html;\n\t}\n\ttypes {\n\t\ttext/css css;\n\t}\n\tlocation / {\n\t}\n}\n"));
 };
 
 TEST(ParserTest, FailParseTest) {
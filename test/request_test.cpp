@@ -0,0 +1,267 @@
+#include "gtest/gtest.h"
+#include <vector>
+#include <string>
+#include <cstring>
+
+#include "Parser.hpp"
+#include "Request.hpp"
+#include "VirtualHosts.hpp"
+
+namespace webserv { namespace internal {
+
+static std::vector<ServerConfig> request_test_configs() {
+	Parser parser;
+	return parser.parse("server {\n\tlisten 127.0.0.1:8080;\n\tlarge_client_header_buffers 2 64;\n\tlocation / {\n\t}\n}\n");
+}
+
+static const HostIndex& request_test_hosts(VirtualHosts& virtual_hosts, const std::vector<ServerConfig>& server_configs) {
+	virtual_hosts.build(server_configs);
+	return *virtual_hosts.find(*server_configs.front().get_listens().begin());
+}
+
+static Request request_test_request(const std::vector<ServerConfig>& server_configs) {
+	struct sockaddr_in client_address;
+	bzero(&client_address, sizeof(client_address));
+	return Request(client_address, *server_configs.front().get_listens().begin());
+}
+
+TEST(RequestTest, FeedAcrossReadsTest) {
+	std::vector<ServerConfig> server_configs = request_test_configs();
+	VirtualHosts virtual_hosts;
+	const HostIndex &hosts = request_test_hosts(virtual_hosts, server_configs);
+	Request req = request_test_request(server_configs);
+	std::string raw = "GET /index.html?a=b HTTP/1.1\r\nhost: example\r\nX-Custom-HEADER:  v1 \r\nContent-Length: 4\r\n\r\n";
+	raw += std::string("ab\0d", 4);
+
+	for (size_t i = 0; i < 80; ++i) {
+		EXPECT_EQ(req.feed(raw.data() + i, 1, hosts), 1);
+		EXPECT_FALSE(req.is_complete());
+	}
+	EXPECT_EQ(req.feed(raw.data() + 80, raw.size() - 80, hosts), raw.size() - 80);
+
+	ASSERT_TRUE(req.is_complete());
+	EXPECT_EQ(req.get_status_code(), 0);
+	EXPECT_EQ(req.get_method(), GET);
+	EXPECT_EQ(req.get_path(), "/index.html");
+	EXPECT_EQ(req.get_query(), "a=b");
+	EXPECT_EQ(req.get_headers().at("Host"), "example");
+	EXPECT_EQ(req.get_headers().at("X-Custom-Header"), "v1");
+	EXPECT_EQ(req.get_body(), std::string("ab\0d", 4));
+	EXPECT_TRUE(req.is_keep_alive());
+};
+
+TEST(RequestTest, PipelinedTest) {
+	std::vector<ServerConfig> server_configs = request_test_configs();
+	VirtualHosts virtual_hosts;
+	const HostIndex &hosts = request_test_hosts(virtual_hosts, server_configs);
+	Request req = request_test_request(server_configs);
+	std::string first = "GET / HTTP/1.1\r\nHost: a\r\n\r\n";
+	std::string raw = first + "GET /second HTTP/1.1\r\nHost: a\r\n\r\n";
+
+	EXPECT_EQ(req.feed(raw.data(), raw.size(), hosts), first.size());
+	ASSERT_TRUE(req.is_complete());
+	EXPECT_EQ(req.get_path(), "/");
+};
+
+TEST(RequestTest, HeaderLimitTest) {
+	std::vector<ServerConfig> server_configs = request_test_configs();
+	VirtualHosts virtual_hosts;
+	const HostIndex &hosts = request_test_hosts(virtual_hosts, server_configs);
+
+	Request long_uri = request_test_request(server_configs);
+	std::string raw = "GET /" + std::string(100, 'a') + " HTTP/1.1\r\n";
+	long_uri.feed(raw.data(), raw.size(), hosts);
+	ASSERT_TRUE(long_uri.is_complete());
+	EXPECT_EQ(long_uri.get_status_code(), 414);
+	EXPECT_FALSE(long_uri.is_keep_alive());
+
+	Request long_field = request_test_request(server_configs);
+	raw = "GET / HTTP/1.1\r\nCookie: " + std::string(60, 'c') + "\r\n";
+	long_field.feed(raw.data(), raw.size(), hosts);
+	EXPECT_EQ(long_field.get_status_code(), 400);
+
+	Request too_many = request_test_request(server_configs);
+	raw = "GET / HTTP/1.1\r\nA: " + std::string(40, 'a') + "\r\nB: " + std::string(40, 'b') + "\r\nC: " + std::string(40, 'c') + "\r\n";
+	too_many.feed(raw.data(), raw.size(), hosts);
+	EXPECT_EQ(too_many.get_status_code(), 400);
+};
+
+TEST(RequestTest, InvalidHeaderTest) {
+	std::vector<ServerConfig> server_configs = request_test_configs();
+	VirtualHosts virtual_hosts;
+	const HostIndex &hosts = request_test_hosts(virtual_hosts, server_configs);
+
+	Request no_colon = request_test_request(server_configs);
+	std::string raw = "GET / HTTP/1.1\r\nHost a\r\n\r\n";
+	no_colon.feed(raw.data(), raw.size(), hosts);
+	EXPECT_EQ(no_colon.get_status_code(), 400);
+
+	Request duplicate_host = request_test_request(server_configs);
+	raw = "GET / HTTP/1.1\r\nHost: a\r\nhost: b\r\n\r\n";
+	duplicate_host.feed(raw.data(), raw.size(), hosts);
+	EXPECT_EQ(duplicate_host.get_status_code(), 400);
+
+	Request space_in_name = request_test_request(server_configs);
+	raw = "GET / HTTP/1.1\r\nHost : a\r\n\r\n";
+	space_in_name.feed(raw.data(), raw.size(), hosts);
+	EXPECT_EQ(space_in_name.get_status_code(), 400);
+
+	Request control_byte = request_test_request(server_configs);
+	raw = std::string("GET / HTTP/1.1\r\nHost: a\0b\r\n\r\n", 28);
+	control_byte.feed(raw.data(), raw.size(), hosts);
+	EXPECT_EQ(control_byte.get_status_code(), 400);
+};
+
+TEST(RequestTest, HeaderViewTest) {
+	std::vector<ServerConfig> server_configs = request_test_configs();
+	VirtualHosts virtual_hosts;
+	const HostIndex &hosts = request_test_hosts(virtual_hosts, server_configs);
+	Request req = request_test_request(server_configs);
+	std::string raw = "GET /a/b HTTP/1.1\r\nHost: a:8080\r\nAccept: x\r\nACCEPT: y\r\nConnection: Close\r\n\r\n";
+
+	req.feed(raw.data(), raw.size(), hosts);
+	ASSERT_TRUE(req.is_complete());
+	EXPECT_EQ(req.get_status_code(), 0);
+	EXPECT_EQ(req.get_path(), "/a/b");
+	EXPECT_EQ(req.get_query(), "");
+	EXPECT_TRUE(req.has_header("accept"));
+	EXPECT_FALSE(req.has_header("Cookie"));
+	EXPECT_EQ(req.get_header("Accept"), "x, y");
+	EXPECT_EQ(req.get_header("Cookie"), "");
+	EXPECT_EQ(req.get_headers().at("Accept"), "x, y");
+	EXPECT_EQ(req.get_headers().size(), 3);
+	EXPECT_FALSE(req.is_keep_alive());
+
+	Request no_path = request_test_request(server_configs);
+	raw = "GET\r\n";
+	no_path.feed(raw.data(), raw.size(), hosts);
+	EXPECT_EQ(no_path.get_status_code(), 400);
+};
+
+TEST(RequestTest, ChunkedBodyTest) {
+	std::vector<ServerConfig> server_configs = request_test_configs();
+	VirtualHosts virtual_hosts;
+	const HostIndex &hosts = request_test_hosts(virtual_hosts, server_configs);
+	Request req = request_test_request(server_configs);
+	std::string raw = "POST /upload HTTP/1.1\r\nHost: a\r\nTransfer-Encoding: Chunked\r\n\r\n"
+		"4;name=value\r\nWiki\r\nA \r\npedia in\r\n\r\n0\r\nX-Trailer: t\r\n\r\n";
+	std::string next = "GET / HTTP/1.1\r\nHost: a\r\n\r\n";
+
+	for (size_t i = 0; i + 1 < raw.size(); ++i) {
+		EXPECT_EQ(req.feed(raw.data() + i, 1, hosts), 1);
+		EXPECT_FALSE(req.is_complete());
+	}
+	std::string last = raw.substr(raw.size() - 1) + next;
+	EXPECT_EQ(req.feed(last.data(), last.size(), hosts), 1);
+
+	ASSERT_TRUE(req.is_complete());
+	EXPECT_EQ(req.get_status_code(), 0);
+	EXPECT_TRUE(req.is_chunked());
+	EXPECT_EQ(req.get_body(), "Wikipedia in\r\n");
+	EXPECT_EQ(req.get_body_size(), 14);
+	EXPECT_TRUE(req.is_keep_alive());
+};
+
+TEST(RequestTest, InvalidChunkedBodyTest) {
+	std::vector<ServerConfig> server_configs = request_test_configs();
+	VirtualHosts virtual_hosts;
+	const HostIndex &hosts = request_test_hosts(virtual_hosts, server_configs);
+	std::string header = "POST / HTTP/1.1\r\nHost: a\r\nTransfer-Encoding: chunked\r\n\r\n";
+	std::string trailer_line = "X-Trailer: " + std::string(40, 't') + "\r\n";
+	const std::string invalid[] = { "x\r\n", "\r\n", "2\r\nabc\r\n", "fffffffffffffffffffffff\r\n",
+		"1;" + std::string(100, 'x'), "0\r\n" + trailer_line + trailer_line + trailer_line };
+	const int status_codes[] = { 400, 400, 400, 413, 400, 400 };
+
+	for (size_t i = 0; i < 6; ++i) {
+		Request req = request_test_request(server_configs);
+		std::string raw = header + invalid[i];
+		req.feed(raw.data(), raw.size(), hosts);
+		ASSERT_TRUE(req.is_complete());
+		EXPECT_EQ(req.get_status_code(), status_codes[i]);
+		EXPECT_FALSE(req.is_keep_alive());
+	}
+
+	Request both = request_test_request(server_configs);
+	std::string raw = "POST / HTTP/1.1\r\nHost: a\r\nContent-Length: 3\r\nTransfer-Encoding: chunked\r\n\r\n";
+	both.feed(raw.data(), raw.size(), hosts);
+	EXPECT_EQ(both.get_status_code(), 400);
+
+	Request unknown = request_test_request(server_configs);
+	raw = "POST / HTTP/1.1\r\nHost: a\r\nTransfer-Encoding: gzip, chunked\r\n\r\n";
+	unknown.feed(raw.data(), raw.size(), hosts);
+	EXPECT_EQ(unknown.get_status_code(), 501);
+};
+
+TEST(RequestTest, InvalidContentLengthTest) {
+	std::vector<ServerConfig> server_configs = request_test_configs();
+	VirtualHosts virtual_hosts;
+	const HostIndex &hosts = request_test_hosts(virtual_hosts, server_configs);
+	const char *invalid[] = { "abc", "5abc", "-1", "", "+5", "99999999999999999999999" };
+
+	for (size_t i = 0; i < 6; ++i) {
+		Request req = request_test_request(server_configs);
+		std::string raw = std::string("POST / HTTP/1.1\r\nHost: a\r\nContent-Length: ") + invalid[i] + "\r\n\r\nabcde";
+		EXPECT_LT(req.feed(raw.data(), raw.size(), hosts), raw.size());
+		ASSERT_TRUE(req.is_complete());
+		EXPECT_EQ(req.get_status_code(), 400);
+		EXPECT_FALSE(req.is_keep_alive());
+	}
+};
+
+TEST(RequestTest, ChunkedBodySizeTest) {
+	Parser parser;
+	std::vector<ServerConfig> server_configs = parser.parse("server {\n\tlisten 127.0.0.1:8080;\n\tclient_max_body_size 8;\n\tlocation / {\n\t}\n}\n");
+	VirtualHosts virtual_hosts;
+	const HostIndex &hosts = request_test_hosts(virtual_hosts, server_configs);
+	std::string header = "POST / HTTP/1.1\r\nHost: a\r\nTransfer-Encoding: chunked\r\n\r\n";
+
+	Request fits = request_test_request(server_configs);
+	std::string raw = header + "4\r\nabcd\r\n4\r\nefgh\r\n0\r\n\r\n";
+	EXPECT_EQ(fits.feed(raw.data(), raw.size(), hosts), raw.size());
+	EXPECT_EQ(fits.get_status_code(), 0);
+	EXPECT_EQ(fits.get_body(), "abcdefgh");
+
+	Request too_large = request_test_request(server_configs);
+	raw = header + "4\r\nabcd\r\n5\r\nefghi\r\n0\r\n\r\n";
+	too_large.feed(raw.data(), raw.size(), hosts);
+	EXPECT_EQ(too_large.get_status_code(), 413);
+	EXPECT_EQ(too_large.get_body(), "abcd");
+};
+
+TEST(RequestTest, BodySpoolTest) {
+	Parser parser;
+	std::vector<ServerConfig> server_configs = parser.parse("server {\n\tlisten 127.0.0.1:8080;\n\tclient_body_buffer_size 16;\n\tclient_body_temp_path /tmp;\n\tlocation / {\n\t}\n}\n");
+	VirtualHosts virtual_hosts;
+	const HostIndex &hosts = request_test_hosts(virtual_hosts, server_configs);
+	ASSERT_EQ(server_configs.front().get_client_body_buffer_size(), 16);
+	ASSERT_EQ(server_configs.front().get_client_body_temp_path(), "/tmp");
+
+	Request in_memory = request_test_request(server_configs);
+	std::string raw = "POST / HTTP/1.1\r\nHost: a\r\nContent-Length: 16\r\n\r\n" + std::string(16, 'a');
+	in_memory.feed(raw.data(), raw.size(), hosts);
+	ASSERT_TRUE(in_memory.is_complete());
+	EXPECT_EQ(in_memory.get_body_fd(), -1);
+	EXPECT_EQ(in_memory.get_body(), std::string(16, 'a'));
+
+	Request spooled = request_test_request(server_configs);
+	std::string body;
+	for (size_t i = 0; i < 1000; ++i) {
+		body += static_cast<char>('a' + i % 26);
+	}
+	raw = "POST / HTTP/1.1\r\nHost: a\r\nTransfer-Encoding: chunked\r\n\r\n8\r\n" + body.substr(0, 8) + "\r\n3e0\r\n" + body.substr(8) + "\r\n0\r\n\r\n";
+	for (size_t pos = 0; pos < raw.size(); pos += 7) {
+		spooled.feed(raw.data() + pos, std::min<size_t>(7, raw.size() - pos), hosts);
+	}
+	ASSERT_TRUE(spooled.is_complete());
+	EXPECT_EQ(spooled.get_status_code(), 0);
+	EXPECT_TRUE(spooled.get_body().empty());
+	EXPECT_EQ(spooled.get_body_size(), body.size());
+	ASSERT_NE(spooled.get_body_fd(), -1);
+
+	std::string spooled_body(body.size() + 1, '\0');
+	EXPECT_EQ(pread(spooled.get_body_fd(), &spooled_body[0], spooled_body.size(), 0), (ssize_t)body.size());
+	spooled_body.resize(body.size());
+	EXPECT_EQ(spooled_body, body);
+};
+
+}} /* namespace webserv::internal */
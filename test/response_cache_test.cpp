@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+#include <string>
+#include <fcntl.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "ResponseCache.hpp"
+#include "Connection.hpp"
+
+namespace webserv { namespace internal {
+
+/**
+ * @brief Everything connection sends to a socketpair
+ */
+static std::string response_cache_test_send(Connection& connection) {
+	int sockets[2];
+	EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+	fcntl(sockets[0], F_SETFL, O_NONBLOCK);
+	int buffer_size = 4096;
+	setsockopt(sockets[0], SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+
+	std::string received;
+	char buffer[8192];
+	while (connection.has_pending_output()) {
+		EXPECT_TRUE(connection.flush_output(sockets[0]));
+		ssize_t size = recv(sockets[1], buffer, sizeof(buffer), MSG_DONTWAIT);
+		if (size > 0) {
+			received.append(buffer, size);
+		}
+	}
+	ssize_t size;
+	while ((size = recv(sockets[1], buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+		received.append(buffer, size);
+	}
+	close(sockets[0]);
+	close(sockets[1]);
+	return received;
+}
+
+TEST(ResponseCacheTest, QueueTest) {
+	ResponseCache cache(1024 * 1024, 64 * 1024);
+	std::string body(20000, 'b');
+	const CachedResponse* cached = cache.insert("./html/index.html", 200, NULL, NULL, 1, "HTTP/1.1 200 OK\r\n",
+		"Server: s\r\nConnection: keep-alive\r\n", "Server: s\r\nConnection: close\r\n", body);
+	ASSERT_NE(cached, static_cast<const CachedResponse*>(NULL));
+	EXPECT_EQ(cache.find("./html/index.html", 200, NULL, NULL, 1), cached);
+	EXPECT_EQ(cache.find("./html/index.html", 404, NULL, NULL, 1), static_cast<const CachedResponse*>(NULL));
+
+	struct sockaddr_in client_address;
+	bzero(&client_address, sizeof(client_address));
+	Listen listen;
+	Connection connection(client_address, listen);
+	CachedResponse response = *cached;
+	response.buffer->retain();
+
+	// The queued slices outlive the entry
+	cache.clear();
+	EXPECT_EQ(cache.get_size(), 0);
+	cache.queue(connection, response, true, false);
+	cache.queue(connection, response, false, true);
+	response.buffer->release();
+
+	std::string received = response_cache_test_send(connection);
+	size_t date = received.find("Date: ");
+	ASSERT_NE(date, std::string::npos);
+	std::string date_line = received.substr(date, received.find("\r\n", date) + 2 - date);
+
+	std::string keep_alive = "HTTP/1.1 200 OK\r\n" + date_line + "Server: s\r\nConnection: keep-alive\r\n\r\n" + body;
+	EXPECT_EQ(received.substr(0, keep_alive.size()), keep_alive);
+	std::string closing = received.substr(keep_alive.size());
+	EXPECT_EQ(closing.find("HTTP/1.1 200 OK\r\nDate: "), 0);
+	EXPECT_NE(closing.find("Connection: close\r\nSet-Cookie: timestamp="), std::string::npos);
+	EXPECT_EQ(closing.substr(closing.size() - body.size() - 4), "\r\n\r\n" + body);
+}
+
+TEST(ResponseCacheTest, EvictTest) {
+	ResponseCache cache(16 * 1024, 4 * 1024);
+	std::string body(3000, 'x');
+
+	EXPECT_EQ(cache.insert("/big", 200, NULL, NULL, 1, "", "", "", std::string(5000, 'x')), static_cast<const CachedResponse*>(NULL));
+	ASSERT_NE(cache.insert("/hot", 200, NULL, NULL, 1, "", "", "", body), static_cast<const CachedResponse*>(NULL));
+	for (int i = 0; i < 20; ++i) {
+		std::string path = "/" + to_string(i);
+		ASSERT_NE(cache.insert(path, 200, NULL, NULL, 1, "", "", "", body), static_cast<const CachedResponse*>(NULL));
+		EXPECT_LE(cache.get_size(), 16 * 1024);
+		// A hit keeps the entry out of the next sweep of the hand
+		EXPECT_NE(cache.find("/hot", 200, NULL, NULL, 1), static_cast<const CachedResponse*>(NULL)) << i;
+	}
+	EXPECT_NE(cache.find("/19", 200, NULL, NULL, 1), static_cast<const CachedResponse*>(NULL));
+	EXPECT_EQ(cache.find("/0", 200, NULL, NULL, 1), static_cast<const CachedResponse*>(NULL));
+
+	// Another version of the file drops the entry
+	EXPECT_EQ(cache.find("/hot", 200, NULL, NULL, 2), static_cast<const CachedResponse*>(NULL));
+	EXPECT_EQ(cache.find("/hot", 200, NULL, NULL, 1), static_cast<const CachedResponse*>(NULL));
+}
+
+}} /* namespace webserv::internal */
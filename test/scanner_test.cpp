@@ -0,0 +1,88 @@
+#include "gtest/gtest.h"
+#include <string>
+#include <cstdlib>
+
+#include "Scanner.hpp"
+
+namespace webserv { namespace internal {
+
+static const ScanLevel scanner_test_levels[] = { SCAN_SCALAR, SCAN_SSE2, SCAN_AVX2 };
+
+TEST(ScannerTest, ScanLineTest) {
+	ScanLevel best_level = get_scan_level();
+	for (size_t l = 0; l < 3 && set_scan_level(scanner_test_levels[l]); ++l) {
+		for (size_t size = 0; size < 100; ++size) {
+			std::string line(size, 'a');
+			line += "\r\nb";
+			bool has_ctl = false;
+
+			EXPECT_EQ(scan_line(line.data(), line.size(), has_ctl), line.data() + size + 1);
+			EXPECT_FALSE(has_ctl);
+			EXPECT_EQ(scan_line(line.data(), size, has_ctl), (const char*)NULL);
+
+			line[size] = '\0';
+			scan_line(line.data(), line.size(), has_ctl);
+			EXPECT_TRUE(has_ctl);
+		}
+
+		std::string after_lf = "GET / HTTP/1.1\n" + std::string(40, '\x01');
+		bool has_ctl = false;
+		EXPECT_EQ(scan_line(after_lf.data(), after_lf.size(), has_ctl), after_lf.data() + 14);
+		EXPECT_FALSE(has_ctl);
+
+		std::string tab_and_high = "a\tb\x80\xff" + std::string(40, 'c') + "\x7f\n";
+		scan_line(tab_and_high.data(), tab_and_high.size(), has_ctl);
+		EXPECT_TRUE(has_ctl);
+	}
+	set_scan_level(best_level);
+};
+
+TEST(ScannerTest, ScanTokenTest) {
+	ScanLevel best_level = get_scan_level();
+	for (size_t l = 0; l < 3 && set_scan_level(scanner_test_levels[l]); ++l) {
+		std::string name = "X-Forwarded-For_2.0!#$%&'*+^`|~ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+		EXPECT_EQ(scan_token(name.data(), name.size()), name.data() + name.size());
+
+		for (size_t pos = 0; pos < name.size(); ++pos) {
+			std::string invalid = name;
+			invalid[pos] = pos % 2 ? ':' : '\x80';
+			EXPECT_EQ(scan_token(invalid.data(), invalid.size()), invalid.data() + pos);
+		}
+
+		const char* separators = " \t\"(),/:;<=>?@[\\]{}";
+		for (size_t i = 0; separators[i] != '\0'; ++i) {
+			std::string invalid = std::string(33, 'a') + separators[i];
+			EXPECT_EQ(scan_token(invalid.data(), invalid.size()), invalid.data() + 33);
+		}
+	}
+	set_scan_level(best_level);
+};
+
+TEST(ScannerTest, ScanBytesTest) {
+	ScanLevel best_level = get_scan_level();
+	std::srand(42);
+	for (size_t l = 0; l < 3 && set_scan_level(scanner_test_levels[l]); ++l) {
+		for (size_t round = 0; round < 500; ++round) {
+			std::string data;
+			for (size_t i = std::rand() % 200; i > 0; --i) {
+				data += "-\r\nab"[std::rand() % 5];
+			}
+			std::string pattern;
+			for (size_t i = 1 + std::rand() % 8; i > 0; --i) {
+				pattern += "-\r\nab"[std::rand() % 5];
+			}
+
+			EXPECT_EQ(find_bytes(data, pattern.data(), pattern.size()), data.find(pattern));
+			EXPECT_EQ(find_bytes(data, pattern.data(), pattern.size(), data.size() / 2), data.find(pattern, data.size() / 2));
+		}
+
+		std::string body = std::string(100, 'x') + "\r\n--boundary--\r\n";
+		EXPECT_EQ(find_bytes(body, "\r\n--boundary", 12), 100);
+		EXPECT_EQ(find_bytes(body, "\r\n--other", 9), std::string::npos);
+		EXPECT_EQ(find_bytes(body, "", 0, 7), 7);
+		EXPECT_EQ(find_bytes(body, "x", 1, body.size() + 1), std::string::npos);
+	}
+	set_scan_level(best_level);
+};
+
+}} /* namespace webserv::internal */
@@ -0,0 +1,122 @@
+#include "gtest/gtest.h"
+#include <vector>
+
+#include "TimerWheel.hpp"
+
+namespace webserv { namespace internal {
+
+TEST(TimerWheelTest, ExpireInOrderTest) {
+	TimerWheel wheel;
+	unsigned long now = TimerWheel::now_ms();
+	Timer timers[3];
+	std::vector<int> expired;
+
+	timers[0].fd = 0;
+	timers[1].fd = 1;
+	timers[2].fd = 2;
+	wheel.schedule(timers[0], now + 50);
+	wheel.schedule(timers[1], now + 5000);
+	wheel.schedule(timers[2], now + 700000);
+
+	wheel.expire(now + 40, expired);
+	EXPECT_TRUE(expired.empty());
+
+	wheel.expire(now + 60, expired);
+	ASSERT_EQ(expired.size(), 1);
+	EXPECT_EQ(expired[0], 0);
+	EXPECT_FALSE(timers[0].is_armed());
+
+	wheel.expire(now + 4990, expired);
+	EXPECT_EQ(expired.size(), 1);
+
+	wheel.expire(now + 5010, expired);
+	ASSERT_EQ(expired.size(), 2);
+	EXPECT_EQ(expired[1], 1);
+
+	wheel.expire(now + 699990, expired);
+	EXPECT_EQ(expired.size(), 2);
+
+	wheel.expire(now + 700010, expired);
+	ASSERT_EQ(expired.size(), 3);
+	EXPECT_EQ(expired[2], 2);
+};
+
+TEST(TimerWheelTest, ExpireOnCascadeTickTest) {
+	TimerWheel wheel;
+	unsigned long tick = TimerWheel::now_ms() / TIMER_WHEEL_RESOLUTION;
+	Timer timers[2];
+	std::vector<int> expired;
+
+	// Deadlines on the first tick of a level 1 and a level 2 slot
+	unsigned long level_1 = ((tick >> TIMER_WHEEL_SLOT_BITS) + 2) << TIMER_WHEEL_SLOT_BITS;
+	unsigned long level_2 = ((tick >> (2 * TIMER_WHEEL_SLOT_BITS)) + 2) << (2 * TIMER_WHEEL_SLOT_BITS);
+	timers[0].fd = 0;
+	timers[1].fd = 1;
+	wheel.schedule(timers[0], level_1 * TIMER_WHEEL_RESOLUTION);
+	wheel.schedule(timers[1], level_2 * TIMER_WHEEL_RESOLUTION);
+
+	wheel.expire(level_1 * TIMER_WHEEL_RESOLUTION - 1, expired);
+	EXPECT_TRUE(expired.empty());
+	wheel.expire(level_1 * TIMER_WHEEL_RESOLUTION, expired);
+	ASSERT_EQ(expired.size(), 1);
+
+	wheel.expire(level_2 * TIMER_WHEEL_RESOLUTION - 1, expired);
+	EXPECT_EQ(expired.size(), 1);
+	wheel.expire(level_2 * TIMER_WHEEL_RESOLUTION, expired);
+	ASSERT_EQ(expired.size(), 2);
+	EXPECT_EQ(expired[1], 1);
+};
+
+TEST(TimerWheelTest, RescheduleAndCancelTest) {
+	TimerWheel wheel;
+	unsigned long now = TimerWheel::now_ms();
+	Timer timer;
+	std::vector<int> expired;
+
+	timer.fd = 42;
+	wheel.schedule(timer, now + 100);
+	wheel.schedule(timer, now + 3000);
+	wheel.expire(now + 200, expired);
+	EXPECT_TRUE(expired.empty());
+	EXPECT_TRUE(timer.is_armed());
+
+	wheel.cancel(timer);
+	wheel.expire(now + 4000, expired);
+	EXPECT_TRUE(expired.empty());
+	EXPECT_EQ(wheel.get_next_timeout(now + 4000), -1);
+};
+
+TEST(TimerWheelTest, NextTimeoutTest) {
+	TimerWheel wheel;
+	unsigned long now = TimerWheel::now_ms();
+	Timer timers[2];
+
+	EXPECT_EQ(wheel.get_next_timeout(now), -1);
+
+	wheel.schedule(timers[0], now + 60000);
+	int timeout = wheel.get_next_timeout(now);
+	EXPECT_GE(timeout, 0);
+	EXPECT_LE(timeout, 60000);
+
+	wheel.schedule(timers[1], now + 30);
+	timeout = wheel.get_next_timeout(now);
+	EXPECT_GE(timeout, 20);
+	EXPECT_LE(timeout, 40);
+};
+
+TEST(TimerWheelTest, DestroyedTimerUnlinksTest) {
+	TimerWheel wheel;
+	unsigned long now = TimerWheel::now_ms();
+	std::vector<int> expired;
+
+	{
+		Timer timer;
+		wheel.schedule(timer, now + 100);
+		Timer copy(timer);
+		EXPECT_FALSE(copy.is_armed());
+	}
+	wheel.expire(now + 200, expired);
+	EXPECT_TRUE(expired.empty());
+};
+
+}} /* namespace webserv::internal */
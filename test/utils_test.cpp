@@ -29,6 +29,15 @@ TEST(UtilsTest, IsDigitsTest) {
 	EXPECT_FALSE(is_digits("42.5f"));
 };
 
+TEST(UtilsTest, ParseSizeTest) {
+	EXPECT_EQ(parse_size("512"), 512);
+	EXPECT_EQ(parse_size("8k"), 8192);
+	EXPECT_EQ(parse_size("1M"), 1048576);
+	EXPECT_EQ(parse_size("-1"), -1);
+	EXPECT_EQ(parse_size("8kb"), -1);
+	EXPECT_EQ(parse_size("4096m"), -1);
+};
+
 TEST(UtilsTest, IsIP4Test) {
 	EXPECT_TRUE(is_ip4("0.0.0.0"));
 	EXPECT_TRUE(is_ip4("192.168.0.1"));
@@ -49,4 +58,41 @@ TEST(UtilsTest, IsMatchTest) {
 	EXPECT_TRUE(is_match("abc.test.com", "*.test.com", '.'));
 };
 
+TEST(UtilsTest, ParseHeaderFieldsTest) {
+	std::map<std::string, std::string> headers = parse_header_fields("Content-Type: text/html\r\nStatus: 200 OK");
+	EXPECT_EQ(headers.size(), 2);
+	EXPECT_EQ(headers.at("Content-Type"), "text/html");
+	EXPECT_EQ(headers.at("Status"), "200 OK");
+
+	EXPECT_THROW(parse_header_fields("Content-Type text/html\r\nStatus: 200"), std::logic_error);
+	EXPECT_THROW(parse_header_fields("Status: 200\r\nStatus: 404"), std::logic_error);
+};
+
+TEST(UtilsTest, IsCodingAcceptedTest) {
+	EXPECT_TRUE(is_coding_accepted("gzip, deflate, br", "gzip"));
+	EXPECT_TRUE(is_coding_accepted("gzip, deflate, br", "br"));
+	EXPECT_TRUE(is_coding_accepted("GZIP;q=0.5", "gzip"));
+	EXPECT_FALSE(is_coding_accepted("gzip;q=0, br", "gzip"));
+	EXPECT_FALSE(is_coding_accepted("gzip; Q=0.000", "gzip"));
+	EXPECT_FALSE(is_coding_accepted("deflate", "gzip"));
+	EXPECT_FALSE(is_coding_accepted("gzipped", "gzip"));
+	EXPECT_FALSE(is_coding_accepted("", "gzip"));
+
+	EXPECT_TRUE(is_coding_accepted("*", "br"));
+	EXPECT_FALSE(is_coding_accepted("*;q=0", "br"));
+	EXPECT_FALSE(is_coding_accepted("br;q=0, *", "br"));
+	EXPECT_TRUE(is_coding_accepted("*;q=0, br", "br"));
+};
+
+TEST(UtilsTest, HttpDateTest) {
+	EXPECT_EQ(format_http_date(784111777), "Sun, 06 Nov 1994 08:49:37 GMT");
+	EXPECT_EQ(parse_http_date("Sun, 06 Nov 1994 08:49:37 GMT"), 784111777);
+	EXPECT_EQ(parse_http_date(format_http_date(1700000000)), 1700000000);
+
+	EXPECT_EQ(parse_http_date("Sunday, 06-Nov-94 08:49:37 GMT"), -1);
+	EXPECT_EQ(parse_http_date("Sun, 06 Nov 1994 08:49:37 GMT; length=12"), -1);
+	EXPECT_EQ(parse_http_date("\"1234-5678\""), -1);
+	EXPECT_EQ(parse_http_date(""), -1);
+};
+
 }} /* namespace webserv::internal */
@@ -0,0 +1,53 @@
+#include "gtest/gtest.h"
+#include <vector>
+#include <string>
+
+#include "Parser.hpp"
+#include "VirtualHosts.hpp"
+
+namespace webserv { namespace internal {
+
+static Listen virtual_hosts_test_listen(int port) {
+	Listen listen;
+	listen.address = "127.0.0.1";
+	listen.port = port;
+	return listen;
+}
+
+TEST(VirtualHostsTest, FindTest) {
+	Parser parser;
+	std::string config;
+	for (int i = 0; i < 200; ++i) {
+		config += "server {\n\tlisten 127.0.0.1:8080;\n\tserver_name site" + to_string(i) + ".example.com www.site" + to_string(i) + ".example.com;\n\tlocation / {\n\t}\n}\n";
+	}
+	config += "server {\n\tlisten 127.0.0.1:8081;\n\tlisten 127.0.0.1:8080;\n\tserver_name Other.example.com site0.example.com;\n\tlocation / {\n\t}\n}\n";
+	std::vector<ServerConfig> server_configs = parser.parse(config);
+	ASSERT_EQ(server_configs.size(), 201);
+
+	VirtualHosts virtual_hosts;
+	virtual_hosts.build(server_configs);
+	const HostIndex* hosts = virtual_hosts.find(virtual_hosts_test_listen(8080));
+	ASSERT_TRUE(hosts != NULL);
+	EXPECT_EQ(&hosts->get_default(), &server_configs[0]);
+
+	for (int i = 0; i < 200; ++i) {
+		std::string name = "www.site" + to_string(i) + ".example.com";
+		EXPECT_EQ(hosts->find(name.data(), name.size()), &server_configs[i]);
+	}
+	EXPECT_EQ(hosts->find("SITE7.Example.COM", 17), &server_configs[7]);
+	EXPECT_EQ(hosts->find("site7.example.com.", 18), &server_configs[7]);
+	EXPECT_EQ(hosts->find("other.example.com", 17), &server_configs[200]);
+	EXPECT_EQ(hosts->find("site0.example.com", 17), &server_configs[0]);
+	EXPECT_TRUE(hosts->find("unknown.example.com", 19) == NULL);
+	EXPECT_TRUE(hosts->find("site7.example.co", 16) == NULL);
+
+	const HostIndex* other_hosts = virtual_hosts.find(virtual_hosts_test_listen(8081));
+	ASSERT_TRUE(other_hosts != NULL);
+	EXPECT_EQ(&other_hosts->get_default(), &server_configs[200]);
+	EXPECT_EQ(other_hosts->find("site0.example.com", 17), &server_configs[200]);
+	EXPECT_TRUE(other_hosts->find("site1.example.com", 17) == NULL);
+
+	EXPECT_TRUE(virtual_hosts.find(virtual_hosts_test_listen(8082)) == NULL);
+};
+
+}} /* namespace webserv::internal */